@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <ranges>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "analysis/allocator.hpp"
+#include "analysis/lifetime.hpp"
+#include "analysis/loop.hpp"
+#include "analysis/resolution.hpp"
+
+#include "fixtures.hpp"
+#include "synthetic.hpp"
+
+using namespace injir;
+using namespace injir::analysis;
+
+namespace {
+
+constexpr std::size_t kRepeats = 5;
+
+// Gives access to the CFG of a test fixture
+template <typename Fixture> struct FixtureCFG : Fixture {
+    FixtureCFG() { this->SetUp(); }
+    void TestBody() override {}
+
+    BasicBlock *entry() { return this->bb_a; }
+    std::size_t size() { return this->test_func.size(); }
+};
+
+struct Result {
+    std::size_t spills;
+    // resolution moves on the CFG edges
+    std::size_t moves;
+    double usec;
+};
+
+Result measure(RegAllocKind kind, const regs_num_t &regs_num, const LifeTime &lt) {
+    auto best = std::chrono::steady_clock::duration::max();
+    for (std::size_t i = 0; i != kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        auto alloc = make_register_allocator(kind, regs_num, lt);
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+    }
+
+    // every run allocates the same way
+    auto alloc = make_register_allocator(kind, regs_num, lt);
+    std::size_t spills = std::ranges::count_if(
+        lt, [&alloc](const auto &e) { return alloc->get_spill_slot(e.first).has_value(); });
+    auto moves = Resolution(lt, *alloc).get_moves_num();
+    return {spills, moves, std::chrono::duration<double, std::micro>(best).count()};
+}
+
+void report(const std::string &name, BasicBlock *entry, std::size_t size) {
+    auto loop_tree = analysis::loop_tree(entry);
+    LifeTime lt(entry, loop_tree, size);
+
+    for (std::size_t regs : {2, 4, 8, 16}) {
+        auto ls = measure(RegAllocKind::kLinearScan, {regs, regs}, lt);
+        auto gc = measure(RegAllocKind::kGraphColoring, {regs, regs}, lt);
+        auto ssa = measure(RegAllocKind::kSSAColoring, {regs, regs}, lt);
+        std::printf("%-28s %8zu %4zu | %8zu %6zu %10.1f | %8zu %6zu %10.1f | %8zu %6zu %10.1f\n",
+                    name.c_str(), lt.size(), regs, ls.spills, ls.moves, ls.usec, gc.spills,
+                    gc.moves, gc.usec, ssa.spills, ssa.moves, ssa.usec);
+    }
+}
+
+template <typename Fixture> void report_fixture(const std::string &name) {
+    FixtureCFG<Fixture> cfg{};
+    report(name, cfg.entry(), cfg.size());
+}
+
+// Time per interval of LinearScan must stay flat as the number of intervals grows
+void report_scaling() {
+    constexpr regs_num_t kRegs{32, 32};
+
+    std::printf("\n%-28s %8s %12s %12s\n", "linear scan scaling", "values", "usec",
+                "ns/value");
+    for (std::size_t values = 1uz << 14; values <= 1uz << 20; values <<= 2) {
+        Function func{Type::kInt, {}};
+        auto *entry = bench::build_straight_line_cfg(func, values, 42);
+        auto loop_tree = analysis::loop_tree(entry);
+        LifeTime lt(entry, loop_tree, func.size());
+
+        auto ls = measure(RegAllocKind::kLinearScan, kRegs, lt);
+        std::printf("%-28s %8zu %12.1f %12.1f\n", "straight line", lt.size(), ls.usec,
+                    ls.usec * 1000 / static_cast<double>(lt.size()));
+    }
+}
+
+} // namespace
+
+int main() {
+    std::printf("%-28s %8s %4s | %8s %6s %10s | %8s %6s %10s | %8s %6s %10s\n", "cfg", "values",
+                "regs", "ls spill", "moves", "ls usec", "gc spill", "moves", "gc usec",
+                "ssa spill", "moves", "ssa usec");
+
+    report_fixture<CFGLifeTimeSimpleExample>("CFGLifeTimeSimpleExample");
+    report_fixture<CFGLifeTimePaperExample>("CFGLifeTimePaperExample");
+    report_fixture<CFGLifeTimeNestedLoops>("CFGLifeTimeNestedLoops");
+    report_fixture<CFGRegAllocSpillSlots>("CFGRegAllocSpillSlots");
+    report_fixture<CFGRegAllocMixedTypes>("CFGRegAllocMixedTypes");
+
+    for (auto [loops, values] : {std::pair{10uz, 8uz}, {50uz, 16uz}, {100uz, 32uz}}) {
+        Function func{Type::kInt, {}};
+        auto *entry = bench::build_synthetic_cfg(func, loops, values, 42);
+        report("synthetic " + std::to_string(loops) + "x" + std::to_string(values), entry,
+               func.size());
+    }
+
+    report_scaling();
+    return 0;
+}
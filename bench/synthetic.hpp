@@ -0,0 +1,126 @@
+#ifndef BENCH_SYNTHETIC_HPP
+#define BENCH_SYNTHETIC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "ir/builder.hpp"
+
+namespace injir::bench {
+
+/**
+ * @brief Fill func with a chain of loops: entry -> (header <-> body, header -> exit)*.
+ *
+ * Every block defines values_per_block arithmetic values whose operands are taken at random
+ * from a sliding window of recently defined dominating values, so the register pressure stays
+ * around window values and every value is used. Headers carry a loop phi.
+ *
+ * @return entry basic block, all func.size() blocks are reachable from it
+ */
+inline BasicBlock *build_synthetic_cfg(Function &func, std::size_t loops,
+                                       std::size_t values_per_block, std::uint32_t seed,
+                                       std::size_t window = 16) {
+    std::mt19937 gen{seed};
+    Builder builder{};
+    builder.set_insert_point(&func);
+
+    std::deque<Instr *> pool{};
+    auto pick = [&gen](const std::deque<Instr *> &from) {
+        std::uniform_int_distribution<std::size_t> dist{0, from.size() - 1};
+        return from[dist(gen)];
+    };
+    auto define = [&](std::deque<Instr *> &into) {
+        auto kind = std::uniform_int_distribution<int>{0, 1}(gen);
+        auto *value = kind == 0 ? builder.create_add(pick(into), pick(into))
+                                : builder.create_mul(pick(into), pick(into));
+        into.push_back(value);
+        if (into.size() > window) {
+            into.pop_front();
+        }
+    };
+
+    auto *entry = builder.create_bb();
+    builder.set_insert_point(entry);
+    for (std::size_t i = 0; i != window; ++i) {
+        pool.push_back(builder.create_int(i));
+    }
+
+    auto *pre = entry;
+    for (std::size_t loop = 0; loop != loops; ++loop) {
+        auto *header = builder.create_bb();
+        auto *body = builder.create_bb();
+        auto *exit = builder.create_bb();
+
+        builder.set_insert_point(pre);
+        auto *init = pick(pool);
+        builder.create_jump(header);
+
+        builder.set_insert_point(header);
+        auto *phi = builder.create_phi();
+        pool.push_back(phi);
+        for (std::size_t i = 0; i != values_per_block; ++i) {
+            define(pool);
+        }
+        builder.create_br(builder.create_cmp_le(pick(pool), pick(pool)), body, exit);
+
+        builder.set_insert_point(body);
+        auto body_pool = pool;
+        for (std::size_t i = 0; i != values_per_block; ++i) {
+            define(body_pool);
+        }
+        auto *back = body_pool.back();
+        builder.create_jump(header);
+
+        phi->add_incoming(init, pre);
+        phi->add_incoming(back, body);
+
+        builder.set_insert_point(exit);
+        for (std::size_t i = 0; i != values_per_block; ++i) {
+            define(pool);
+        }
+        pre = exit;
+    }
+
+    builder.set_insert_point(pre);
+    builder.create_ret(pool.back());
+    return entry;
+}
+
+/**
+ * @brief Fill func with a single block of values arithmetic values over a sliding window.
+ *
+ * There are no loops, so building LifeTime stays cheap for very long blocks and the
+ * allocator itself dominates the measurement.
+ *
+ * @return the only basic block
+ */
+inline BasicBlock *build_straight_line_cfg(Function &func, std::size_t values, std::uint32_t seed,
+                                           std::size_t window = 64) {
+    std::mt19937 gen{seed};
+    Builder builder{};
+    builder.set_insert_point(&func);
+
+    auto *entry = builder.create_bb();
+    builder.set_insert_point(entry);
+
+    std::deque<Instr *> pool{};
+    for (std::size_t i = 0; i != window; ++i) {
+        pool.push_back(builder.create_int(i));
+    }
+
+    for (std::size_t i = 0; i != values; ++i) {
+        std::uniform_int_distribution<std::size_t> dist{0, pool.size() - 1};
+        pool.push_back(builder.create_add(pool[dist(gen)], pool[dist(gen)]));
+        pool.pop_front();
+    }
+
+    builder.create_ret(pool.back());
+    return entry;
+}
+
+} // namespace injir::bench
+
+#endif // BENCH_SYNTHETIC_HPP
@@ -0,0 +1,171 @@
+#ifndef ALIAS_HPP
+#define ALIAS_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+enum class AliasResult {
+    kNoAlias,
+    kMayAlias,
+    kMustAlias,
+};
+
+// ptr = base + offset elements, the offset is unknown when a gep index is not a constant
+struct PointerOffset {
+    Instr *base;
+    std::optional<i64> offset;
+};
+
+inline PointerOffset decompose(Instr *ptr) {
+    assert(ptr != nullptr && "ptr is nullptr");
+
+    std::optional<i64> offset{0};
+    while (GepInstr::classof(ptr)) {
+        auto *gep = static_cast<GepInstr *>(ptr);
+        auto *index = gep->index();
+        if (offset.has_value() && index->type() == InstrType::kConst &&
+            index->value_type() == Type::kInt) {
+            *offset += static_cast<ConstInstr<i64> *>(index)->get_value();
+        } else {
+            offset.reset();
+        }
+        ptr = gep->ptr();
+    }
+    return {ptr, offset};
+}
+
+// The alloca, argument, load... a pointer is derived from by geps
+inline Instr *underlying_object(Instr *ptr) { return decompose(ptr).base; }
+
+/**
+ * @brief Whether two pointers may refer to the same memory.
+ *
+ * Different allocas never overlap, the same base at known offsets overlaps when the offsets are
+ * equal. Pointers of any other origin may point anywhere.
+ */
+inline AliasResult alias(Instr *lhs, Instr *rhs) {
+    if (lhs == rhs) {
+        return AliasResult::kMustAlias;
+    }
+    auto lhs_location = decompose(lhs);
+    auto rhs_location = decompose(rhs);
+
+    if (lhs_location.base == rhs_location.base) {
+        if (!lhs_location.offset.has_value() || !rhs_location.offset.has_value()) {
+            return AliasResult::kMayAlias;
+        }
+        return lhs_location.offset == rhs_location.offset ? AliasResult::kMustAlias
+                                                          : AliasResult::kNoAlias;
+    }
+    if (AllocaInstr::classof(lhs_location.base) && AllocaInstr::classof(rhs_location.base)) {
+        return AliasResult::kNoAlias;
+    }
+    return AliasResult::kMayAlias;
+}
+
+/**
+ * @brief Alias queries which also know the allocas whose address never leaves the function.
+ *
+ * An alloca escapes when its address, or a gep of it, is used other than as the pointer of a load
+ * or a store, e.g. stored to memory, passed to a call or merged by a phi. The memory of an alloca
+ * which does not escape is reached through that alloca only, so it is not aliased by arguments,
+ * loaded pointers or results of calls.
+ *
+ * Escapes and query results are cached until invalidate, which is needed once pointers are erased
+ * or new uses of allocas appear.
+ */
+class AliasAnalysis final {
+  private:
+    struct PairHash {
+        std::size_t operator()(const std::pair<const Instr *, const Instr *> &key) const noexcept {
+            auto hash = std::hash<const Instr *>{}(key.first);
+            hash ^= std::hash<const Instr *>{}(key.second) + 0x9e3779b97f4a7c15 + (hash << 6) +
+                    (hash >> 2);
+            return hash;
+        }
+    };
+
+    std::unordered_map<const Instr *, bool> m_escapes{};
+    std::unordered_map<std::pair<const Instr *, const Instr *>, AliasResult, PairHash>
+        m_results{};
+
+    bool compute_escapes(const AllocaInstr *alloca) const {
+        std::vector<const Instr *> worklist{alloca};
+        while (!worklist.empty()) {
+            const auto *ptr = worklist.back();
+            worklist.pop_back();
+            for (const auto *user : ptr->users()) {
+                if (LoadInstr::classof(user)) {
+                    continue;
+                }
+                if (StoreInstr::classof(user) &&
+                    static_cast<const StoreInstr *>(user)->value() != ptr) {
+                    continue;
+                }
+                if (GepInstr::classof(user) && static_cast<const GepInstr *>(user)->ptr() == ptr) {
+                    worklist.push_back(user);
+                    continue;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+  public:
+    bool escapes(const AllocaInstr *alloca) {
+        auto it = m_escapes.find(alloca);
+        if (it == m_escapes.end()) {
+            it = m_escapes.emplace(alloca, compute_escapes(alloca)).first;
+        }
+        return it->second;
+    }
+
+    // ptr points into an alloca which does not escape
+    bool is_local(Instr *ptr) {
+        auto *base = underlying_object(ptr);
+        return AllocaInstr::classof(base) && !escapes(static_cast<AllocaInstr *>(base));
+    }
+
+    AliasResult alias(Instr *lhs, Instr *rhs) {
+        if (std::less<Instr *>{}(rhs, lhs)) {
+            std::swap(lhs, rhs);
+        }
+        auto it = m_results.find({lhs, rhs});
+        if (it != m_results.end()) {
+            return it->second;
+        }
+
+        auto result = analysis::alias(lhs, rhs);
+        if (result == AliasResult::kMayAlias) {
+            auto *lhs_base = underlying_object(lhs);
+            auto *rhs_base = underlying_object(rhs);
+            if (lhs_base != rhs_base && (is_local(lhs_base) || is_local(rhs_base))) {
+                result = AliasResult::kNoAlias;
+            }
+        }
+        m_results.emplace(std::pair{lhs, rhs}, result);
+        return result;
+    }
+
+    bool may_alias(Instr *lhs, Instr *rhs) { return alias(lhs, rhs) != AliasResult::kNoAlias; }
+    bool must_alias(Instr *lhs, Instr *rhs) { return alias(lhs, rhs) == AliasResult::kMustAlias; }
+
+    void invalidate() {
+        m_escapes.clear();
+        m_results.clear();
+    }
+};
+
+} // namespace injir::analysis
+
+#endif // ALIAS_HPP
@@ -0,0 +1,38 @@
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+#include <memory>
+
+#include "analysis/graph_coloring.hpp"
+#include "analysis/lifetime.hpp"
+#include "analysis/regalloc.hpp"
+#include "analysis/ssa_coloring.hpp"
+
+namespace injir::analysis {
+
+enum class RegAllocKind {
+    // Fast allocator for JIT tiers
+    kLinearScan,
+    // Iterated register coalescing: slower, fewer spills and moves
+    kGraphColoring,
+    // Dominance-order coloring of SSA values: fastest, phis become parallel copies
+    kSSAColoring,
+};
+
+inline std::unique_ptr<RegisterAllocator>
+make_register_allocator(RegAllocKind kind, const regs_num_t &regs_num, const LifeTime &life_time) {
+    switch (kind) {
+    case RegAllocKind::kLinearScan:
+        return std::make_unique<LinearScan>(regs_num, life_time);
+    case RegAllocKind::kGraphColoring:
+        return std::make_unique<GraphColoring>(regs_num, life_time);
+    case RegAllocKind::kSSAColoring:
+        return std::make_unique<SSAColoring>(regs_num, life_time);
+    }
+    assert(false && "Unknown register allocator kind");
+    return nullptr;
+}
+
+} // namespace injir::analysis
+
+#endif // ALLOCATOR_HPP
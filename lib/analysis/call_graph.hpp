@@ -0,0 +1,112 @@
+#ifndef CALL_GRAPH_HPP
+#define CALL_GRAPH_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+// Callees of every function reachable from the root through calls, in the order of their calls
+using call_graph_t = std::unordered_map<Function *, std::vector<Function *>>;
+
+inline call_graph_t call_graph(Function *root) {
+    assert(root != nullptr && "function is nullptr");
+
+    call_graph_t graph{};
+    std::vector<Function *> worklist{root};
+    graph[root] = {};
+    while (!worklist.empty()) {
+        auto *func = worklist.back();
+        worklist.pop_back();
+
+        std::vector<Function *> callees{};
+        for (auto &bb : *func) {
+            for (auto *call : collect_instrs<CallInstr>(bb)) {
+                auto *callee = call->get_callee();
+                if (std::ranges::find(callees, callee) == callees.end()) {
+                    callees.push_back(callee);
+                }
+                if (!graph.contains(callee)) {
+                    graph[callee] = {};
+                    worklist.push_back(callee);
+                }
+            }
+        }
+        graph[func] = std::move(callees);
+    }
+    return graph;
+}
+
+namespace detail {
+struct SCCState {
+    const call_graph_t &graph;
+    std::unordered_map<Function *, std::size_t> index{};
+    std::unordered_map<Function *, std::size_t> low_link{};
+    std::vector<Function *> stack{};
+    std::unordered_map<Function *, bool> on_stack{};
+    std::vector<std::vector<Function *>> sccs{};
+};
+
+// Tarjan's algorithm: a component is complete after all the components it calls
+inline void strong_connect(Function *func, SCCState &state) {
+    auto func_index = state.index.size();
+    state.index[func] = func_index;
+    state.low_link[func] = func_index;
+    state.stack.push_back(func);
+    state.on_stack[func] = true;
+
+    for (auto *callee : state.graph.at(func)) {
+        if (!state.index.contains(callee)) {
+            strong_connect(callee, state);
+            state.low_link[func] = std::min(state.low_link[func], state.low_link[callee]);
+        } else if (state.on_stack[callee]) {
+            state.low_link[func] = std::min(state.low_link[func], state.index[callee]);
+        }
+    }
+
+    if (state.low_link[func] != func_index) {
+        return;
+    }
+    std::vector<Function *> scc{};
+    Function *member = nullptr;
+    do {
+        member = state.stack.back();
+        state.stack.pop_back();
+        state.on_stack[member] = false;
+        scc.push_back(member);
+    } while (member != func);
+    state.sccs.push_back(std::move(scc));
+}
+} // namespace detail
+
+/**
+ * @brief Strongly connected components of the call graph, callees before their callers.
+ *
+ * Mutually recursive functions share a component, the root is in the last one.
+ */
+inline std::vector<std::vector<Function *>> sccs_bottom_up(Function *root,
+                                                           const call_graph_t &graph) {
+    assert(root != nullptr && "function is nullptr");
+
+    detail::SCCState state{graph};
+    detail::strong_connect(root, state);
+    return state.sccs;
+}
+
+// The function calls itself or another function of its component
+inline bool is_recursive(Function *func, const std::vector<Function *> &scc,
+                         const call_graph_t &graph) {
+    const auto &callees = graph.at(func);
+    return scc.size() > 1 || std::ranges::find(callees, func) != callees.end();
+}
+
+} // namespace injir::analysis
+
+#endif // CALL_GRAPH_HPP
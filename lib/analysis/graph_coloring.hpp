@@ -0,0 +1,491 @@
+#ifndef GRAPH_COLORING_HPP
+#define GRAPH_COLORING_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "analysis/lifetime.hpp"
+#include "analysis/regalloc.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+/**
+ * @brief Iterated register coalescing allocator (George & Appel).
+ *
+ * Interference is built from the precise live ranges of LifeTime, so values which only meet
+ * inside a lifetime hole of each other may share a register. A phi and each of its incoming
+ * values are copy-related: they are coalesced whenever the Briggs test proves it safe, so no
+ * move is needed for that phi operand. The George test is not used: it only pays off for
+ * precolored nodes and there are none here. Colors are chosen optimistically, values which
+ * cannot be colored are spilled.
+ */
+class GraphColoring final : public RegisterAllocator {
+  public:
+    explicit GraphColoring(const regs_num_t &regs_num, const LifeTime &life_time) {
+        auto intervals = prepare_intervals(life_time);
+        for (std::size_t cls = 0; cls != kRegClassesNum; ++cls) {
+            auto in_class = [cls](const auto &e) {
+                return reg_class(e.first) == static_cast<RegClass>(cls);
+            };
+            auto class_nodes = intervals | std::views::filter(in_class) | std::views::keys;
+
+            Coloring coloring{regs_num[cls], std::vector(std::from_range, class_nodes)};
+            coloring.build(life_time);
+            coloring.run();
+            coloring.write_results(m_results);
+        }
+        assign_spill_slots(intervals);
+    }
+
+    explicit GraphColoring(std::size_t regs_num, const LifeTime &life_time)
+        : GraphColoring(regs_num_t{regs_num, regs_num}, life_time) {}
+
+  private:
+    // Coloring of the interference graph of a single register class
+    class Coloring {
+        using node_t = std::size_t;
+
+        enum class NodeState {
+            kInitial,
+            kSimplify,
+            kFreeze,
+            kSpill,
+            kSelect,
+            kCoalesced,
+            kColored,
+            kSpilled,
+        };
+
+        enum class MoveState {
+            kWorklist,
+            kActive,
+            kCoalesced,
+            kConstrained,
+            kFrozen,
+        };
+
+        struct Move {
+            node_t dst;
+            node_t src;
+        };
+
+        // Spill candidate, stale once the degree or the use cost of the node has changed
+        struct SpillCandidate {
+            double cost;
+            node_t node;
+            std::size_t degree;
+
+            bool operator>(const SpillCandidate &rhs) const {
+                return std::tie(cost, node) > std::tie(rhs.cost, rhs.node);
+            }
+        };
+
+        std::size_t m_k;
+        std::vector<Instr *> m_nodes;
+        std::unordered_map<Instr *, node_t> m_index{};
+
+        std::vector<std::vector<node_t>> m_adj_list;
+        std::unordered_set<std::uint64_t> m_adj_set{};
+        std::vector<std::size_t> m_degree;
+        std::vector<node_t> m_alias;
+        std::vector<std::size_t> m_color;
+        std::vector<NodeState> m_node_state;
+        std::vector<double> m_use_cost;
+
+        std::vector<Move> m_moves{};
+        std::vector<MoveState> m_move_state{};
+        std::vector<std::vector<std::size_t>> m_move_list;
+
+        std::set<node_t> m_simplify_worklist{};
+        std::set<node_t> m_freeze_worklist{};
+        std::set<node_t> m_spill_worklist{};
+        std::set<std::size_t> m_worklist_moves{};
+        std::vector<node_t> m_select_stack{};
+
+        std::priority_queue<SpillCandidate, std::vector<SpillCandidate>, std::greater<>>
+            m_spill_queue{};
+
+      public:
+        Coloring(std::size_t k, std::vector<Instr *> nodes)
+            : m_k{k}, m_nodes{std::move(nodes)}, m_adj_list(m_nodes.size()),
+              m_degree(m_nodes.size(), 0), m_alias(m_nodes.size()), m_color(m_nodes.size(), 0),
+              m_node_state(m_nodes.size(), NodeState::kInitial), m_use_cost(m_nodes.size()),
+              m_move_list(m_nodes.size()) {
+            for (node_t n = 0; n != m_nodes.size(); ++n) {
+                m_index[m_nodes[n]] = n;
+                m_alias[n] = n;
+                m_use_cost[n] = static_cast<double>(m_nodes[n]->users().size() + 1);
+            }
+        }
+
+        /**
+         * @brief Build interference edges and phi moves.
+         *
+         * Live ranges are swept in order of their start: a range interferes with every range
+         * which is still open at its start.
+         */
+        void build(const LifeTime &life_time) {
+            struct RangeEvent {
+                LifeTime::life_range_t range;
+                node_t node;
+            };
+
+            std::vector<RangeEvent> events{};
+            for (node_t n = 0; n != m_nodes.size(); ++n) {
+                for (const auto &range : life_time.get_lifetime(m_nodes[n])) {
+                    if (range.first < range.second) {
+                        events.push_back({range, n});
+                    }
+                }
+            }
+            std::ranges::sort(events, [](const auto &a, const auto &b) {
+                return std::tie(a.range.first, a.node) < std::tie(b.range.first, b.node);
+            });
+
+            std::vector<RangeEvent> active{};
+            for (const auto &event : events) {
+                std::erase_if(active, [&event](const auto &a) {
+                    return a.range.second <= event.range.first;
+                });
+                for (const auto &a : active) {
+                    add_edge(a.node, event.node);
+                }
+                active.push_back(event);
+            }
+
+            for (node_t n = 0; n != m_nodes.size(); ++n) {
+                if (!PhiInstr::classof(m_nodes[n])) {
+                    continue;
+                }
+                auto *phi = static_cast<PhiInstr *>(m_nodes[n]);
+                for (auto &[incoming, _] : phi->get_phi_nodes()) {
+                    auto it = m_index.find(incoming);
+                    if (it == m_index.end() || it->second == n) {
+                        continue;
+                    }
+                    auto move = m_moves.size();
+                    m_moves.push_back({n, it->second});
+                    m_move_state.push_back(MoveState::kWorklist);
+                    m_move_list[n].push_back(move);
+                    m_move_list[it->second].push_back(move);
+                    m_worklist_moves.insert(move);
+                }
+            }
+        }
+
+        void run() {
+            make_worklist();
+
+            while (true) {
+                if (!m_simplify_worklist.empty()) {
+                    simplify();
+                } else if (!m_worklist_moves.empty()) {
+                    coalesce();
+                } else if (!m_freeze_worklist.empty()) {
+                    freeze();
+                } else if (!m_spill_worklist.empty()) {
+                    select_spill();
+                } else {
+                    break;
+                }
+            }
+
+            assign_colors();
+        }
+
+        void write_results(std::unordered_map<Instr *, Location> &results) const {
+            for (node_t n = 0; n != m_nodes.size(); ++n) {
+                if (m_node_state[n] == NodeState::kColored) {
+                    results[m_nodes[n]] = Location{Location::Kind::Register, m_color[n]};
+                } else {
+                    // Slot indices are assigned later by assign_spill_slots
+                    results[m_nodes[n]] = Location{Location::Kind::Spill, 0};
+                }
+            }
+        }
+
+      private:
+        static std::uint64_t edge_key(node_t u, node_t v) {
+            if (u > v) {
+                std::swap(u, v);
+            }
+            return (static_cast<std::uint64_t>(u) << 32) | v;
+        }
+
+        [[nodiscard]] bool interfere(node_t u, node_t v) const {
+            return m_adj_set.contains(edge_key(u, v));
+        }
+
+        void add_edge(node_t u, node_t v) {
+            if (u == v || !m_adj_set.insert(edge_key(u, v)).second) {
+                return;
+            }
+            m_adj_list[u].push_back(v);
+            m_adj_list[v].push_back(u);
+            ++m_degree[u];
+            ++m_degree[v];
+            push_spill_candidate(u);
+            push_spill_candidate(v);
+        }
+
+        // Spill cost is the number of uses divided by degree squared (Bernstein et al.), so
+        // cheap values with many conflicts go first
+        void push_spill_candidate(node_t n) {
+            if (m_node_state[n] != NodeState::kSpill) {
+                return;
+            }
+            m_spill_queue.push({spill_cost(n), n, m_degree[n]});
+        }
+
+        [[nodiscard]] double spill_cost(node_t n) const {
+            auto degree = static_cast<double>(std::max<std::size_t>(m_degree[n], 1));
+            return m_use_cost[n] / (degree * degree);
+        }
+
+        std::set<node_t> *worklist(NodeState state) {
+            switch (state) {
+            case NodeState::kSimplify:
+                return &m_simplify_worklist;
+            case NodeState::kFreeze:
+                return &m_freeze_worklist;
+            case NodeState::kSpill:
+                return &m_spill_worklist;
+            default:
+                return nullptr;
+            }
+        }
+
+        // Moves node from its current worklist (if any) to the worklist of the new state
+        void set_state(node_t n, NodeState state) {
+            if (auto *from = worklist(m_node_state[n])) {
+                from->erase(n);
+            }
+            if (auto *to = worklist(state)) {
+                to->insert(n);
+            }
+            m_node_state[n] = state;
+            push_spill_candidate(n);
+        }
+
+        [[nodiscard]] std::vector<node_t> adjacent(node_t n) const {
+            std::vector<node_t> adjacent{};
+            for (auto w : m_adj_list[n]) {
+                if (m_node_state[w] != NodeState::kSelect &&
+                    m_node_state[w] != NodeState::kCoalesced) {
+                    adjacent.push_back(w);
+                }
+            }
+            return adjacent;
+        }
+
+        [[nodiscard]] std::vector<std::size_t> node_moves(node_t n) const {
+            std::vector<std::size_t> moves{};
+            for (auto m : m_move_list[n]) {
+                if (m_move_state[m] == MoveState::kWorklist ||
+                    m_move_state[m] == MoveState::kActive) {
+                    moves.push_back(m);
+                }
+            }
+            return moves;
+        }
+
+        [[nodiscard]] bool move_related(node_t n) const { return !node_moves(n).empty(); }
+
+        [[nodiscard]] node_t get_alias(node_t n) const {
+            while (m_node_state[n] == NodeState::kCoalesced) {
+                n = m_alias[n];
+            }
+            return n;
+        }
+
+        void make_worklist() {
+            for (node_t n = 0; n != m_nodes.size(); ++n) {
+                if (m_degree[n] >= m_k) {
+                    set_state(n, NodeState::kSpill);
+                } else if (move_related(n)) {
+                    set_state(n, NodeState::kFreeze);
+                } else {
+                    set_state(n, NodeState::kSimplify);
+                }
+            }
+        }
+
+        void enable_moves(node_t n) {
+            for (auto m : node_moves(n)) {
+                if (m_move_state[m] == MoveState::kActive) {
+                    m_move_state[m] = MoveState::kWorklist;
+                    m_worklist_moves.insert(m);
+                }
+            }
+        }
+
+        void decrement_degree(node_t m) {
+            auto degree = m_degree[m]--;
+            if (degree != m_k) {
+                push_spill_candidate(m);
+                return;
+            }
+
+            enable_moves(m);
+            for (auto n : adjacent(m)) {
+                enable_moves(n);
+            }
+            if (worklist(m_node_state[m]) != nullptr) {
+                set_state(m, move_related(m) ? NodeState::kFreeze : NodeState::kSimplify);
+            }
+        }
+
+        void simplify() {
+            auto n = *m_simplify_worklist.begin();
+            set_state(n, NodeState::kSelect);
+            m_select_stack.push_back(n);
+
+            for (auto m : adjacent(n)) {
+                decrement_degree(m);
+            }
+        }
+
+        void add_worklist(node_t u) {
+            if (m_node_state[u] == NodeState::kFreeze && !move_related(u) && m_degree[u] < m_k) {
+                set_state(u, NodeState::kSimplify);
+            }
+        }
+
+        // Briggs test: the merged node has fewer than K neighbours of significant degree
+        [[nodiscard]] bool conservative(node_t u, node_t v) const {
+            std::set<node_t> nodes(std::from_range, adjacent(u));
+            nodes.insert_range(adjacent(v));
+
+            auto significant =
+                std::ranges::count_if(nodes, [this](auto n) { return m_degree[n] >= m_k; });
+            return static_cast<std::size_t>(significant) < m_k;
+        }
+
+        void combine(node_t u, node_t v) {
+            set_state(v, NodeState::kCoalesced);
+            m_alias[v] = u;
+            // spilling the merged node spills the uses of both values
+            m_use_cost[u] += m_use_cost[v];
+            m_move_list[u].append_range(m_move_list[v]);
+            enable_moves(v);
+
+            for (auto t : adjacent(v)) {
+                add_edge(t, u);
+                decrement_degree(t);
+            }
+            if (m_degree[u] >= m_k && m_node_state[u] == NodeState::kFreeze) {
+                set_state(u, NodeState::kSpill);
+            }
+            push_spill_candidate(u);
+        }
+
+        void coalesce() {
+            auto m = *m_worklist_moves.begin();
+            m_worklist_moves.erase(m_worklist_moves.begin());
+
+            auto u = get_alias(m_moves[m].dst);
+            auto v = get_alias(m_moves[m].src);
+
+            if (u == v) {
+                m_move_state[m] = MoveState::kCoalesced;
+                add_worklist(u);
+            } else if (interfere(u, v)) {
+                m_move_state[m] = MoveState::kConstrained;
+                add_worklist(u);
+                add_worklist(v);
+            } else if (conservative(u, v)) {
+                m_move_state[m] = MoveState::kCoalesced;
+                combine(u, v);
+                add_worklist(u);
+            } else {
+                m_move_state[m] = MoveState::kActive;
+            }
+        }
+
+        void freeze_moves(node_t u) {
+            for (auto m : node_moves(u)) {
+                auto x = get_alias(m_moves[m].dst);
+                auto y = get_alias(m_moves[m].src);
+                auto v = (y == get_alias(u)) ? x : y;
+
+                if (m_move_state[m] == MoveState::kWorklist) {
+                    m_worklist_moves.erase(m);
+                }
+                m_move_state[m] = MoveState::kFrozen;
+
+                if (m_node_state[v] == NodeState::kFreeze && !move_related(v) &&
+                    m_degree[v] < m_k) {
+                    set_state(v, NodeState::kSimplify);
+                }
+            }
+        }
+
+        void freeze() {
+            auto u = *m_freeze_worklist.begin();
+            set_state(u, NodeState::kSimplify);
+            freeze_moves(u);
+        }
+
+        void select_spill() {
+            while (m_node_state[m_spill_queue.top().node] != NodeState::kSpill ||
+                   m_degree[m_spill_queue.top().node] != m_spill_queue.top().degree ||
+                   spill_cost(m_spill_queue.top().node) != m_spill_queue.top().cost) {
+                m_spill_queue.pop();
+            }
+            auto m = m_spill_queue.top().node;
+            m_spill_queue.pop();
+
+            set_state(m, NodeState::kSimplify);
+            freeze_moves(m);
+        }
+
+        void assign_colors() {
+            std::vector<bool> ok_colors{};
+
+            while (!m_select_stack.empty()) {
+                auto n = m_select_stack.back();
+                m_select_stack.pop_back();
+
+                ok_colors.assign(m_k, true);
+                for (auto w : m_adj_list[n]) {
+                    auto a = get_alias(w);
+                    if (m_node_state[a] == NodeState::kColored) {
+                        ok_colors[m_color[a]] = false;
+                    }
+                }
+
+                auto it = std::ranges::find(ok_colors, true);
+                if (it == ok_colors.end()) {
+                    m_node_state[n] = NodeState::kSpilled;
+                } else {
+                    m_node_state[n] = NodeState::kColored;
+                    m_color[n] = static_cast<std::size_t>(it - ok_colors.begin());
+                }
+            }
+
+            for (node_t n = 0; n != m_nodes.size(); ++n) {
+                if (m_node_state[n] != NodeState::kCoalesced) {
+                    continue;
+                }
+                auto a = get_alias(n);
+                m_color[n] = m_color[a];
+                m_node_state[n] = m_node_state[a];
+            }
+        }
+    };
+};
+
+} // namespace injir::analysis
+
+#endif // GRAPH_COLORING_HPP
@@ -0,0 +1,170 @@
+#ifndef INDUCTION_HPP
+#define INDUCTION_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+#include "analysis/loop.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+/**
+ * @brief Basic induction variable: a header phi which is entered with init and incremented by a
+ * constant step on the back edge, phi = phi(init, phi + step).
+ */
+struct InductionVariable {
+    PhiInstr *phi;
+    Instr *init;
+    BinInstr *update;
+    i64 step;
+};
+
+// Derived induction variable: iv.phi * factor with a factor defined outside the loop
+struct DerivedInductionVariable {
+    BinInstr *mul;
+    Instr *factor;
+};
+
+/**
+ * @brief Exit condition of a loop left from its header when the induction variable passes limit.
+ *
+ * The header branches on cmp(iv.phi, limit) to body in the loop and out of the loop otherwise, so
+ * the blocks dominated by body see iv.phi <= limit, or iv.phi < limit when not inclusive.
+ */
+struct LoopBound {
+    InductionVariable iv;
+    Instr *limit;
+    bool inclusive;
+    BasicBlock *body;
+};
+
+// Inclusive range of unsigned values
+struct ValueRange {
+    i64 lower;
+    i64 upper;
+};
+
+inline std::optional<i64> constant_value(const Instr *instr) {
+    if (instr->type() != InstrType::kConst || instr->value_type() != Type::kInt) {
+        return std::nullopt;
+    }
+    return static_cast<const ConstInstr<i64> *>(instr)->get_value();
+}
+
+inline std::unordered_set<const Instr *> loop_instrs(const Loop &loop) {
+    std::unordered_set<const Instr *> instrs{};
+    for (auto *bb : loop.basic_blocks) {
+        for (const auto &instr : *bb) {
+            instrs.insert(instr.get());
+        }
+    }
+    return instrs;
+}
+
+inline std::vector<InductionVariable> induction_variables(const Loop &loop) {
+    assert(loop.header != nullptr && "the root loop has no induction variables");
+    if (!loop.reducible || loop.latches.size() != 1) {
+        return {};
+    }
+    auto *latch = loop.latches.front();
+
+    std::vector<InductionVariable> ivs{};
+    for (auto *phi : collect_instrs<PhiInstr>(*loop.header)) {
+        const auto &nodes = phi->get_phi_nodes();
+        if (nodes.size() != 2) {
+            continue;
+        }
+        auto back_it = std::ranges::find(nodes, latch, &PhiInstr::phi_node::second);
+        if (back_it == nodes.end() || back_it->first->type() != InstrType::kAdd) {
+            continue;
+        }
+        auto *init = (back_it == nodes.begin() ? nodes.back() : nodes.front()).first;
+
+        auto *update = static_cast<BinInstr *>(back_it->first);
+        auto *step = update->get_lhs() == phi ? update->get_rhs() : update->get_lhs();
+        auto step_value = constant_value(step);
+        if (step == phi || (update->get_lhs() != phi && update->get_rhs() != phi) ||
+            !step_value.has_value() || *step_value == 0) {
+            continue;
+        }
+        ivs.push_back({phi, init, update, *step_value});
+    }
+    return ivs;
+}
+
+inline std::vector<DerivedInductionVariable>
+derived_induction_variables(const Loop &loop, const InductionVariable &iv) {
+    auto instrs = loop_instrs(loop);
+
+    std::vector<DerivedInductionVariable> derived{};
+    for (auto *user : iv.phi->users()) {
+        if (user->type() != InstrType::kMul || !instrs.contains(user)) {
+            continue;
+        }
+        auto *mul = static_cast<BinInstr *>(user);
+        auto *factor = mul->get_lhs() == iv.phi ? mul->get_rhs() : mul->get_lhs();
+        if (factor != iv.phi && !instrs.contains(factor) &&
+            std::ranges::find(derived, mul, &DerivedInductionVariable::mul) == derived.end()) {
+            derived.push_back({mul, factor});
+        }
+    }
+    return derived;
+}
+
+inline std::optional<LoopBound> loop_bound(const Loop &loop) {
+    auto *header = loop.header;
+    assert(header != nullptr && "the root loop has no bound");
+    if (header->size() == 0 || header->get_false_successor() == nullptr) {
+        return std::nullopt;
+    }
+    auto *cond = std::prev(header->end())->get()->operands().front();
+    if (cond->type() != InstrType::kCmpLess && cond->type() != InstrType::kCmpLessEqual) {
+        return std::nullopt;
+    }
+
+    auto is_in_loop = [&loop](auto *bb) {
+        return std::ranges::find(loop.basic_blocks, bb) != loop.basic_blocks.end();
+    };
+    auto *body = header->get_true_successor();
+    if (!is_in_loop(body) || is_in_loop(header->get_false_successor())) {
+        return std::nullopt;
+    }
+
+    auto *cmp = static_cast<BinInstr *>(cond);
+    auto ivs = induction_variables(loop);
+    auto iv_it = std::ranges::find(ivs, cmp->get_lhs(), &InductionVariable::phi);
+    if (iv_it == ivs.end() || loop_instrs(loop).contains(cmp->get_rhs())) {
+        return std::nullopt;
+    }
+    return LoopBound{*iv_it, cmp->get_rhs(), cond->type() == InstrType::kCmpLessEqual, body};
+}
+
+/**
+ * @brief Values of the induction variable in the blocks dominated by bound.body.
+ *
+ * Known when init and limit are constants and the variable cannot wrap around: the last value
+ * which passes the exit condition plus the step must not overflow.
+ */
+inline std::optional<ValueRange> iv_range(const LoopBound &bound) {
+    auto init = constant_value(bound.iv.init);
+    auto limit = constant_value(bound.limit);
+    if (!init.has_value() || !limit.has_value() || (!bound.inclusive && *limit == 0)) {
+        return std::nullopt;
+    }
+
+    auto upper = bound.inclusive ? *limit : *limit - 1;
+    if (*init > upper || upper > std::numeric_limits<i64>::max() - bound.iv.step) {
+        return std::nullopt;
+    }
+    return ValueRange{*init, upper};
+}
+
+} // namespace injir::analysis
+
+#endif // INDUCTION_HPP
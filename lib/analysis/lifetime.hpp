@@ -66,9 +66,11 @@ class LifeTime {
     std::unordered_map<Instr *, life_ranges_t> m_intervals;
 
     std::unordered_map<BasicBlock *, std::size_t> m_bb_lifetimes;
+    std::unordered_map<BasicBlock *, std::size_t> m_loop_depths;
 
-  private:
-    std::vector<Instr *> input_operands(Instr *instr) {
+  public:
+    // Values read by instr other than a phi, whose incoming values are read in the predecessors
+    static std::vector<Instr *> input_operands(Instr *instr) {
         assert(instr != nullptr && "instr is nullptr");
         std::vector<Instr *> input_operands{};
 
@@ -100,6 +102,11 @@ class LifeTime {
                 input_operands.push_back(cond_op);
                 break;
             }
+            case InstrType::kCall: {
+                auto &args = static_cast<CallInstr *>(instr)->get_args();
+                input_operands.insert(input_operands.end(), args.begin(), args.end());
+                break;
+            }
             case InstrType::kReturn: {
                 auto *ret_instr = static_cast<ReturnInstr *>(instr);
 
@@ -122,6 +129,7 @@ class LifeTime {
         return input_operands;
     }
 
+  private:
     void update_intervals(std::unordered_map<Instr *, life_range_t> bb_intervals) {
         for (auto &[instr, life_range] : bb_intervals) {
             if (!m_intervals.contains(instr)) {
@@ -247,17 +255,56 @@ class LifeTime {
         std::ranges::reverse(m_reverse_linear_order);
 
         build_intervals(loop_tree);
+
+        // The blocks of a loop include the blocks of its inner loops
+        for (const auto &[header, loop] : loop_tree) {
+            if (header == nullptr) {
+                continue;
+            }
+            std::unordered_set<BasicBlock *> blocks{loop.basic_blocks.begin(),
+                                                    loop.basic_blocks.end()};
+            for (auto *bb : blocks) {
+                ++m_loop_depths[bb];
+            }
+        }
     }
 
     auto begin() const { return m_intervals.begin(); }
     auto end() const { return m_intervals.end(); }
     auto size() const { return m_intervals.size(); }
 
-    [[nodiscard]] life_ranges_t get_lifetime(Instr *instr) const {
-        if (!m_intervals.contains(instr)) {
-            return life_ranges_t{};
-        }
-        return m_intervals.at(instr);
+    [[nodiscard]] const life_ranges_t &get_lifetime(Instr *instr) const {
+        static const life_ranges_t kEmpty{};
+        auto it = m_intervals.find(instr);
+        return it != m_intervals.end() ? it->second : kEmpty;
+    }
+
+    // Lifetime point of the first instruction of bb
+    [[nodiscard]] std::size_t get_bb_lifetime(BasicBlock *bb) const {
+        return m_bb_lifetimes.at(bb);
+    }
+
+    // Number of loops containing bb, 0 outside of any loop
+    [[nodiscard]] std::size_t get_loop_depth(BasicBlock *bb) const {
+        auto it = m_loop_depths.find(bb);
+        return it != m_loop_depths.end() ? it->second : 0;
+    }
+
+    // Basic blocks in the linear order the lifetime points are assigned in
+    [[nodiscard]] auto linear_order() const { return std::views::reverse(m_reverse_linear_order); }
+
+    // Whether one of the half-open ranges holds point
+    static bool is_live_at(const life_ranges_t &ranges, std::size_t point) {
+        return std::ranges::any_of(ranges, [point](const auto &range) {
+            return range.first <= point && point < range.second;
+        });
+    }
+
+    static bool overlap(const life_ranges_t &lhs, const life_ranges_t &rhs) {
+        return std::ranges::any_of(lhs, [&rhs](const auto &l) {
+            return std::ranges::any_of(
+                rhs, [&l](const auto &r) { return l.first < r.second && r.first < l.second; });
+        });
     }
 };
 
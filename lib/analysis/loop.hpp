@@ -1,6 +1,7 @@
 #ifndef LOOP_HPP
 #define LOOP_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <ranges>
 #include <unordered_map>
@@ -43,9 +44,11 @@ static void collect_back_edges(BasicBlock *basic_block, loop_tree_t &loop_tree,
 
             loop.latches.push_back(basic_block);
 
+            // a block does not strictly dominate itself, but a self loop is reducible
             const auto &header_doms = dom_tree.at(basic_block_successor);
-            if (std::find(header_doms.begin(), header_doms.end(), basic_block) !=
-                header_doms.end()) {
+            if (basic_block == basic_block_successor ||
+                std::find(header_doms.begin(), header_doms.end(), basic_block) !=
+                    header_doms.end()) {
                 loop.reducible = true;
             }
         }
@@ -105,7 +108,9 @@ static void populate_loops(std::vector<BasicBlock *> rpo_vector, loop_tree_t &lo
             loop.header->add_marker(Marker::dfs);
 
             for (const auto &latch : loop.latches) {
-                loop_search(latch, loop, bb_to_loop);
+                if (latch != loop.header) {
+                    loop_search(latch, loop, bb_to_loop);
+                }
             }
 
         } else {
@@ -121,6 +126,26 @@ static void populate_loops(std::vector<BasicBlock *> rpo_vector, loop_tree_t &lo
     }
 }
 
+// The only block outside the loop which enters it, when it jumps to the header unconditionally
+inline BasicBlock *find_preheader(const Loop &loop) {
+    assert(loop.header != nullptr && "the root loop has no preheader");
+
+    BasicBlock *preheader = nullptr;
+    for (auto pred_it = loop.header->preds_begin(), pred_end = loop.header->preds_end();
+         pred_it != pred_end; ++pred_it) {
+        if (std::find(loop.basic_blocks.begin(), loop.basic_blocks.end(), *pred_it) !=
+            loop.basic_blocks.end()) {
+            continue;
+        }
+        if (preheader != nullptr) {
+            return nullptr;
+        }
+        preheader = *pred_it;
+    }
+    return preheader != nullptr && preheader->get_false_successor() == nullptr ? preheader
+                                                                               : nullptr;
+}
+
 inline loop_tree_t loop_tree(BasicBlock *basic_block) {
     assert(basic_block != nullptr && "basic block is nullptr");
 
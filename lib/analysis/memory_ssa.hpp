@@ -0,0 +1,300 @@
+#ifndef MEMORY_SSA_HPP
+#define MEMORY_SSA_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "graph/dom.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+enum class MemoryAccessKind {
+    kLiveOnEntry,
+    kPhi,
+    kDef,
+    kUse,
+};
+
+/**
+ * @brief A state of the whole memory: stores and calls define a new one, loads use one, phis merge
+ * them where control flow joins.
+ */
+struct MemoryAccess {
+    MemoryAccessKind kind;
+    BasicBlock *bb = nullptr;
+    // the store, call or load, nullptr for phis and live on entry
+    Instr *instr = nullptr;
+    // the state a def or a use reads
+    MemoryAccess *defining = nullptr;
+    // the states a phi merges, one per predecessor
+    std::vector<std::pair<MemoryAccess *, BasicBlock *>> incoming{};
+    // defs, uses and phis reading this state
+    std::vector<MemoryAccess *> users{};
+};
+
+/**
+ * @brief Memory SSA: memory treated as a single variable in SSA form.
+ *
+ * Phis are placed at the iterated dominance frontier of the blocks with defs, then the dominator
+ * tree is walked with the current state, as in pass::Mem2Reg. Every def and use links to the state
+ * it reads and every state to its readers, so each step up or down the chains is O(1).
+ *
+ * clobbering_access walks up from a load skipping the defs which cannot write its location, so
+ * passes query only the accesses between a load and its clobber instead of scanning blocks.
+ * Removing a def or a use and inserting a use of a load which was moved keep the form valid, the
+ * dominator tree must not change in between.
+ */
+class MemorySSA final {
+  private:
+    std::vector<std::unique_ptr<MemoryAccess>> m_storage{};
+    MemoryAccess *m_live_on_entry = nullptr;
+    std::unordered_map<const Instr *, MemoryAccess *> m_accesses{};
+    std::unordered_map<const BasicBlock *, MemoryAccess *> m_phis{};
+    // defs and uses of every block in program order
+    std::unordered_map<const BasicBlock *, std::vector<MemoryAccess *>> m_block_accesses{};
+    graph::idom_t m_idoms{};
+    graph::dom_tree_t m_dom_tree{};
+
+    static bool is_def(const Instr *instr) {
+        return StoreInstr::classof(instr) || CallInstr::classof(instr);
+    }
+
+    MemoryAccess *create(MemoryAccessKind kind, BasicBlock *bb, Instr *instr) {
+        m_storage.push_back(std::make_unique<MemoryAccess>(MemoryAccess{kind, bb, instr}));
+        return m_storage.back().get();
+    }
+
+    static void link(MemoryAccess *access, MemoryAccess *defining) {
+        access->defining = defining;
+        defining->users.push_back(access);
+    }
+
+    static void unlink(MemoryAccess *access, MemoryAccess *defining) {
+        auto it = std::ranges::find(defining->users, access);
+        assert(it != defining->users.end() && "access is not a user of its defining access");
+        defining->users.erase(it);
+    }
+
+    void rename(BasicBlock *bb, MemoryAccess *current) {
+        if (auto *phi = this->phi(bb); phi != nullptr) {
+            current = phi;
+        }
+        for (auto *access : m_block_accesses[bb]) {
+            link(access, current);
+            if (access->kind == MemoryAccessKind::kDef) {
+                current = access;
+            }
+        }
+
+        for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+            if (auto *phi = this->phi(succ); phi != nullptr) {
+                phi->incoming.emplace_back(current, bb);
+                current->users.push_back(phi);
+            }
+        }
+
+        if (auto it = m_dom_tree.find(bb); it != m_dom_tree.end()) {
+            for (auto *child : it->second) {
+                rename(child, current);
+            }
+        }
+    }
+
+    bool is_clobber(MemoryAccess *def, Instr *ptr, AliasAnalysis &alias_analysis) const {
+        if (StoreInstr::classof(def->instr)) {
+            return alias_analysis.may_alias(static_cast<StoreInstr *>(def->instr)->ptr(), ptr);
+        }
+        return !alias_analysis.is_local(ptr);
+    }
+
+    // nullptr when every path from access leads back to a phi being walked
+    MemoryAccess *clobber(MemoryAccess *access, Instr *ptr, AliasAnalysis &alias_analysis,
+                          std::unordered_set<MemoryAccess *> &visited) const {
+        while (access->kind == MemoryAccessKind::kDef && !is_clobber(access, ptr, alias_analysis)) {
+            access = access->defining;
+        }
+        if (access->kind != MemoryAccessKind::kPhi) {
+            return access;
+        }
+        if (!visited.insert(access).second) {
+            return nullptr;
+        }
+
+        // the phi is transparent when all its incoming states have the same clobber
+        MemoryAccess *result = nullptr;
+        for (auto &[incoming, _] : access->incoming) {
+            auto *incoming_clobber = clobber(incoming, ptr, alias_analysis, visited);
+            if (incoming_clobber == nullptr || incoming_clobber == result) {
+                continue;
+            }
+            if (result != nullptr) {
+                return access;
+            }
+            result = incoming_clobber;
+        }
+        return result != nullptr ? result : access;
+    }
+
+  public:
+    explicit MemorySSA(Function &func) {
+        m_live_on_entry = create(MemoryAccessKind::kLiveOnEntry, nullptr, nullptr);
+        if (func.size() == 0) {
+            return;
+        }
+        auto *entry = &*func.begin();
+        m_idoms = graph::idom(entry);
+        m_dom_tree = graph::idom_tree(entry);
+
+        std::vector<BasicBlock *> def_blocks{};
+        for (auto &bb : func) {
+            if (!m_idoms.contains(&bb)) {
+                continue;
+            }
+            auto &accesses = m_block_accesses[&bb];
+            for (auto &instr : bb) {
+                if (!is_def(instr.get()) && !LoadInstr::classof(instr.get())) {
+                    continue;
+                }
+                auto kind = is_def(instr.get()) ? MemoryAccessKind::kDef : MemoryAccessKind::kUse;
+                auto *access = create(kind, &bb, instr.get());
+                m_accesses.emplace(instr.get(), access);
+                accesses.push_back(access);
+                if (kind == MemoryAccessKind::kDef &&
+                    (def_blocks.empty() || def_blocks.back() != &bb)) {
+                    def_blocks.push_back(&bb);
+                }
+            }
+        }
+
+        auto frontiers = graph::dom_frontier(m_idoms);
+        for (auto *bb : graph::iterated_dom_frontier(frontiers, def_blocks)) {
+            m_phis.emplace(bb, create(MemoryAccessKind::kPhi, bb, nullptr));
+        }
+        rename(entry, m_live_on_entry);
+    }
+
+    // The state of memory when the function is entered
+    MemoryAccess *live_on_entry() const { return m_live_on_entry; }
+
+    // nullptr when instr does not access memory or is unreachable
+    MemoryAccess *access(const Instr *instr) const {
+        auto it = m_accesses.find(instr);
+        return it != m_accesses.end() ? it->second : nullptr;
+    }
+
+    MemoryAccess *phi(const BasicBlock *bb) const {
+        auto it = m_phis.find(bb);
+        return it != m_phis.end() ? it->second : nullptr;
+    }
+
+    const std::vector<MemoryAccess *> &block_accesses(const BasicBlock *bb) const {
+        static const std::vector<MemoryAccess *> empty{};
+        auto it = m_block_accesses.find(bb);
+        return it != m_block_accesses.end() ? it->second : empty;
+    }
+
+    // The state reaching the start of bb
+    MemoryAccess *state_in(BasicBlock *bb) const {
+        if (auto *phi = this->phi(bb); phi != nullptr) {
+            return phi;
+        }
+        for (auto it = m_idoms.find(bb); it != m_idoms.end() && it->second != nullptr;
+             it = m_idoms.find(it->second)) {
+            auto defs = block_accesses(it->second) | std::views::reverse;
+            if (auto def_it = std::ranges::find(defs, MemoryAccessKind::kDef, &MemoryAccess::kind);
+                def_it != defs.end()) {
+                return *def_it;
+            }
+            if (auto *phi = this->phi(it->second); phi != nullptr) {
+                return phi;
+            }
+        }
+        return m_live_on_entry;
+    }
+
+    /**
+     * @brief The nearest def or phi above the use of a load which may write the loaded location.
+     *
+     * A store clobbers the load when its pointer may alias, a call unless the location is local to
+     * the function (see AliasAnalysis::is_local). A phi is looked through when all its incoming
+     * states lead to the same clobber.
+     */
+    MemoryAccess *clobbering_access(MemoryAccess *use, AliasAnalysis &alias_analysis) const {
+        assert(use->kind == MemoryAccessKind::kUse && "clobbers are queried for loads");
+        std::unordered_set<MemoryAccess *> visited{};
+        auto *ptr = static_cast<LoadInstr *>(use->instr)->ptr();
+        return clobber(use->defining, ptr, alias_analysis, visited);
+    }
+
+    /**
+     * @brief Forgets the access of instr before the instruction is erased or moved.
+     *
+     * The readers of a removed def read the state it was defined from.
+     */
+    void remove(const Instr *instr) {
+        auto it = m_accesses.find(instr);
+        if (it == m_accesses.end()) {
+            return;
+        }
+        auto *access = it->second;
+        m_accesses.erase(it);
+        std::erase(m_block_accesses[access->bb], access);
+        unlink(access, access->defining);
+
+        for (auto *user : access->users) {
+            if (user->kind == MemoryAccessKind::kPhi) {
+                for (auto &[incoming, _] : user->incoming) {
+                    if (incoming == access) {
+                        incoming = access->defining;
+                    }
+                }
+                access->defining->users.push_back(user);
+            } else {
+                link(user, access->defining);
+            }
+        }
+        access->users.clear();
+        access->defining = nullptr;
+    }
+
+    // Creates the use of a load which was inserted into or moved to bb
+    MemoryAccess *insert_use(LoadInstr *load, BasicBlock *bb) {
+        assert(!m_accesses.contains(load) && "load already has an access");
+        assert(m_idoms.contains(bb) && "bb is not in the dominator tree");
+
+        auto *current = state_in(bb);
+        auto &accesses = m_block_accesses[bb];
+        auto pos = accesses.begin();
+        for (auto &instr : *bb) {
+            if (instr.get() == load) {
+                break;
+            }
+            if (pos != accesses.end() && (*pos)->instr == instr.get()) {
+                if ((*pos)->kind == MemoryAccessKind::kDef) {
+                    current = *pos;
+                }
+                ++pos;
+            }
+        }
+
+        auto *access = create(MemoryAccessKind::kUse, bb, load);
+        accesses.insert(pos, access);
+        m_accesses.emplace(load, access);
+        link(access, current);
+        return access;
+    }
+};
+
+} // namespace injir::analysis
+
+#endif // MEMORY_SSA_HPP
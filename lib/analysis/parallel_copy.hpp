@@ -0,0 +1,131 @@
+#ifndef PARALLEL_COPY_HPP
+#define PARALLEL_COPY_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "analysis/regalloc.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+using Location = RegisterAllocator::Location;
+
+using parallel_copy_t = RegisterAllocator::parallel_copy_t;
+
+struct Move {
+    enum class Kind {
+        // to = from
+        kMove,
+        // exchange the contents of from and to
+        kSwap,
+    };
+
+    Kind kind;
+    Location from;
+    Location to;
+};
+
+/**
+ * @brief Order a parallel copy into a sequence of moves with the same effect.
+ *
+ * A copy is emitted once no other pending copy reads its destination. When only cycles are
+ * left, one copy of a cycle is done by a swap and the copy reading its destination is redirected
+ * to the swapped-out value, so a cycle of n locations takes n - 1 swaps and no scratch location.
+ * Given a free scratch location, a cycle is instead opened by saving one of its values there,
+ * which costs n + 1 plain moves.
+ */
+inline std::vector<Move> sequentialize(parallel_copy_t copies,
+                                       std::optional<Location> scratch = std::nullopt) {
+    assert(std::ranges::none_of(copies,
+                                [&scratch](const auto &copy) {
+                                    return copy.first == scratch || copy.second == scratch;
+                                }) &&
+           "scratch location is used by the copy");
+    std::vector<Move> moves{};
+
+    auto is_noop = [](const auto &copy) { return copy.first == copy.second; };
+    std::erase_if(copies, is_noop);
+
+    while (!copies.empty()) {
+        auto ready = std::ranges::find_if(copies, [&copies](const auto &copy) {
+            return std::ranges::none_of(
+                copies, [&copy](const auto &other) { return other.first == copy.second; });
+        });
+
+        if (ready != copies.end()) {
+            moves.push_back({Move::Kind::kMove, ready->first, ready->second});
+            copies.erase(ready);
+            continue;
+        }
+
+        // Every destination is still read by another copy: the rest are disjoint cycles
+        if (scratch.has_value()) {
+            auto saved = copies.front().first;
+            moves.push_back({Move::Kind::kMove, saved, *scratch});
+            for (auto &copy : copies) {
+                if (copy.first == saved) {
+                    copy.first = *scratch;
+                }
+            }
+            continue;
+        }
+
+        auto [from, to] = copies.front();
+        copies.erase(copies.begin());
+        moves.push_back({Move::Kind::kSwap, from, to});
+
+        for (auto &copy : copies) {
+            if (copy.first == to) {
+                copy.first = from;
+            }
+        }
+        std::erase_if(copies, is_noop);
+    }
+    return moves;
+}
+
+// Copies which implement the phis of succ on the edge from pred
+inline parallel_copy_t phi_copies(const RegisterAllocator &alloc, BasicBlock *pred,
+                                  BasicBlock *succ) {
+    assert(pred != nullptr && "basic block is nullptr");
+    assert(succ != nullptr && "basic block is nullptr");
+
+    parallel_copy_t copies{};
+    for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+        auto to = alloc.get_location(phi);
+        // the phi is never used
+        if (!to.has_value()) {
+            continue;
+        }
+
+        for (const auto &[value, bb] : phi->get_phi_nodes()) {
+            if (bb != pred) {
+                continue;
+            }
+            auto from = alloc.get_location(value);
+            assert(from.has_value() && "incoming value of a live phi has no location");
+            copies.emplace_back(*from, *to);
+        }
+    }
+    return copies;
+}
+
+/**
+ * @brief Moves to insert on the edge pred -> succ instead of the phis of succ.
+ *
+ * The moves belong to the end of pred when it has a single successor and to the start of succ
+ * when it has a single predecessor; a critical edge has to be split first.
+ */
+inline std::vector<Move> lower_phis(const RegisterAllocator &alloc, BasicBlock *pred,
+                                    BasicBlock *succ) {
+    return sequentialize(phi_copies(alloc, pred, succ));
+}
+
+} // namespace injir::analysis
+
+#endif // PARALLEL_COPY_HPP
@@ -1,31 +1,190 @@
 #ifndef REGALLOC_HPP
 #define REGALLOC_HPP
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
 #include <ranges>
-#include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "analysis/lifetime.hpp"
 #include "ir/instr.hpp"
 
 namespace injir::analysis {
 
-class LinearScan {
+enum class RegClass : std::size_t {
+    kInt,
+    kFloat,
+};
+
+inline constexpr std::size_t kRegClassesNum = 2;
+
+// Number of available registers for each RegClass
+using regs_num_t = std::array<std::size_t, kRegClassesNum>;
+
+inline RegClass reg_class(const Instr *instr) {
+    assert(instr != nullptr && "instr is nullptr");
+    return instr->value_type() == Type::kFloat ? RegClass::kFloat : RegClass::kInt;
+}
+
+/**
+ * @brief Set of register indices of one class, one bit per register.
+ *
+ * Up to 64 registers fit in a single word, so taking the lowest register is a count of
+ * trailing zeros and the set itself never allocates per register.
+ */
+class RegisterSet {
+  private:
+    static constexpr std::size_t kWordBits = 64;
+    std::vector<std::uint64_t> m_words;
+
+  public:
+    RegisterSet() = default;
+    explicit RegisterSet(std::size_t regs_num)
+        : m_words((regs_num + kWordBits - 1) / kWordBits) {}
+
+    // Set holding registers [0, regs_num)
+    static RegisterSet all(std::size_t regs_num) {
+        RegisterSet set{regs_num};
+        std::ranges::fill(set.m_words, ~std::uint64_t{0});
+        if (auto tail = regs_num % kWordBits; tail != 0) {
+            set.m_words.back() = (std::uint64_t{1} << tail) - 1;
+        }
+        return set;
+    }
+
+    void insert(std::size_t reg) {
+        assert(reg / kWordBits < m_words.size() && "register out of bounds");
+        m_words[reg / kWordBits] |= std::uint64_t{1} << (reg % kWordBits);
+    }
+
+    void erase(std::size_t reg) {
+        assert(reg / kWordBits < m_words.size() && "register out of bounds");
+        m_words[reg / kWordBits] &= ~(std::uint64_t{1} << (reg % kWordBits));
+    }
+
+    [[nodiscard]] bool contains(std::size_t reg) const {
+        return reg / kWordBits < m_words.size() &&
+               (m_words[reg / kWordBits] >> (reg % kWordBits) & 1) != 0;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return std::ranges::all_of(m_words, [](auto word) { return word == 0; });
+    }
+
+    // Lowest register of the set satisfying pred
+    template <typename Pred> [[nodiscard]] std::optional<std::size_t> find_first(Pred pred) const {
+        for (std::size_t i = 0; i != m_words.size(); ++i) {
+            for (auto word = m_words[i]; word != 0; word &= word - 1) {
+                auto reg = i * kWordBits + static_cast<std::size_t>(std::countr_zero(word));
+                if (pred(reg)) {
+                    return reg;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    // Remove and return the lowest register of a non-empty set
+    std::size_t take_first() {
+        for (std::size_t i = 0; i != m_words.size(); ++i) {
+            if (auto &word = m_words[i]; word != 0) {
+                auto bit = static_cast<std::size_t>(std::countr_zero(word));
+                word &= word - 1;
+                return i * kWordBits + bit;
+            }
+        }
+        assert(false && "register set is empty");
+        return 0;
+    }
+};
+
+/**
+ * @brief Registers used by calls, arguments and returns, for each register class.
+ *
+ * The arguments of one class are passed in arg_regs in their order, the ones beyond it on the
+ * stack. A result is returned in ret_reg and a call clobbers every register of caller_saved.
+ * The default convention constrains nothing.
+ */
+struct CallingConvention {
+    struct ClassConvention {
+        std::vector<std::size_t> arg_regs{};
+        std::optional<std::size_t> ret_reg{};
+        std::vector<std::size_t> caller_saved{};
+    };
+
+    std::array<ClassConvention, kRegClassesNum> classes{};
+};
+
+// Heuristics of LinearScan, each one can be turned off to compare against plain linear scan
+struct LinearScanOptions {
+    // Recompute cheap values instead of spilling them, see LinearScan::remat_cost
+    bool rematerialize = true;
+    // Choose the value to spill by its uses weighted by loop depth, see
+    // LinearScan::get_spill_weight, rather than by the furthest end alone
+    bool spill_weights = true;
+};
+
+/**
+ * @brief Common part of the register allocators: per-value locations and the stack frame.
+ *
+ * Derived allocators fill m_results with a Location for every value of LifeTime, spill slot
+ * indices are then assigned by assign_spill_slots.
+ */
+class RegisterAllocator {
   public:
     struct Location {
-        enum class Kind { Register, Spill };
+        // A rematerialized value is kept nowhere and recomputed at its uses
+        enum class Kind { Register, Spill, Remat };
         Kind kind;
+        // Register, spill slot or number of the rematerialized value
         std::size_t index;
+        // Always filled in by get_location, register indices are numbered within the class
+        RegClass reg_class = RegClass::kInt;
+
+        // Spill slots are shared between classes, registers are not
+        bool operator==(const Location &rhs) const noexcept {
+            return kind == rhs.kind && index == rhs.index &&
+                   (kind == Kind::Spill || reg_class == rhs.reg_class);
+        }
     };
 
-  private:
+    // Copy from first to second, all copies of a parallel copy read their sources before any write
+    using parallel_copy_t = std::vector<std::pair<Location, Location>>;
+
+    // Every value is a 64-bit scalar, so each spill slot takes one 8-byte stack cell
+    static constexpr std::size_t kSpillSlotSize = 8;
+
+  protected:
     std::unordered_map<Instr *, Location> m_results;
+    std::size_t m_spill_slots_num = 0;
 
   public:
-    explicit LinearScan(std::size_t regs_num, const LifeTime &life_time) {
-        auto intervals = prepare_intervals(life_time);
-        allocate(regs_num, intervals);
+    virtual ~RegisterAllocator() = default;
+
+    [[nodiscard]] std::optional<Location> get_location(Instr *instr) const {
+        auto it = m_results.find(instr);
+        if (it == m_results.end()) {
+            return std::nullopt;
+        }
+        auto location = it->second;
+        location.reg_class = reg_class(instr);
+        return location;
+    }
+
+    // Location of instr at a lifetime point: the same everywhere unless the allocator splits
+    [[nodiscard]] virtual std::optional<Location> location_at(Instr *instr,
+                                                              std::size_t /*point*/) const {
+        return get_location(instr);
     }
 
     [[nodiscard]] std::optional<std::size_t> get_register(Instr *instr) const {
@@ -42,79 +201,651 @@ class LinearScan {
         return it->second.index;
     }
 
-  private:
+    [[nodiscard]] std::size_t get_spill_slots_num() const noexcept { return m_spill_slots_num; }
+    [[nodiscard]] std::size_t get_frame_size() const noexcept {
+        return m_spill_slots_num * kSpillSlotSize;
+    }
+
+  protected:
     using interval_t = LifeTime::life_range_t;
     using instr_interval_t = std::pair<Instr *, LifeTime::life_range_t>;
 
-    std::vector<instr_interval_t> prepare_intervals(const LifeTime &lifetime) {
-        std::vector<std::pair<Instr *, LifeTime::life_range_t>> intervals;
-        intervals.reserve(lifetime.size());
-
-        std::ranges::transform(lifetime, std::back_inserter(intervals), [](const auto &e) {
-            const auto &ranges = e.second;
-            auto start = std::ranges::min(ranges, {}, &LifeTime::life_range_t::first).first;
-            auto end = std::ranges::max(ranges, {}, &LifeTime::life_range_t::second).second;
-            return std::make_pair(e.first, std::make_pair(start, end));
-        });
+    // Single interval covering all the ranges, lifetime holes included
+    static interval_t hull(const LifeTime::life_ranges_t &ranges) {
+        auto start = std::ranges::min(ranges, {}, &LifeTime::life_range_t::first).first;
+        auto end = std::ranges::max(ranges, {}, &LifeTime::life_range_t::second).second;
+        return {start, end};
+    }
 
+    static void sort_intervals(std::vector<instr_interval_t> &intervals) {
         std::ranges::sort(intervals, [](const auto &a, const auto &b) {
             if (a.second.first != b.second.first)
                 return a.second.first < b.second.first;
-            // for stable sort for exact tests
+            // longer intervals first, so ties do not depend on where the values were allocated
+            if (a.second.second != b.second.second)
+                return a.second.second > b.second.second;
             return a.first < b.first;
         });
+    }
+
+    static std::vector<instr_interval_t> prepare_intervals(const LifeTime &lifetime) {
+        std::vector<std::pair<Instr *, LifeTime::life_range_t>> intervals;
+        intervals.reserve(lifetime.size());
+
+        std::ranges::transform(lifetime, std::back_inserter(intervals), [](const auto &e) {
+            return std::make_pair(e.first, hull(e.second));
+        });
+
+        sort_intervals(intervals);
         return intervals;
     }
 
-    void add_active_interval(std::vector<instr_interval_t> &active, Instr *instr,
-                             const interval_t &interval) {
-        auto it = std::ranges::lower_bound(active, interval.second, {},
-                                           [](const auto &a) { return a.second.second; });
-        active.insert(it, {instr, interval});
+    template <typename T>
+    using min_heap_t = std::priority_queue<T, std::vector<T>, std::greater<>>;
+
+    /**
+     * @brief Color spilled intervals with stack slots.
+     *
+     * Second linear scan over the spilled intervals only: a slot is returned to the pool as
+     * soon as the interval holding it ends, so non-overlapping spills share one stack cell.
+     * Intervals are sorted by start, hence the number of slots is the maximal number of
+     * simultaneously live spilled values, i.e. the smallest possible frame. Any number of spilled
+     * values may be live at once, so both the held and the free slots are heaps.
+     *
+     * Values kept in a register which still need a stack cell, e.g. to be saved across calls,
+     * get their slot in save_slots.
+     */
+    void assign_spill_slots(const std::vector<instr_interval_t> &intervals,
+                            std::unordered_map<Instr *, std::size_t> *save_slots = nullptr) {
+        // (end, slot) of the intervals holding a slot, the earliest end on top
+        min_heap_t<std::pair<std::size_t, std::size_t>> active{};
+        min_heap_t<std::size_t> free_slots{};
+
+        for (const auto &[instr, interval] : intervals) {
+            std::size_t *slot = nullptr;
+            if (auto &location = m_results.at(instr); location.kind == Location::Kind::Spill) {
+                slot = &location.index;
+            } else if (save_slots != nullptr) {
+                if (auto it = save_slots->find(instr); it != save_slots->end()) {
+                    slot = &it->second;
+                }
+            }
+            if (slot == nullptr) {
+                continue;
+            }
+
+            while (!active.empty() && active.top().first <= interval.first) {
+                free_slots.push(active.top().second);
+                active.pop();
+            }
+
+            if (free_slots.empty()) {
+                *slot = m_spill_slots_num++;
+            } else {
+                *slot = free_slots.top();
+                free_slots.pop();
+            }
+            active.emplace(interval.second, *slot);
+        }
+    }
+};
+
+/**
+ * @brief Linear scan over the hulls of the lifetime ranges.
+ *
+ * With a CallingConvention the allocation also follows the fixed registers: arguments, call
+ * results and values passed to calls or returned are hinted to their registers, and an argument
+ * register is reserved for its ArgInstr until the argument is defined. Values live across a call
+ * are given callee-saved registers first. A value which still ends up in a caller-saved register
+ * is split around each call it crosses: location_at moves it to a save slot at the call point.
+ * Whatever the hints miss is left to the copies of get_fixed_copies.
+ *
+ * Constants, arguments passed on the stack and short expressions of them are rematerialized
+ * rather than spilled, see remat_cost: they need neither a slot nor a store. Such values are
+ * also the first ones evicted from a register, and are never split around calls.
+ *
+ * Otherwise the value evicted is the one with the smallest spill weight: a value read in a loop
+ * stays in its register rather than one only read after the loop. Equal weights, and the
+ * rematerializable values which cost no memory access, fall back to the furthest end.
+ */
+class LinearScan final : public RegisterAllocator {
+  public:
+    // Copies done at an instruction constrained by the calling convention
+    struct FixedCopies {
+        parallel_copy_t before{};
+        parallel_copy_t after{};
+    };
+
+  private:
+    struct Reservation {
+        std::size_t reg;
+        std::size_t until;
+        Instr *owner;
+    };
+
+    CallingConvention m_convention;
+    std::array<RegisterSet, kRegClassesNum> m_caller_saved{};
+
+    // Calls with their lifetime points, in the linear order
+    std::vector<std::pair<CallInstr *, std::size_t>> m_calls;
+    std::vector<std::size_t> m_call_points;
+    // Arguments passed in registers with their registers
+    std::vector<std::pair<ArgInstr *, std::size_t>> m_args;
+    std::vector<ReturnInstr *> m_returns;
+
+    // Preferred register of a value within its class
+    std::unordered_map<Instr *, std::size_t> m_hints;
+    std::array<std::vector<Reservation>, kRegClassesNum> m_reservations{};
+
+    // Values in a caller-saved register live across calls, with their hulls and save slots
+    std::unordered_map<Instr *, interval_t> m_split;
+    std::unordered_map<Instr *, std::size_t> m_save_slots;
+
+    std::unordered_map<Instr *, FixedCopies> m_fixed_copies;
+
+    LinearScanOptions m_options;
+    std::unordered_map<Instr *, double> m_spill_weights;
+    // Indexed by Location::index of the rematerialized values
+    std::vector<Instr *> m_remat_values;
+
+  public:
+    // Instructions recomputed at a use at most, constants and stack arguments take one
+    static constexpr std::size_t kMaxRematCost = 3;
+    // Estimated number of iterations of every loop
+    static constexpr double kLoopWeight = 10.0;
+
+    /**
+     * @brief Allocate registers with a separate pool for each register class.
+     *
+     * Register indices are numbered within the class of the value, see reg_class.
+     * Spill slots are shared between classes.
+     */
+    explicit LinearScan(const regs_num_t &regs_num, const LifeTime &life_time,
+                        const CallingConvention &convention = {},
+                        const LinearScanOptions &options = {})
+        : m_convention{convention}, m_options{options} {
+        collect_constraints(regs_num, life_time);
+        if (m_options.spill_weights) {
+            compute_spill_weights(life_time);
+        }
+
+        auto intervals = prepare_intervals(life_time);
+        m_results.reserve(intervals.size());
+
+        std::array<std::vector<instr_interval_t>, kRegClassesNum> class_intervals{};
+        for (const auto &e : intervals) {
+            class_intervals[static_cast<std::size_t>(reg_class(e.first))].push_back(e);
+        }
+        for (std::size_t cls = 0; cls != kRegClassesNum; ++cls) {
+            allocate(static_cast<RegClass>(cls), regs_num[cls], class_intervals[cls]);
+        }
+
+        if (!m_call_points.empty()) {
+            for (const auto &[instr, interval] : intervals) {
+                auto location = m_results.at(instr);
+                if (location.kind == Location::Kind::Register &&
+                    m_caller_saved[static_cast<std::size_t>(reg_class(instr))].contains(
+                        location.index) &&
+                    crosses_call(interval)) {
+                    // recomputing after the call is cheaper than a save and a restore
+                    if (is_rematerializable(instr)) {
+                        remat(instr);
+                        continue;
+                    }
+                    m_split.emplace(instr, interval);
+                    m_save_slots.emplace(instr, 0);
+                }
+            }
+        }
+        assign_spill_slots(intervals, &m_save_slots);
+        build_fixed_copies();
+    }
+
+    explicit LinearScan(std::size_t regs_num, const LifeTime &life_time,
+                        const CallingConvention &convention = {},
+                        const LinearScanOptions &options = {})
+        : LinearScan(regs_num_t{regs_num, regs_num}, life_time, convention, options) {}
+
+    // A split value is in its save slot at the calls it crosses
+    [[nodiscard]] std::optional<Location> location_at(Instr *instr,
+                                                      std::size_t point) const override {
+        auto location = get_location(instr);
+        if (auto it = m_split.find(instr); it != m_split.end() && it->second.first < point &&
+                                           point < it->second.second &&
+                                           std::ranges::binary_search(m_call_points, point)) {
+            return Location{Location::Kind::Spill, m_save_slots.at(instr), location->reg_class};
+        }
+        return location;
+    }
+
+    /**
+     * @brief Copies which put the values into the registers fixed at instr and back.
+     *
+     * Before a call: its arguments into the argument registers and the split values into their
+     * save slots; after it: the result out of the return register and the split values back.
+     * After an argument: the value out of its argument register. Before a return: the returned
+     * value into the return register. Copies the hints already satisfy are left out.
+     */
+    [[nodiscard]] std::optional<FixedCopies> get_fixed_copies(Instr *instr) const {
+        auto it = m_fixed_copies.find(instr);
+        if (it == m_fixed_copies.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // Values split around calls
+    [[nodiscard]] bool is_split(Instr *instr) const { return m_split.contains(instr); }
+
+    [[nodiscard]] bool is_rematerialized(Instr *instr) const {
+        auto location = get_location(instr);
+        return location.has_value() && location->kind == Location::Kind::Remat;
+    }
+
+    // Value recomputed for a Remat location
+    [[nodiscard]] Instr *get_rematerialized(const Location &location) const {
+        assert(location.kind == Location::Kind::Remat && "location is not rematerialized");
+        return m_remat_values.at(location.index);
+    }
+
+    /**
+     * @brief Estimated number of executions of the definition and the uses of instr.
+     *
+     * Each of them counts kLoopWeight to the power of the loop depth of its block, an incoming
+     * value of a phi is used at the end of the incoming block. 0 without spill_weights.
+     */
+    [[nodiscard]] double get_spill_weight(Instr *instr) const {
+        auto it = m_spill_weights.find(instr);
+        return it != m_spill_weights.end() ? it->second : 0.0;
+    }
+
+    /**
+     * @brief Number of instructions recomputing instr takes, nullopt if it cannot be recomputed.
+     *
+     * A constant is rebuilt and an argument passed on the stack is reloaded from the frame of
+     * the caller, both in one instruction. A binary instruction is recomputed together with its
+     * operands, up to kMaxRematCost instructions. Anything else, including arguments passed in
+     * registers, depends on a state which is gone at the use.
+     */
+    [[nodiscard]] std::optional<std::size_t> remat_cost(Instr *instr) const {
+        return remat_cost(instr, kMaxRematCost);
+    }
+
+  private:
+    // remat_cost within budget instructions, the walk stops as soon as the budget runs out
+    [[nodiscard]] std::optional<std::size_t> remat_cost(Instr *instr, std::size_t budget) const {
+        if (budget == 0) {
+            return std::nullopt;
+        }
+        auto type = instr->type();
+        if (type == InstrType::kConst) {
+            return 1;
+        }
+        if (type == InstrType::kArg) {
+            auto in_register = std::ranges::contains(m_args, instr, [](const auto &arg) {
+                return static_cast<Instr *>(arg.first);
+            });
+            return in_register ? std::nullopt : std::optional<std::size_t>{1};
+        }
+        if (!InstrTraits::is_binary(type)) {
+            return std::nullopt;
+        }
+        auto *bin = static_cast<BinInstr *>(instr);
+        auto lhs = remat_cost(bin->get_lhs(), budget - 1);
+        if (!lhs.has_value()) {
+            return std::nullopt;
+        }
+        auto rhs = remat_cost(bin->get_rhs(), budget - 1 - *lhs);
+        if (!rhs.has_value()) {
+            return std::nullopt;
+        }
+        return *lhs + *rhs + 1;
+    }
+
+    struct ActiveInterval {
+        std::size_t end;
+        // Allocation order: of the intervals ending last the oldest one is spilled
+        std::size_t order;
+        std::size_t reg;
+        Instr *instr;
+        // Evicted for free: no store and no reload
+        bool remat = false;
+        double weight = 0.0;
+    };
+
+    // Min-heap on the end: expired intervals are popped from the top. There are at most regs_num
+    // active intervals, so the furthest one is found by a scan.
+    struct Active {
+        std::vector<ActiveInterval> heap{};
+
+        static bool ends_later(const ActiveInterval &lhs, const ActiveInterval &rhs) {
+            return lhs.end > rhs.end;
+        }
+
+        void push(const ActiveInterval &active) {
+            heap.push_back(active);
+            std::ranges::push_heap(heap, ends_later);
+        }
+
+        void pop() {
+            std::ranges::pop_heap(heap, ends_later);
+            heap.pop_back();
+        }
+
+        // Of the active intervals the cheapest to evict is rematerializable, then has the
+        // smallest weight, then ends last
+        static bool cheaper_to_keep(const ActiveInterval &lhs, const ActiveInterval &rhs) {
+            if (lhs.remat != rhs.remat) {
+                return !lhs.remat;
+            }
+            if (!lhs.remat && lhs.weight != rhs.weight) {
+                return lhs.weight > rhs.weight;
+            }
+            return lhs.end != rhs.end ? lhs.end < rhs.end : lhs.order > rhs.order;
+        }
+
+        // The interval being allocated keeps its place on ties
+        static bool evict_instead(const ActiveInterval &spill, const ActiveInterval &current) {
+            if (spill.remat != current.remat) {
+                return spill.remat;
+            }
+            if (!spill.remat && spill.weight != current.weight) {
+                return spill.weight < current.weight;
+            }
+            return spill.end > current.end;
+        }
+
+        auto furthest() { return std::ranges::max_element(heap, cheaper_to_keep); }
+
+        // Give the place of an evicted interval to another one
+        void replace(std::vector<ActiveInterval>::iterator it, const ActiveInterval &active) {
+            auto decreased = active.end <= it->end;
+            *it = active;
+            if (decreased) {
+                // sift it up within the heap prefix ending at it
+                std::push_heap(heap.begin(), std::next(it), ends_later);
+            } else {
+                std::ranges::make_heap(heap, ends_later);
+            }
+        }
+    };
+
+    static Location reg_location(RegClass cls, std::size_t reg) {
+        return {Location::Kind::Register, reg, cls};
+    }
+
+    const CallingConvention::ClassConvention &convention(const Instr *instr) const {
+        return m_convention.classes[static_cast<std::size_t>(reg_class(instr))];
+    }
+
+    void collect_constraints(const regs_num_t &regs_num, const LifeTime &life_time) {
+        auto constrained = false;
+        for (std::size_t cls = 0; cls != kRegClassesNum; ++cls) {
+            const auto &conv = m_convention.classes[cls];
+            m_caller_saved[cls] = RegisterSet{regs_num[cls]};
+            for (auto reg : conv.caller_saved) {
+                assert(reg < regs_num[cls] && "caller-saved register out of bounds");
+                m_caller_saved[cls].insert(reg);
+            }
+            assert(std::ranges::all_of(conv.arg_regs,
+                                       [&](auto reg) { return reg < regs_num[cls]; }) &&
+                   "argument register out of bounds");
+            constrained = constrained || !conv.arg_regs.empty() || conv.ret_reg.has_value() ||
+                          !conv.caller_saved.empty();
+        }
+        if (!constrained) {
+            return;
+        }
+
+        std::array<std::size_t, kRegClassesNum> args_num{};
+        for (auto *bb : life_time.linear_order()) {
+            auto point = life_time.get_bb_lifetime(bb);
+            for (const auto &instr : *bb) {
+                switch (instr->type()) {
+                case InstrType::kArg: {
+                    auto *arg = static_cast<ArgInstr *>(instr.get());
+                    auto cls = reg_class(arg);
+                    const auto &arg_regs = convention(arg).arg_regs;
+                    if (auto idx = args_num[static_cast<std::size_t>(cls)]++;
+                        idx < arg_regs.size()) {
+                        m_args.emplace_back(arg, arg_regs[idx]);
+                        if (!life_time.get_lifetime(arg).empty()) {
+                            m_hints.emplace(arg, arg_regs[idx]);
+                            m_reservations[static_cast<std::size_t>(cls)].push_back(
+                                {arg_regs[idx], point, arg});
+                        }
+                    }
+                    break;
+                }
+                case InstrType::kCall: {
+                    auto *call = static_cast<CallInstr *>(instr.get());
+                    m_calls.emplace_back(call, point);
+                    m_call_points.push_back(point);
+                    if (auto ret_reg = convention(call).ret_reg; ret_reg.has_value()) {
+                        m_hints.try_emplace(call, *ret_reg);
+                    }
+
+                    std::array<std::size_t, kRegClassesNum> call_args_num{};
+                    for (auto *value : call->get_args()) {
+                        const auto &arg_regs = convention(value).arg_regs;
+                        if (auto idx = call_args_num[static_cast<std::size_t>(reg_class(value))]++;
+                            idx < arg_regs.size()) {
+                            m_hints.try_emplace(value, arg_regs[idx]);
+                        }
+                    }
+                    break;
+                }
+                case InstrType::kReturn: {
+                    auto *ret = static_cast<ReturnInstr *>(instr.get());
+                    m_returns.push_back(ret);
+                    if (auto ret_reg = convention(ret->get_ret()).ret_reg; ret_reg.has_value()) {
+                        m_hints.try_emplace(ret->get_ret(), *ret_reg);
+                    }
+                    break;
+                }
+                default:
+                    break;
+                }
+                point += LifeTime::kLifetimeStep;
+            }
+        }
     }
 
-    void allocate(std::size_t regs_num, std::vector<instr_interval_t> intervals) {
-        std::vector<instr_interval_t> active{};
-        std::set<std::size_t> free_regs(std::from_range, std::views::iota(0uz, regs_num));
-        std::size_t spill_count = 0;
+    void compute_spill_weights(const LifeTime &life_time) {
+        // Entered in the linear order, the entries of nearby values are allocated close together,
+        // then each use takes a single lookup
+        m_spill_weights.reserve(life_time.size());
+        for (auto *bb : life_time.linear_order()) {
+            for (const auto &instr : *bb) {
+                if (!life_time.get_lifetime(instr.get()).empty()) {
+                    m_spill_weights.emplace(instr.get(), 0.0);
+                }
+            }
+        }
+
+        for (auto *bb : life_time.linear_order()) {
+            auto weight = std::pow(kLoopWeight, static_cast<double>(life_time.get_loop_depth(bb)));
+            auto add = [this, weight](Instr *value) {
+                if (auto it = m_spill_weights.find(value); it != m_spill_weights.end()) {
+                    it->second += weight;
+                }
+            };
 
+            for (const auto &instr : *bb) {
+                add(instr.get());
+                if (instr->type() != InstrType::kPhi) {
+                    std::ranges::for_each(LifeTime::input_operands(instr.get()), add);
+                }
+            }
+            for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+                if (succ == nullptr) {
+                    continue;
+                }
+                for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+                    for (const auto &[value, incoming] : phi->get_phi_nodes()) {
+                        if (incoming == bb) {
+                            add(value);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Some call lies strictly inside the interval: neither reads nor defines the value
+    bool crosses_call(const interval_t &interval) const {
+        auto it = std::ranges::upper_bound(m_call_points, interval.first);
+        return it != m_call_points.end() && *it < interval.second;
+    }
+
+    // reg is kept for an argument not yet defined at start
+    bool is_reserved(RegClass cls, Instr *instr, std::size_t start, std::size_t reg) const {
+        return std::ranges::any_of(m_reservations[static_cast<std::size_t>(cls)],
+                                   [instr, start, reg](const auto &reservation) {
+                                       return reservation.reg == reg &&
+                                              reservation.owner != instr &&
+                                              start < reservation.until;
+                                   });
+    }
+
+    std::optional<std::size_t> pick_register(RegClass cls, Instr *instr, const interval_t &interval,
+                                              const RegisterSet &free_regs) const {
+        const auto &caller_saved = m_caller_saved[static_cast<std::size_t>(cls)];
+        auto crossing = crosses_call(interval);
+        auto allowed = [this, cls, instr, &interval](std::size_t reg) {
+            return !is_reserved(cls, instr, interval.first, reg);
+        };
+
+        if (auto hint = m_hints.find(instr);
+            hint != m_hints.end() && free_regs.contains(hint->second) && allowed(hint->second) &&
+            !(crossing && caller_saved.contains(hint->second))) {
+            return hint->second;
+        }
+        // values live across calls take callee-saved registers, the others leave them free
+        if (auto reg = free_regs.find_first([&](auto reg) {
+                return allowed(reg) && caller_saved.contains(reg) != crossing;
+            });
+            reg.has_value()) {
+            return reg;
+        }
+        return free_regs.find_first(allowed);
+    }
+
+    void allocate(RegClass cls, std::size_t regs_num,
+                  const std::vector<instr_interval_t> &intervals) {
+        Active active{};
+        active.heap.reserve(regs_num);
+        auto free_regs = RegisterSet::all(regs_num);
+
+        std::size_t order = 0;
         for (const auto &[instr, interval] : intervals) {
             expire_old_intervals(active, free_regs, interval);
 
-            if (active.size() == regs_num) {
-                spill_at_interval(active, spill_count, instr, interval);
+            ActiveInterval current{interval.second, order++, 0, instr, is_rematerializable(instr),
+                                   get_spill_weight(instr)};
+            if (auto reg = pick_register(cls, instr, interval, free_regs); reg.has_value()) {
+                free_regs.erase(*reg);
+                m_results[instr] = Location{Location::Kind::Register, *reg};
+                current.reg = *reg;
+                active.push(current);
             } else {
-                auto reg = *free_regs.begin();
-                free_regs.erase(free_regs.begin());
-
-                m_results[instr] = Location{Location::Kind::Register, reg};
-                add_active_interval(active, instr, interval);
+                spill_at_interval(cls, active, interval.first, current);
             }
         }
     }
 
-    void expire_old_intervals(std::vector<instr_interval_t> &active,
-                              std::set<std::size_t> &free_regs, const interval_t &interval) {
-        std::erase_if(active, [&](const auto &j) {
-            if (j.second.second > interval.first)
-                return false;
-            free_regs.insert(m_results.at(j.first).index);
-            return true;
-        });
+    static void expire_old_intervals(Active &active, RegisterSet &free_regs,
+                                     const interval_t &interval) {
+        while (!active.heap.empty() && active.heap.front().end <= interval.first) {
+            free_regs.insert(active.heap.front().reg);
+            active.pop();
+        }
     }
 
-    void spill_at_interval(std::vector<instr_interval_t> &active, std::size_t &spill_count,
-                           Instr *instr, const interval_t &interval) {
-        auto &spill = active.back();
-        if (spill.second.second > interval.second) {
-            auto reg = m_results.at(spill.first).index;
-            m_results[spill.first] = Location{Location::Kind::Spill, spill_count++};
-            active.pop_back();
+    bool is_rematerializable(Instr *instr) const {
+        return m_options.rematerialize && remat_cost(instr).has_value();
+    }
 
-            m_results[instr] = Location{Location::Kind::Register, reg};
-            add_active_interval(active, instr, interval);
+    void remat(Instr *instr) {
+        m_results[instr] = Location{Location::Kind::Remat, m_remat_values.size()};
+        m_remat_values.push_back(instr);
+    }
+
+    // Slot indices are assigned later by assign_spill_slots
+    void evict(const ActiveInterval &interval) {
+        if (interval.remat) {
+            remat(interval.instr);
         } else {
-            m_results[instr] = Location{Location::Kind::Spill, spill_count++};
+            m_results[interval.instr] = Location{Location::Kind::Spill, 0};
+        }
+    }
+
+    void spill_at_interval(RegClass cls, Active &active, std::size_t start,
+                           ActiveInterval current) {
+        // active is empty only when the register class has no registers at all
+        auto spill = active.furthest();
+        if (spill != active.heap.end() &&
+            Active::evict_instead(*spill, current) &&
+            !is_reserved(cls, current.instr, start, spill->reg)) {
+            current.reg = spill->reg;
+            evict(*spill);
+            m_results[current.instr] = Location{Location::Kind::Register, current.reg};
+            active.replace(spill, current);
+        } else {
+            evict(current);
+        }
+    }
+
+    void build_fixed_copies() {
+        auto add = [this](Instr *instr, parallel_copy_t FixedCopies::*copies, Location from,
+                          Location to) {
+            if (from != to) {
+                (m_fixed_copies[instr].*copies).emplace_back(from, to);
+            }
+        };
+
+        for (auto [arg, reg] : m_args) {
+            if (auto location = get_location(arg); location.has_value()) {
+                add(arg, &FixedCopies::after, reg_location(reg_class(arg), reg), *location);
+            }
+        }
+
+        for (auto [call, point] : m_calls) {
+            std::array<std::size_t, kRegClassesNum> args_num{};
+            for (auto *value : call->get_args()) {
+                auto cls = reg_class(value);
+                const auto &arg_regs = convention(value).arg_regs;
+                if (auto idx = args_num[static_cast<std::size_t>(cls)]++; idx < arg_regs.size()) {
+                    auto location = get_location(value);
+                    assert(location.has_value() && "call argument has no location");
+                    add(call, &FixedCopies::before, *location, reg_location(cls, arg_regs[idx]));
+                }
+            }
+
+            auto ret_reg = convention(call).ret_reg;
+            if (auto location = get_location(call); location.has_value() && ret_reg.has_value()) {
+                add(call, &FixedCopies::after, reg_location(reg_class(call), *ret_reg), *location);
+            }
+        }
+
+        for (const auto &[value, interval] : m_split) {
+            auto reg = *get_location(value);
+            auto slot = Location{Location::Kind::Spill, m_save_slots.at(value), reg.reg_class};
+            auto first = std::ranges::upper_bound(m_calls, interval.first, {},
+                                                  &std::pair<CallInstr *, std::size_t>::second);
+            for (auto it = first; it != m_calls.end() && it->second < interval.second; ++it) {
+                add(it->first, &FixedCopies::before, reg, slot);
+                add(it->first, &FixedCopies::after, slot, reg);
+            }
+        }
+
+        for (auto *ret : m_returns) {
+            auto *value = ret->get_ret();
+            auto ret_reg = convention(value).ret_reg;
+            if (auto location = get_location(value); location.has_value() && ret_reg.has_value()) {
+                add(ret, &FixedCopies::before, *location,
+                    reg_location(reg_class(value), *ret_reg));
+            }
         }
     }
 };
@@ -0,0 +1,198 @@
+#ifndef RESOLUTION_HPP
+#define RESOLUTION_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "analysis/lifetime.hpp"
+#include "analysis/parallel_copy.hpp"
+#include "analysis/regalloc.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+/**
+ * @brief Moves which connect the allocation across the CFG edges.
+ *
+ * On every edge pred -> succ one parallel copy is built: each phi of succ gets the value
+ * incoming from pred, and each value live into succ whose location at the end of pred differs
+ * from its location at the start of succ (see RegisterAllocator::location_at) is moved there.
+ * The copy is then ordered by sequentialize, with the scratch location when one is given.
+ *
+ * The moves are computed without touching the CFG, place then decides where they go and splits
+ * the critical edges which need them.
+ */
+class Resolution final {
+  public:
+    enum class Position {
+        // before the terminator
+        kEnd,
+        // after the phis
+        kStart,
+    };
+
+    struct EdgeMoves {
+        BasicBlock *pred;
+        BasicBlock *succ;
+        std::vector<Move> moves;
+    };
+
+    struct BlockMoves {
+        BasicBlock *bb;
+        Position position;
+        std::vector<Move> moves;
+    };
+
+  private:
+    const LifeTime &m_life_time;
+    const RegisterAllocator &m_alloc;
+
+    std::vector<EdgeMoves> m_edge_moves;
+    std::size_t m_moves_num = 0;
+
+    // Values live at the start of each block, phis of the block excluded
+    std::unordered_map<BasicBlock *, std::vector<Instr *>> m_live_in;
+
+  public:
+    explicit Resolution(const LifeTime &life_time, const RegisterAllocator &alloc,
+                        std::optional<Location> scratch = std::nullopt)
+        : m_life_time{life_time}, m_alloc{alloc} {
+        build_live_in();
+
+        for (auto *pred : life_time.linear_order()) {
+            for (auto *succ : {pred->get_true_successor(), pred->get_false_successor()}) {
+                if (succ == nullptr) {
+                    continue;
+                }
+                if (auto moves = sequentialize(edge_copies(pred, succ), scratch); !moves.empty()) {
+                    m_moves_num += moves.size();
+                    m_edge_moves.push_back({pred, succ, std::move(moves)});
+                }
+            }
+        }
+    }
+
+    // Edges which need moves, in the linear order of their predecessors
+    [[nodiscard]] const std::vector<EdgeMoves> &get_edge_moves() const noexcept {
+        return m_edge_moves;
+    }
+    [[nodiscard]] std::size_t get_moves_num() const noexcept { return m_moves_num; }
+
+    /**
+     * @brief Decide the block of each edge's moves, splitting critical edges of func.
+     *
+     * The moves go to the end of pred when it has a single successor and to the start of succ
+     * when it has a single predecessor. Otherwise the edge is split by Builder::split_edge and
+     * the new block holds them; split blocks have no lifetime points, the allocation stays valid
+     * for the other blocks. Changes the CFG, so it is called once.
+     */
+    std::vector<BlockMoves> place(Function &func) const {
+        Builder builder{};
+        builder.set_insert_point(&func);
+
+        std::vector<BlockMoves> placed{};
+        placed.reserve(m_edge_moves.size());
+        for (const auto &[pred, succ, moves] : m_edge_moves) {
+            if (pred->get_false_successor() == nullptr) {
+                placed.push_back({pred, Position::kEnd, moves});
+            } else if (std::distance(succ->preds_begin(), succ->preds_end()) == 1) {
+                placed.push_back({succ, Position::kStart, moves});
+            } else {
+                placed.push_back({builder.split_edge(pred, succ), Position::kEnd, moves});
+            }
+        }
+        return placed;
+    }
+
+    // The parallel copy of the edge pred -> succ before it is sequentialized
+    [[nodiscard]] parallel_copy_t edge_copies(BasicBlock *pred, BasicBlock *succ) const {
+        assert(pred != nullptr && "basic block is nullptr");
+        assert(succ != nullptr && "basic block is nullptr");
+        assert(pred->size() != 0 && "pred has no terminator");
+
+        // the terminator of pred and the first instruction of succ
+        auto pred_end = m_life_time.get_bb_lifetime(pred) + LifeTime::kLifetimeStep * pred->size() -
+                        LifeTime::kLifetimeStep;
+        auto succ_start = m_life_time.get_bb_lifetime(succ);
+
+        parallel_copy_t copies{};
+        for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+            auto to = m_alloc.location_at(phi, succ_start);
+            // the phi is never used
+            if (!to.has_value()) {
+                continue;
+            }
+
+            for (const auto &[value, bb] : phi->get_phi_nodes()) {
+                if (bb != pred) {
+                    continue;
+                }
+                auto from = m_alloc.location_at(value, pred_end);
+                assert(from.has_value() && "incoming value of a live phi has no location");
+                copies.emplace_back(*from, *to);
+            }
+        }
+
+        if (auto it = m_live_in.find(succ); it != m_live_in.end()) {
+            for (auto *value : it->second) {
+                if (!LifeTime::is_live_at(m_life_time.get_lifetime(value), pred_end)) {
+                    continue;
+                }
+                auto from = m_alloc.location_at(value, pred_end);
+                auto to = m_alloc.location_at(value, succ_start);
+                if (from.has_value() && to.has_value() && *from != *to) {
+                    copies.emplace_back(*from, *to);
+                }
+            }
+        }
+        return copies;
+    }
+
+  private:
+    // Block starts are increasing in the linear order, so the blocks a range covers the start of
+    // are found by a binary search
+    void build_live_in() {
+        std::vector<std::pair<std::size_t, BasicBlock *>> starts{};
+        for (auto *bb : m_life_time.linear_order()) {
+            starts.emplace_back(m_life_time.get_bb_lifetime(bb), bb);
+        }
+
+        for (const auto &[value, ranges] : m_life_time) {
+            for (const auto &[first, second] : ranges) {
+                auto it = std::ranges::lower_bound(starts, first, {},
+                                                   &std::pair<std::size_t, BasicBlock *>::first);
+                for (; it != starts.end() && it->first < second; ++it) {
+                    m_live_in[it->second].push_back(value);
+                }
+            }
+        }
+
+        // A value defined in the block is live at its start only as its first instruction, and
+        // a loop range may overlap the ranges of the blocks inside the loop
+        for (auto &[bb, values] : m_live_in) {
+            std::unordered_set<Instr *> defined{};
+            for (const auto &instr : *bb) {
+                defined.insert(instr.get());
+            }
+            std::erase_if(values, [&defined](auto *value) { return defined.contains(value); });
+
+            std::ranges::sort(values);
+            auto [first, last] = std::ranges::unique(values);
+            values.erase(first, last);
+        }
+    }
+};
+
+} // namespace injir::analysis
+
+#endif // RESOLUTION_HPP
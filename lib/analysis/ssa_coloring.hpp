@@ -0,0 +1,200 @@
+#ifndef SSA_COLORING_HPP
+#define SSA_COLORING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis/lifetime.hpp"
+#include "analysis/regalloc.hpp"
+#include "graph/dom.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::analysis {
+
+/**
+ * @brief SSA-based allocator: greedy coloring along the dominator tree.
+ *
+ * The interference graph of a strict SSA program is chordal, and visiting definitions in
+ * dominance order is a perfect elimination order for it: when the register pressure never
+ * exceeds the number of registers, a greedy walk colors it without spills. No graph and no
+ * sorted intervals are built. Blocks are walked down the dominator tree, the live-in values of a
+ * block are the live-out values of its immediate dominator, and a register is freed at the last
+ * use of its value, as told by the precise LifeTime ranges. Where the pressure is too high the
+ * value with the furthest end is spilled.
+ *
+ * Phi operands are not coalesced: a phi gets its own location and is lowered afterwards into
+ * a parallel copy on each incoming edge, see lower_phis.
+ *
+ * A value live before its definition (non-strict SSA, e.g. a phi operand defined in a block
+ * which does not dominate the incoming edge) is invisible to the walk. Such values are colored
+ * after it against every value they overlap.
+ */
+class SSAColoring final : public RegisterAllocator {
+  private:
+    // Value held by a register, value is nullptr for a free register
+    struct Held {
+        Instr *value = nullptr;
+        const LifeTime::life_ranges_t *ranges = nullptr;
+        std::size_t end = 0;
+        // Points into m_results, whose nodes are stable
+        Location *location = nullptr;
+    };
+    using assignment_t = std::array<std::vector<Held>, kRegClassesNum>;
+
+    const LifeTime &m_life_time;
+    graph::dom_tree_t m_dom_tree;
+    // Live before their definition or defined out of the linear order
+    std::vector<Instr *> m_deferred;
+
+  public:
+    explicit SSAColoring(const regs_num_t &regs_num, const LifeTime &life_time)
+        : m_life_time{life_time} {
+        auto order = life_time.linear_order();
+        if (order.empty()) {
+            return;
+        }
+
+        auto *entry = *order.begin();
+        m_dom_tree = graph::idom_tree(entry);
+
+        assignment_t regs{};
+        for (std::size_t cls = 0; cls != kRegClassesNum; ++cls) {
+            regs[cls].assign(regs_num[cls], Held{});
+        }
+        m_results.reserve(life_time.size());
+        color(entry, regs);
+
+        for (const auto &[instr, _] : life_time) {
+            if (!m_results.contains(instr)) {
+                m_deferred.push_back(instr);
+            }
+        }
+        color_deferred(regs_num);
+
+        std::vector<instr_interval_t> spilled{};
+        for (const auto &[instr, location] : m_results) {
+            if (location.kind == Location::Kind::Spill) {
+                spilled.emplace_back(instr, hull(life_time.get_lifetime(instr)));
+            }
+        }
+        sort_intervals(spilled);
+        assign_spill_slots(spilled);
+    }
+
+    explicit SSAColoring(std::size_t regs_num, const LifeTime &life_time)
+        : SSAColoring(regs_num_t{regs_num, regs_num}, life_time) {}
+
+  private:
+    void color_deferred(const regs_num_t &regs_num) {
+        std::ranges::sort(m_deferred, {}, [this](auto *instr) {
+            return hull(m_life_time.get_lifetime(instr));
+        });
+
+        // Deferred values are rare, so each is simply checked against every colored value
+        for (auto *value : m_deferred) {
+            const auto &ranges = m_life_time.get_lifetime(value);
+            auto cls = reg_class(value);
+            std::vector<bool> ok_regs(regs_num[static_cast<std::size_t>(cls)], true);
+
+            for (const auto &[other, location] : m_results) {
+                if (location.kind == Location::Kind::Register && reg_class(other) == cls &&
+                    LifeTime::overlap(ranges, m_life_time.get_lifetime(other))) {
+                    ok_regs[location.index] = false;
+                }
+            }
+
+            auto reg = std::ranges::find(ok_regs, true);
+            m_results[value] = reg != ok_regs.end()
+                                   ? Location{Location::Kind::Register,
+                                              static_cast<std::size_t>(reg - ok_regs.begin())}
+                                   : Location{Location::Kind::Spill, 0};
+        }
+    }
+
+    void color(BasicBlock *bb, assignment_t regs) {
+        const auto bb_lifetime = m_life_time.get_bb_lifetime(bb);
+        auto point = bb_lifetime;
+
+        // Drop the values of the immediate dominator which are dead here or were spilled since
+        for (auto &class_regs : regs) {
+            for (auto &held : class_regs) {
+                if (held.value != nullptr && (held.location->kind != Location::Kind::Register ||
+                                              !LifeTime::is_live_at(*held.ranges, point))) {
+                    held = Held{};
+                }
+            }
+        }
+
+        for (const auto &instr : *bb) {
+            // phi operands are read on the incoming edges, phis are defined at the block start
+            auto is_phi = instr->type() == InstrType::kPhi;
+            if (!is_phi) {
+                for (auto *operand : instr->operands()) {
+                    release(regs, operand, point);
+                }
+            }
+
+            if (const auto &ranges = m_life_time.get_lifetime(instr.get()); !ranges.empty()) {
+                auto [start, end] = hull(ranges);
+                // a value live before its definition is colored after the walk
+                if (start >= (is_phi ? bb_lifetime : point)) {
+                    define(regs, {instr.get(), &ranges, end});
+                }
+            }
+            point += LifeTime::kLifetimeStep;
+        }
+
+        for (auto *child : m_dom_tree.at(bb)) {
+            color(child, regs);
+        }
+    }
+
+    void release(assignment_t &regs, Instr *operand, std::size_t point) {
+        auto it = m_results.find(operand);
+        if (it == m_results.end() || it->second.kind != Location::Kind::Register) {
+            return;
+        }
+
+        auto &held = regs[static_cast<std::size_t>(it->second.reg_class)][it->second.index];
+        if (held.value == operand && !LifeTime::is_live_at(*held.ranges, point)) {
+            held = Held{};
+        }
+    }
+
+    // Slot indices are assigned later by assign_spill_slots
+    void define(assignment_t &regs, Held def) {
+        auto cls = reg_class(def.value);
+        auto &class_regs = regs[static_cast<std::size_t>(cls)];
+        def.location = &(m_results[def.value] = Location{Location::Kind::Spill, 0, cls});
+
+        std::size_t victim = class_regs.size();
+        for (std::size_t reg = 0; reg != class_regs.size(); ++reg) {
+            if (class_regs[reg].value == nullptr) {
+                def.location->kind = Location::Kind::Register;
+                def.location->index = reg;
+                class_regs[reg] = def;
+                return;
+            }
+            if (victim == class_regs.size() || class_regs[reg].end > class_regs[victim].end) {
+                victim = reg;
+            }
+        }
+
+        // class_regs is empty only when the register class has no registers at all
+        if (victim != class_regs.size() && class_regs[victim].end > def.end) {
+            def.location->kind = Location::Kind::Register;
+            def.location->index = victim;
+            class_regs[victim].location->kind = Location::Kind::Spill;
+            class_regs[victim].location->index = 0;
+            class_regs[victim] = def;
+        }
+    }
+};
+
+} // namespace injir::analysis
+
+#endif // SSA_COLORING_HPP
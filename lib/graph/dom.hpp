@@ -1,10 +1,15 @@
 #ifndef DOM_HPP
 #define DOM_HPP
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
 #include <unordered_map>
 #include <vector>
 
 #include "graph/dfs.hpp"
+#include "graph/rpo.hpp"
 #include "ir/basic_block.hpp"
 #include "ir/common.hpp"
 
@@ -35,6 +40,261 @@ inline dom_tree_t dom(BasicBlock *root_basic_block) {
 
     return dom_tree;
 }
+
+// Immediate dominator of every reachable block, the root is mapped to nullptr
+using idom_t = std::unordered_map<BasicBlock *, BasicBlock *>;
+
+/**
+ * @brief Immediate dominators by the iterative algorithm of Cooper, Harvey and Kennedy.
+ *
+ * Blocks are visited in RPO and the dominators of the predecessors are intersected by walking
+ * up the partially built tree, which converges in a couple of passes on reducible graphs.
+ */
+inline idom_t idom(BasicBlock *root_basic_block) {
+    assert(root_basic_block != nullptr && "basic block is nullptr");
+
+    auto rpo_vector = rpo(root_basic_block, dfs(root_basic_block).size());
+
+    std::unordered_map<BasicBlock *, std::size_t> rpo_number{};
+    for (std::size_t i = 0; i != rpo_vector.size(); ++i) {
+        rpo_number[rpo_vector[i]] = i;
+    }
+
+    constexpr auto kUndefined = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> doms(rpo_vector.size(), kUndefined);
+    doms[0] = 0;
+
+    auto intersect = [&doms](std::size_t lhs, std::size_t rhs) {
+        while (lhs != rhs) {
+            while (lhs > rhs) {
+                lhs = doms[lhs];
+            }
+            while (rhs > lhs) {
+                rhs = doms[rhs];
+            }
+        }
+        return lhs;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 1; i != rpo_vector.size(); ++i) {
+            auto *bb = rpo_vector[i];
+            auto new_idom = kUndefined;
+
+            for (auto pred = bb->preds_begin(), end = bb->preds_end(); pred != end; ++pred) {
+                auto it = rpo_number.find(*pred);
+                // unreachable or removed predecessor
+                if (it == rpo_number.end() || doms[it->second] == kUndefined) {
+                    continue;
+                }
+                new_idom = new_idom == kUndefined ? it->second : intersect(it->second, new_idom);
+            }
+
+            if (doms[i] != new_idom) {
+                doms[i] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    idom_t idoms{};
+    idoms[root_basic_block] = nullptr;
+    for (std::size_t i = 1; i != rpo_vector.size(); ++i) {
+        idoms[rpo_vector[i]] = rpo_vector[doms[i]];
+    }
+    return idoms;
+}
+
+/**
+ * @brief Dominator tree: immediately dominated children of every reachable block.
+ *
+ * Unlike dom, only direct children are listed; they are kept in RPO.
+ */
+inline dom_tree_t idom_tree(BasicBlock *root_basic_block) {
+    assert(root_basic_block != nullptr && "basic block is nullptr");
+
+    auto idoms = idom(root_basic_block);
+    auto rpo_vector = rpo(root_basic_block, idoms.size());
+
+    dom_tree_t dom_tree{};
+    for (auto *bb : rpo_vector) {
+        dom_tree[bb] = {};
+        if (auto *parent = idoms.at(bb); parent != nullptr) {
+            dom_tree[parent].push_back(bb);
+        }
+    }
+    return dom_tree;
+}
+
+// Whether dominator dominates bb, walking up the immediate dominators of bb
+inline bool dominates(const idom_t &idoms, const BasicBlock *dominator, BasicBlock *bb) {
+    for (auto *runner = bb; runner != nullptr; runner = idoms.at(runner)) {
+        if (runner == dominator) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Blocks where the dominance of every reachable block ends
+using dom_frontier_t = std::unordered_map<BasicBlock *, std::vector<BasicBlock *>>;
+
+/**
+ * @brief Dominance frontiers by the algorithm of Cooper, Harvey and Kennedy.
+ *
+ * A join block is in the frontier of every block on the dominator tree path from each of its
+ * predecessors up to, but not including, its immediate dominator.
+ */
+inline dom_frontier_t dom_frontier(const idom_t &idoms) {
+    dom_frontier_t frontiers{};
+    for (auto &[bb, _] : idoms) {
+        frontiers[bb] = {};
+    }
+    for (auto &[bb, bb_idom] : idoms) {
+        if (std::distance(bb->preds_begin(), bb->preds_end()) < 2) {
+            continue;
+        }
+        for (auto pred = bb->preds_begin(), end = bb->preds_end(); pred != end; ++pred) {
+            // unreachable predecessors are not in idoms
+            if (!idoms.contains(*pred)) {
+                continue;
+            }
+            for (auto *runner = *pred; runner != bb_idom; runner = idoms.at(runner)) {
+                auto &frontier = frontiers[runner];
+                if (std::ranges::find(frontier, bb) != frontier.end()) {
+                    break;
+                }
+                frontier.push_back(bb);
+            }
+        }
+    }
+    return frontiers;
+}
+
+inline dom_frontier_t dom_frontier(BasicBlock *root_basic_block) {
+    assert(root_basic_block != nullptr && "basic block is nullptr");
+    return dom_frontier(idom(root_basic_block));
+}
+
+// Iterated dominance frontier of blocks: where the values defined in blocks meet, e.g. need phis
+inline std::vector<BasicBlock *> iterated_dom_frontier(const dom_frontier_t &frontiers,
+                                                       const std::vector<BasicBlock *> &blocks) {
+    std::vector<BasicBlock *> result{};
+    std::vector<BasicBlock *> worklist = blocks;
+    while (!worklist.empty()) {
+        auto *bb = worklist.back();
+        worklist.pop_back();
+
+        auto it = frontiers.find(bb);
+        if (it == frontiers.end()) {
+            continue;
+        }
+        for (auto *frontier_bb : it->second) {
+            if (std::ranges::find(result, frontier_bb) == result.end()) {
+                result.push_back(frontier_bb);
+                worklist.push_back(frontier_bb);
+            }
+        }
+    }
+    return result;
+}
+
+// Postorder over the predecessors, only blocks present in visited are walked
+inline void reverse_postorder_algorithm(BasicBlock *basic_block,
+                                        std::unordered_map<BasicBlock *, bool> &visited,
+                                        std::vector<BasicBlock *> &postorder) {
+    visited[basic_block] = true;
+    for (auto pred = basic_block->preds_begin(), end = basic_block->preds_end(); pred != end;
+         ++pred) {
+        if (auto it = visited.find(*pred); it != visited.end() && !it->second) {
+            reverse_postorder_algorithm(*pred, visited, postorder);
+        }
+    }
+    postorder.push_back(basic_block);
+}
+
+/**
+ * @brief Immediate post-dominators of the blocks reachable from root_basic_block.
+ *
+ * The same algorithm as idom on the reversed graph, rooted at a virtual exit which follows every
+ * block without successors. Blocks post-dominated by the virtual exit only are mapped to
+ * nullptr, blocks which never reach an exit, e.g. inside an infinite loop, are left out.
+ */
+inline idom_t ipdom(BasicBlock *root_basic_block) {
+    assert(root_basic_block != nullptr && "basic block is nullptr");
+
+    auto reachable_vector = dfs(root_basic_block);
+    std::unordered_map<BasicBlock *, bool> visited{};
+    for (auto *bb : reachable_vector) {
+        visited[bb] = false;
+    }
+
+    // postorder of the reversed graph walked from the exits
+    std::vector<BasicBlock *> postorder{};
+
+    std::vector<BasicBlock *> exits{};
+    for (auto *bb : reachable_vector) {
+        if (bb->get_true_successor() == nullptr && bb->get_false_successor() == nullptr) {
+            exits.push_back(bb);
+            if (!visited[bb]) {
+                reverse_postorder_algorithm(bb, visited, postorder);
+            }
+        }
+    }
+
+    // number 0 is the virtual exit
+    std::vector<BasicBlock *> order{nullptr};
+    order.insert(order.end(), postorder.rbegin(), postorder.rend());
+    std::unordered_map<BasicBlock *, std::size_t> number{};
+    for (std::size_t i = 1; i != order.size(); ++i) {
+        number[order[i]] = i;
+    }
+
+    constexpr auto kUndefined = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> doms(order.size(), kUndefined);
+    doms[0] = 0;
+
+    auto intersect = [&doms](std::size_t lhs, std::size_t rhs) {
+        while (lhs != rhs) {
+            while (lhs > rhs) {
+                lhs = doms[lhs];
+            }
+            while (rhs > lhs) {
+                rhs = doms[rhs];
+            }
+        }
+        return lhs;
+    };
+
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (std::size_t i = 1; i != order.size(); ++i) {
+            auto *bb = order[i];
+            auto new_ipdom = std::ranges::contains(exits, bb) ? std::size_t{0} : kUndefined;
+
+            for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+                auto it = succ != nullptr ? number.find(succ) : number.end();
+                if (it == number.end() || doms[it->second] == kUndefined) {
+                    continue;
+                }
+                new_ipdom =
+                    new_ipdom == kUndefined ? it->second : intersect(it->second, new_ipdom);
+            }
+
+            if (doms[i] != new_ipdom) {
+                doms[i] = new_ipdom;
+                changed = true;
+            }
+        }
+    }
+
+    idom_t ipdoms{};
+    for (std::size_t i = 1; i != order.size(); ++i) {
+        ipdoms[order[i]] = order[doms[i]];
+    }
+    return ipdoms;
+}
 } // namespace injir::graph
 
 #endif // DOM_HPP
\ No newline at end of file
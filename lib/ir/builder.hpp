@@ -1,6 +1,7 @@
 #ifndef BUILDER_HPP
 #define BUILDER_HPP
 
+#include <algorithm>
 #include <cassert>
 
 #include "basic_block.hpp"
@@ -49,6 +50,41 @@ class Builder final {
         return &(*bb_it);
     }
 
+    /**
+     * @brief Insert an empty block on the edge pred -> succ.
+     *
+     * The new block jumps to succ and takes the place of pred among the successors of pred, the
+     * predecessors of succ and the incoming blocks of the phis of succ. The insert point is kept.
+     */
+    BasicBlock *split_edge(BasicBlock *pred, BasicBlock *succ) {
+        assert(m_current_func && "current function is nullptr");
+        assert(pred && "pred block is nullptr");
+        assert(succ && "succ block is nullptr");
+
+        auto succ_pos = pred->get_true_successor() == succ ? 0 : 1;
+        assert((succ_pos == 0 || pred->get_false_successor() == succ) && "no edge pred -> succ");
+
+        auto pred_it = std::find(succ->preds_begin(), succ->preds_end(), pred);
+        assert(pred_it != succ->preds_end() && "pred is not a predecessor of succ");
+
+        auto *bb = create_bb();
+        bb->emplace_back(std::make_unique<JumpInstr>());
+        bb->set_succ_bb(succ);
+        bb->emplace_back_pred_bb(pred);
+
+        pred->set_succ_bb(bb, succ_pos);
+        succ->set_pred_bb(bb, static_cast<std::size_t>(pred_it - succ->preds_begin()));
+
+        for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+            for (auto &[_, incoming_bb] : phi->get_phi_nodes()) {
+                if (incoming_bb == pred) {
+                    incoming_bb = bb;
+                }
+            }
+        }
+        return bb;
+    }
+
     BinInstr *create_bin_instr(InstrType type, Instr *lhs, Instr *rhs) {
         assert(m_current_bb && "current basic block is nullptr");
         assert(lhs && "lhs instr is nullptr");
@@ -135,21 +171,30 @@ class Builder final {
         assert(m_current_bb && "current basic block is nullptr");
         assert(callee && "callee function is nullptr");
 
-        return static_cast<CallInstr *>(
+        auto *instr =
             m_current_bb->emplace_back(std::make_unique<CallInstr>(callee, std::move(args)))
-                ->get());
+                ->get();
+        for (auto *arg : instr->operands()) {
+            arg->add_user(instr);
+        }
+        return static_cast<CallInstr *>(instr);
     }
 
     AllocaInstr *create_alloca(Type element_type, Instr *size = nullptr) {
-        return static_cast<AllocaInstr *>(
-            m_current_bb->emplace_back(std::make_unique<AllocaInstr>(element_type, size))->get());
+        auto *instr =
+            m_current_bb->emplace_back(std::make_unique<AllocaInstr>(element_type, size))->get();
+        if (size != nullptr) {
+            size->add_user(instr);
+        }
+        return static_cast<AllocaInstr *>(instr);
     }
 
     LoadInstr *create_load(Instr *ptr) {
         assert(ptr && "ptr is nullptr");
 
-        return static_cast<LoadInstr *>(
-            m_current_bb->emplace_back(std::make_unique<LoadInstr>(ptr))->get());
+        auto *instr = m_current_bb->emplace_back(std::make_unique<LoadInstr>(ptr))->get();
+        ptr->add_user(instr);
+        return static_cast<LoadInstr *>(instr);
     }
 
     StoreInstr *create_store(Instr *ptr, Instr *value) {
@@ -175,17 +220,20 @@ class Builder final {
     NullCheck *create_null_check(Instr *check) {
         assert(check && "check instr is nullptr");
 
-        return static_cast<NullCheck *>(
-            m_current_bb->emplace_back(std::make_unique<NullCheck>(check))->get());
+        auto *instr = m_current_bb->emplace_back(std::make_unique<NullCheck>(check))->get();
+        check->add_user(instr);
+        return static_cast<NullCheck *>(instr);
     }
 
     BoundCheck *create_bound_check(Instr *check, i64 lower_bound, i64 upper_bound) {
         assert(check && "check instr is nullptr");
 
-        return static_cast<BoundCheck *>(
+        auto *instr =
             m_current_bb
                 ->emplace_back(std::make_unique<BoundCheck>(check, lower_bound, upper_bound))
-                ->get());
+                ->get();
+        check->add_user(instr);
+        return static_cast<BoundCheck *>(instr);
     }
 
     ConstInstr<i64> *create_int(i64 data) {
@@ -0,0 +1,137 @@
+#ifndef CLONE_HPP
+#define CLONE_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "basic_block.hpp"
+#include "function.hpp"
+#include "instr.hpp"
+
+namespace injir {
+
+using value_map_t = std::unordered_map<const Instr *, Instr *>;
+using block_map_t = std::unordered_map<const BasicBlock *, BasicBlock *>;
+
+// Copy of instr with the same operands and no users
+inline std::unique_ptr<Instr> clone_instr(const Instr &instr) {
+    std::unique_ptr<Instr> clone{};
+    switch (instr.type()) {
+    case InstrType::kConst:
+        if (instr.value_type() == Type::kFloat) {
+            clone = std::make_unique<ConstInstr<double>>(
+                static_cast<const ConstInstr<double> &>(instr));
+        } else {
+            clone = std::make_unique<ConstInstr<i64>>(static_cast<const ConstInstr<i64> &>(instr));
+        }
+        break;
+    case InstrType::kArg:
+        clone = std::make_unique<ArgInstr>(static_cast<const ArgInstr &>(instr));
+        break;
+    case InstrType::kAdd:
+    case InstrType::kMul:
+    case InstrType::kDiv:
+    case InstrType::kOr:
+    case InstrType::kShl:
+    case InstrType::kCmpLess:
+    case InstrType::kCmpLessEqual:
+        clone = std::make_unique<BinInstr>(static_cast<const BinInstr &>(instr));
+        break;
+    case InstrType::kBranch:
+        clone = std::make_unique<BranchInstr>(static_cast<const BranchInstr &>(instr));
+        break;
+    case InstrType::kReturn:
+        clone = std::make_unique<ReturnInstr>(static_cast<const ReturnInstr &>(instr));
+        break;
+    case InstrType::kPhi:
+        clone = std::make_unique<PhiInstr>(static_cast<const PhiInstr &>(instr));
+        break;
+    case InstrType::kJump:
+        clone = std::make_unique<JumpInstr>(static_cast<const JumpInstr &>(instr));
+        break;
+    case InstrType::kCall:
+        clone = std::make_unique<CallInstr>(static_cast<const CallInstr &>(instr));
+        break;
+    case InstrType::kAlloca:
+        clone = std::make_unique<AllocaInstr>(static_cast<const AllocaInstr &>(instr));
+        break;
+    case InstrType::kLoad:
+        clone = std::make_unique<LoadInstr>(static_cast<const LoadInstr &>(instr));
+        break;
+    case InstrType::kStore:
+        clone = std::make_unique<StoreInstr>(static_cast<const StoreInstr &>(instr));
+        break;
+    case InstrType::kGep:
+        clone = std::make_unique<GepInstr>(static_cast<const GepInstr &>(instr));
+        break;
+    case InstrType::kNullCheck:
+        clone = std::make_unique<NullCheck>(static_cast<const NullCheck &>(instr));
+        break;
+    case InstrType::kBoundCheck:
+        clone = std::make_unique<BoundCheck>(static_cast<const BoundCheck &>(instr));
+        break;
+    default:
+        throw std::runtime_error{"Unknown instruction class"};
+    }
+    clone->clear_users();
+    return clone;
+}
+
+/**
+ * @brief Deep copy of func.
+ *
+ * Operands, phi incoming blocks, predecessors and successors of the copy refer to the copy, and
+ * its user lists are rebuilt. values and blocks map the originals to their copies. Calls keep
+ * their callees.
+ */
+inline Function clone_function(const Function &func, value_map_t &values, block_map_t &blocks) {
+    Function clone{func.get_ret_type(), func.get_arg_types()};
+
+    for (const auto &bb : func) {
+        auto *bb_clone = &*clone.emplace_back(BasicBlock{});
+        blocks.emplace(&bb, bb_clone);
+        for (const auto &instr : bb) {
+            auto instr_clone = bb_clone->emplace_back(clone_instr(*instr));
+            values.emplace(instr.get(), instr_clone->get());
+        }
+    }
+
+    auto map_block = [&blocks](const BasicBlock *bb) {
+        return bb != nullptr ? blocks.at(bb) : nullptr;
+    };
+    for (const auto &bb : func) {
+        auto *bb_clone = blocks.at(&bb);
+        bb_clone->set_succ_bb(map_block(bb.get_true_successor()), 0);
+        bb_clone->set_succ_bb(map_block(bb.get_false_successor()), 1);
+        for (auto pred = bb.preds_begin(), pred_end = bb.preds_end(); pred != pred_end; ++pred) {
+            bb_clone->emplace_back_pred_bb(map_block(*pred));
+        }
+
+        for (const auto &instr_clone : *bb_clone) {
+            for (auto *operand : instr_clone->operands()) {
+                instr_clone->replace_operand(operand, values.at(operand));
+            }
+            if (PhiInstr::classof(instr_clone.get())) {
+                for (auto &[_, incoming_bb] :
+                     static_cast<PhiInstr *>(instr_clone.get())->get_phi_nodes()) {
+                    incoming_bb = map_block(incoming_bb);
+                }
+            }
+            for (auto *operand : instr_clone->operands()) {
+                operand->add_user(instr_clone.get());
+            }
+        }
+    }
+    return clone;
+}
+
+inline Function clone_function(const Function &func) {
+    value_map_t values{};
+    block_map_t blocks{};
+    return clone_function(func, values, blocks);
+}
+
+} // namespace injir
+
+#endif // CLONE_HPP
@@ -2,6 +2,7 @@
 #define FUNCTION_HPP
 
 #include <list>
+#include <utility>
 #include <vector>
 
 #include "basic_block.hpp"
@@ -20,6 +21,10 @@ class Function final {
   public:
     Function(Type ret_type, std::initializer_list<Type> args)
         : m_ret_type(ret_type), m_arg_types(args) {}
+    Function(Type ret_type, std::vector<Type> args)
+        : m_ret_type(ret_type), m_arg_types(std::move(args)) {}
+
+    [[nodiscard]] Type get_ret_type() const noexcept { return m_ret_type; }
 
     Type get_arg_type(size_t index) {
         if (index > m_arg_types.size()) {
@@ -28,6 +33,8 @@ class Function final {
         return m_arg_types[index];
     }
 
+    [[nodiscard]] const std::vector<Type> &get_arg_types() const noexcept { return m_arg_types; }
+
     [[nodiscard]] std::size_t size() const noexcept { return m_bbs.size(); }
 
     using iterator = BasicBlocks::iterator;
@@ -54,6 +61,9 @@ class Function final {
         return std::prev(end());
     }
 };
+
+inline Type CallInstr::value_type() const { return m_callee->get_ret_type(); }
+
 } // namespace injir
 
 #endif // FUNCTION_HPP
\ No newline at end of file
@@ -3,7 +3,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <ranges>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -50,6 +52,30 @@ inline bool is_binary(InstrType instr_type) {
         return false;
     }
 }
+
+/**
+ * @brief The instruction does something besides producing its value.
+ *
+ * Control flow, stores, calls of unknown callees, checks and division, which traps on zero, are
+ * kept even when their value is never used. Arguments belong to the function signature.
+ */
+inline bool has_side_effects(InstrType instr_type) {
+    switch (instr_type) {
+    case InstrType::kArg:
+    case InstrType::kDiv:
+    case InstrType::kBranch:
+    case InstrType::kReturn:
+    case InstrType::kJump:
+    case InstrType::kCall:
+    case InstrType::kStore:
+    case InstrType::kNullCheck:
+    case InstrType::kBoundCheck:
+    case InstrType::kUnknown:
+        return true;
+    default:
+        return false;
+    }
+}
 } // namespace InstrTraits
 
 class Instr {
@@ -69,6 +95,21 @@ class Instr {
 
     virtual void replace_operand(Instr *from, Instr *to) = 0;
 
+    /**
+     * @brief Type of the value produced by the instruction.
+     *
+     * Instructions which produce no value (jumps, branches, stores, checks...) are kVoid,
+     * pointers produced by alloca/gep are treated as integers.
+     */
+    [[nodiscard]] virtual Type value_type() const { return Type::kVoid; }
+
+    /**
+     * @brief Values read by the instruction, in operand order.
+     *
+     * Phi returns its incoming values: they are read on the incoming edges, not at the phi.
+     */
+    [[nodiscard]] virtual std::vector<Instr *> operands() const { return {}; }
+
     void add_user(Instr *user) { m_users.push_back(user); }
     void clear_users() noexcept { m_users.clear(); }
 
@@ -93,6 +134,10 @@ template <typename T> class ConstInstr final : public Instr {
 
     static bool classof(const Instr *instr) noexcept { return instr->type() == InstrType::kConst; }
 
+    [[nodiscard]] Type value_type() const override {
+        return std::is_floating_point_v<T> ? Type::kFloat : Type::kInt;
+    }
+
     [[nodiscard]] T get_value() const noexcept { return m_value; }
 };
 
@@ -106,12 +151,16 @@ class ArgInstr final : public Instr {
     static bool classof(const Instr *instr) noexcept { return instr->type() == InstrType::kArg; }
 
     void replace_operand(Instr * /*from*/, Instr * /*to*/) override {}
+
+    [[nodiscard]] Type value_type() const override { return m_type; }
 };
 
 class BinInstr final : public Instr {
   private:
     Instr *m_lhs;
     Instr *m_rhs;
+    // Cached: resolving walks the whole chain of lhs operands
+    mutable Type m_value_type = Type::kUnknown;
 
   public:
     explicit BinInstr(InstrType type, Instr *lhs, Instr *rhs)
@@ -128,10 +177,30 @@ class BinInstr final : public Instr {
         if (m_rhs == from) {
             m_rhs = to;
         }
+        m_value_type = Type::kUnknown;
     }
 
-    void set_lhs(Instr *lhs) noexcept { m_lhs = lhs; }
-    void set_rhs(Instr *rhs) noexcept { m_rhs = rhs; }
+    [[nodiscard]] Type value_type() const override {
+        if (type() == InstrType::kCmpLess || type() == InstrType::kCmpLessEqual) {
+            return Type::kInt;
+        }
+        if (m_value_type == Type::kUnknown) {
+            auto lhs_type = m_lhs->value_type();
+            m_value_type = lhs_type != Type::kUnknown ? lhs_type : m_rhs->value_type();
+        }
+        return m_value_type;
+    }
+
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_lhs, m_rhs}; }
+
+    void set_lhs(Instr *lhs) noexcept {
+        m_lhs = lhs;
+        m_value_type = Type::kUnknown;
+    }
+    void set_rhs(Instr *rhs) noexcept {
+        m_rhs = rhs;
+        m_value_type = Type::kUnknown;
+    }
 
     [[nodiscard]] Instr *get_lhs() const noexcept { return m_lhs; }
     [[nodiscard]] Instr *get_rhs() const noexcept { return m_rhs; }
@@ -161,6 +230,8 @@ class BranchInstr final : public Instr {
         }
     }
 
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_cond}; }
+
     void set_cond(Instr *cond) noexcept { m_cond = cond; }
     [[nodiscard]] Instr *get_cond() const noexcept { return m_cond; }
 };
@@ -180,6 +251,8 @@ class ReturnInstr final : public Instr {
         }
     }
 
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_ret}; }
+
     void set_ret(Instr *ret) noexcept { m_ret = ret; }
     [[nodiscard]] Instr *get_ret() noexcept { return m_ret; }
 };
@@ -192,6 +265,9 @@ class PhiInstr final : public Instr {
 
   private:
     std::vector<phi_node> m_incoming;
+    // Resolved lazily: incoming values of loop phis may depend on the phi itself
+    mutable Type m_value_type = Type::kUnknown;
+    mutable bool m_resolving = false;
 
   public:
     explicit PhiInstr() : Instr(InstrType::kPhi) {}
@@ -214,6 +290,29 @@ class PhiInstr final : public Instr {
         }
     }
 
+    [[nodiscard]] Type value_type() const override {
+        if (m_value_type != Type::kUnknown || m_resolving) {
+            return m_value_type;
+        }
+
+        m_resolving = true;
+        for (const auto &[instr, _] : m_incoming) {
+            if (auto instr_type = instr->value_type(); instr_type != Type::kUnknown) {
+                m_value_type = instr_type;
+                break;
+            }
+        }
+        m_resolving = false;
+        return m_value_type;
+    }
+
+    [[nodiscard]] std::vector<Instr *> operands() const override {
+        std::vector<Instr *> operands{};
+        operands.reserve(m_incoming.size());
+        std::ranges::transform(m_incoming, std::back_inserter(operands), &phi_node::first);
+        return operands;
+    }
+
     [[nodiscard]] auto &get_phi_nodes() & noexcept { return m_incoming; }
 };
 
@@ -233,6 +332,11 @@ class CallInstr final : public Instr {
         std::ranges::replace(m_args, from, to);
     }
 
+    // Defined in function.hpp, where the callee's return type is known
+    [[nodiscard]] Type value_type() const override;
+
+    [[nodiscard]] std::vector<Instr *> operands() const override { return m_args; }
+
     [[nodiscard]] auto get_callee() const noexcept { return m_callee; }
 
     [[nodiscard]] auto &get_args() & noexcept { return m_args; }
@@ -256,6 +360,12 @@ class AllocaInstr final : public Instr {
         }
     }
 
+    [[nodiscard]] Type value_type() const override { return Type::kInt; }
+
+    [[nodiscard]] std::vector<Instr *> operands() const override {
+        return m_size != nullptr ? std::vector<Instr *>{m_size} : std::vector<Instr *>{};
+    }
+
     [[nodiscard]] Type element_type() const noexcept { return m_element_type; }
     [[nodiscard]] Instr *size() const noexcept { return m_size; }
 };
@@ -269,6 +379,11 @@ class LoadInstr final : public Instr {
 
     static bool classof(const Instr *instr) noexcept { return instr->type() == InstrType::kLoad; }
 
+    // Element type of the underlying alloca, kUnknown for pointers of unknown origin
+    [[nodiscard]] Type value_type() const override;
+
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_ptr}; }
+
     void replace_operand(Instr *from, Instr *to) override {
         if (m_ptr == from) {
             m_ptr = to;
@@ -298,6 +413,8 @@ class StoreInstr final : public Instr {
         }
     }
 
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_ptr, m_value}; }
+
     [[nodiscard]] Instr *ptr() const noexcept { return m_ptr; }
     [[nodiscard]] Instr *value() const noexcept { return m_value; }
 };
@@ -313,6 +430,10 @@ class GepInstr final : public Instr {
 
     static bool classof(const Instr *instr) noexcept { return instr->type() == InstrType::kGep; }
 
+    [[nodiscard]] Type value_type() const override { return Type::kInt; }
+
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_ptr, m_index}; }
+
     void replace_operand(Instr *from, Instr *to) override {
         if (m_ptr == from) {
             m_ptr = to;
@@ -343,6 +464,8 @@ class NullCheck final : public Instr {
         }
     }
 
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_check}; }
+
     [[nodiscard]] auto get_check() noexcept { return m_check; }
 
     bool dominates(const NullCheck &rhs) const { return m_check == rhs.m_check; }
@@ -370,7 +493,11 @@ class BoundCheck final : public Instr {
         }
     }
 
+    [[nodiscard]] std::vector<Instr *> operands() const override { return {m_check}; }
+
     [[nodiscard]] auto get_check() noexcept { return m_check; }
+    [[nodiscard]] i64 get_lower_bound() const noexcept { return m_lower_bound; }
+    [[nodiscard]] i64 get_upper_bound() const noexcept { return m_upper_bound; }
 
     bool dominates(const BoundCheck &rhs) const {
         return m_lower_bound <= rhs.m_lower_bound && rhs.m_upper_bound <= m_upper_bound &&
@@ -378,6 +505,17 @@ class BoundCheck final : public Instr {
     };
 };
 
+inline Type LoadInstr::value_type() const {
+    auto *ptr = m_ptr;
+    while (GepInstr::classof(ptr)) {
+        ptr = static_cast<const GepInstr *>(ptr)->ptr();
+    }
+    if (AllocaInstr::classof(ptr)) {
+        return static_cast<const AllocaInstr *>(ptr)->element_type();
+    }
+    return Type::kUnknown;
+}
+
 template <typename TargetInstr, typename InstrR>
     requires std::ranges::input_range<InstrR> &&
              requires(std::ranges::range_reference_t<InstrR> ref) {
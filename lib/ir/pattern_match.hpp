@@ -0,0 +1,216 @@
+#ifndef PATTERN_MATCH_HPP
+#define PATTERN_MATCH_HPP
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "common.hpp"
+#include "instr.hpp"
+#include "type.hpp"
+
+namespace injir::pattern {
+
+/**
+ * Patterns are plain structs checked by match(instr, pattern), e.g.
+ *
+ *     Instr *x = nullptr;
+ *     if (match(instr, m_c_Mul(m_Value(x), m_ConstInt(1)))) { ... x ... }
+ *
+ * They nest as template arguments, so a match compiles down to the type checks and comparisons
+ * it consists of. Operands are bound by reference as they are matched, a failed match may leave
+ * some of them bound.
+ */
+template <typename Pattern> bool match(Instr *instr, const Pattern &pattern) {
+    return pattern.match(instr);
+}
+
+struct AnyValue {
+    bool match(Instr * /*instr*/) const { return true; }
+};
+
+struct BindValue {
+    Instr *&value;
+
+    bool match(Instr *instr) const {
+        value = instr;
+        return true;
+    }
+};
+
+struct SpecificValue {
+    const Instr *value;
+
+    bool match(Instr *instr) const { return instr == value; }
+};
+
+// the value bound earlier in the same pattern
+struct DeferredValue {
+    Instr *const &value;
+
+    bool match(Instr *instr) const { return instr == value; }
+};
+
+template <typename Pattern> struct BindPattern {
+    Instr *&value;
+    Pattern pattern;
+
+    bool match(Instr *instr) const {
+        if (!pattern.match(instr)) {
+            return false;
+        }
+        value = instr;
+        return true;
+    }
+};
+
+inline AnyValue m_Value() { return {}; }
+inline BindValue m_Value(Instr *&value) { return {value}; }
+inline SpecificValue m_Specific(const Instr *value) { return {value}; }
+inline DeferredValue m_Deferred(Instr *const &value) { return {value}; }
+
+// Binds the value matched by pattern
+template <typename Pattern> BindPattern<Pattern> m_Bind(Instr *&value, const Pattern &pattern) {
+    return {value, pattern};
+}
+
+struct IntConstant {
+    bool match(Instr *instr) const {
+        return instr->type() == InstrType::kConst && instr->value_type() == Type::kInt;
+    }
+};
+
+struct SpecificIntConstant {
+    i64 value;
+
+    bool match(Instr *instr) const {
+        return IntConstant{}.match(instr) &&
+               static_cast<const ConstInstr<i64> *>(instr)->get_value() == value;
+    }
+};
+
+struct BindIntConstant {
+    i64 &value;
+
+    bool match(Instr *instr) const {
+        if (!IntConstant{}.match(instr)) {
+            return false;
+        }
+        value = static_cast<const ConstInstr<i64> *>(instr)->get_value();
+        return true;
+    }
+};
+
+// Any integer constant, the constant equal to value or any one with its value bound
+inline IntConstant m_ConstInt() { return {}; }
+inline SpecificIntConstant m_ConstInt(i64 value) { return {value}; }
+inline BindIntConstant m_BindInt(i64 &value) { return {value}; }
+
+// Binary instruction of Opcode, a commutative pattern also matches the swapped operands
+template <InstrType Opcode, typename LHS, typename RHS, bool Commutative> struct BinaryPattern {
+    LHS lhs;
+    RHS rhs;
+
+    bool match(Instr *instr) const {
+        if (instr->type() != Opcode) {
+            return false;
+        }
+        auto *bin = static_cast<BinInstr *>(instr);
+        if (lhs.match(bin->get_lhs()) && rhs.match(bin->get_rhs())) {
+            return true;
+        }
+        return Commutative && lhs.match(bin->get_rhs()) && rhs.match(bin->get_lhs());
+    }
+};
+
+template <InstrType Opcode, typename LHS, typename RHS>
+BinaryPattern<Opcode, LHS, RHS, false> m_Binary(const LHS &lhs, const RHS &rhs) {
+    return {lhs, rhs};
+}
+
+template <InstrType Opcode, typename LHS, typename RHS>
+BinaryPattern<Opcode, LHS, RHS, true> m_c_Binary(const LHS &lhs, const RHS &rhs) {
+    return {lhs, rhs};
+}
+
+template <typename LHS, typename RHS> auto m_Add(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kAdd>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_Mul(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kMul>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_Div(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kDiv>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_Or(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kOr>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_Shl(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kShl>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_CmpLess(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kCmpLess>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_CmpLessEqual(const LHS &lhs, const RHS &rhs) {
+    return m_Binary<InstrType::kCmpLessEqual>(lhs, rhs);
+}
+
+// the commutative operations
+template <typename LHS, typename RHS> auto m_c_Add(const LHS &lhs, const RHS &rhs) {
+    return m_c_Binary<InstrType::kAdd>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_c_Mul(const LHS &lhs, const RHS &rhs) {
+    return m_c_Binary<InstrType::kMul>(lhs, rhs);
+}
+
+template <typename LHS, typename RHS> auto m_c_Or(const LHS &lhs, const RHS &rhs) {
+    return m_c_Binary<InstrType::kOr>(lhs, rhs);
+}
+
+/**
+ * @brief Rewrite rules indexed by the type of the instruction they apply to.
+ *
+ * A rule is a function pointer, usually a captureless lambda, returning the value which replaces
+ * the instruction or nullptr when it does not apply. Context carries whatever the rules need
+ * besides the instruction, e.g. a way to create constants. Only the rules registered for the type
+ * of an instruction are tried, in the order they were added, until one applies.
+ */
+template <typename Context> class RuleSet final {
+  public:
+    using rule_t = Instr *(*)(Instr *instr, Context &context);
+
+  private:
+    static constexpr std::size_t kTypes = static_cast<std::size_t>(InstrType::kUnknown) + 1;
+
+    std::array<std::vector<rule_t>, kTypes> m_rules{};
+
+    static std::size_t index(InstrType type) { return static_cast<std::size_t>(type); }
+
+  public:
+    RuleSet &add(InstrType type, rule_t rule) {
+        m_rules[index(type)].push_back(rule);
+        return *this;
+    }
+
+    Instr *apply(Instr *instr, Context &context) const {
+        for (auto rule : m_rules[index(instr->type())]) {
+            if (auto *replacement = rule(instr, context); replacement != nullptr) {
+                return replacement;
+            }
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] std::size_t size(InstrType type) const { return m_rules[index(type)].size(); }
+};
+
+} // namespace injir::pattern
+
+#endif // PATTERN_MATCH_HPP
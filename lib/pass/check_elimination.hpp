@@ -1,7 +1,11 @@
 #ifndef PASS_CHECK_ELIMINATION_HPP
 #define PASS_CHECK_ELIMINATION_HPP
 
-#include <stdexcept>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "graph/dom.hpp"
@@ -11,26 +15,97 @@
 
 namespace injir::pass {
 
+/**
+ * @brief Removal of the checks dominated by an equal or stronger check on the same value.
+ *
+ * The dominator tree is walked in preorder with the checks available on the path from the root,
+ * indexed by the checked value. The bounds of a value are kept as intervals none of which contains
+ * another one, ordered by the lower bound and so by the upper bound too: the interval with the
+ * greatest lower bound not above the one of a check has the greatest upper bound among the
+ * intervals which may contain it. Each block undoes its changes once its subtree is done.
+ */
 class CheckElimination final : public Pass {
   private:
-    bool dominates(const Instr *dominator, const Instr *check) {
-        if (dominator->type() != check->type())
+    // lower bound -> upper bound
+    using intervals_t = std::map<i64, i64>;
+
+    struct IntervalChange {
+        Instr *value;
+        i64 lower;
+        std::vector<std::pair<i64, i64>> removed;
+    };
+
+    graph::dom_tree_t m_dom_tree{};
+    std::unordered_set<Instr *> m_null_checked{};
+    std::unordered_map<Instr *, intervals_t> m_bounds{};
+    // Changes in the order they were made, a block reverts the ones it made
+    std::vector<Instr *> m_null_scope{};
+    std::vector<IntervalChange> m_bound_scope{};
+    bool m_changed = false;
+
+    bool is_available(BoundCheck *check) {
+        auto it = m_bounds.find(check->get_check());
+        if (it == m_bounds.end()) {
+            return false;
+        }
+        const auto &intervals = it->second;
+        auto interval_it = intervals.upper_bound(check->get_lower_bound());
+        return interval_it != intervals.begin() &&
+               std::prev(interval_it)->second >= check->get_upper_bound();
+    }
+
+    // The new interval is not contained in any other, drop the intervals it contains
+    void make_available(BoundCheck *check) {
+        auto lower = check->get_lower_bound();
+        auto upper = check->get_upper_bound();
+        auto &intervals = m_bounds[check->get_check()];
+
+        IntervalChange change{check->get_check(), lower, {}};
+        auto it = intervals.lower_bound(lower);
+        while (it != intervals.end() && it->second <= upper) {
+            change.removed.emplace_back(*it);
+            it = intervals.erase(it);
+        }
+        intervals.emplace(lower, upper);
+        m_bound_scope.push_back(std::move(change));
+    }
+
+    bool eliminate(Instr *check) {
+        if (NullCheck::classof(check)) {
+            auto *value = static_cast<NullCheck *>(check)->get_check();
+            if (!m_null_checked.insert(value).second) {
+                return true;
+            }
+            m_null_scope.push_back(value);
             return false;
+        }
+
+        auto *bound_check = static_cast<BoundCheck *>(check);
+        if (is_available(bound_check)) {
+            return true;
+        }
+        make_available(bound_check);
+        return false;
+    }
+
+    void undo(std::size_t null_scope_before, std::size_t bound_scope_before) {
+        for (auto i = m_null_scope.size(); i != null_scope_before; --i) {
+            m_null_checked.erase(m_null_scope[i - 1]);
+        }
+        m_null_scope.resize(null_scope_before);
 
-        switch (check->type()) {
-        case InstrType::kNullCheck:
-            return static_cast<const NullCheck *>(dominator)->dominates(
-                *static_cast<const NullCheck *>(check));
-        case InstrType::kBoundCheck:
-            return static_cast<const BoundCheck *>(dominator)->dominates(
-                *static_cast<const BoundCheck *>(check));
-        default:
-            throw std::runtime_error{"Unknown check class"};
+        for (auto i = m_bound_scope.size(); i != bound_scope_before; --i) {
+            auto &change = m_bound_scope[i - 1];
+            auto &intervals = m_bounds.at(change.value);
+            intervals.erase(change.lower);
+            intervals.insert(change.removed.begin(), change.removed.end());
         }
+        m_bound_scope.resize(bound_scope_before);
     }
 
     void eliminate_checks(BasicBlock *bb) {
-        std::size_t seen_before = m_seen.size();
+        auto null_scope_before = m_null_scope.size();
+        auto bound_scope_before = m_bound_scope.size();
 
         auto is_check_instr = [](const auto *instr) {
             return NullCheck::classof(instr) || BoundCheck::classof(instr);
@@ -43,16 +118,10 @@ class CheckElimination final : public Pass {
                 continue;
             };
 
-            auto *check = instr_it->get();
-
-            bool already_seen =
-                std::ranges::any_of(m_seen, [this, check](auto *s) { return dominates(s, check); });
-
-            if (already_seen) {
-                instr_it = bb->erase(instr_it);
+            if (eliminate(instr_it->get())) {
+                instr_it = erase_instr(*bb, instr_it);
                 m_changed = true;
             } else {
-                m_seen.push_back(check);
                 ++instr_it;
             }
         }
@@ -62,19 +131,18 @@ class CheckElimination final : public Pass {
                 eliminate_checks(child);
         }
 
-        m_seen.resize(seen_before);
+        undo(null_scope_before, bound_scope_before);
     }
 
-    graph::dom_tree_t m_dom_tree{};
-    std::vector<const Instr *> m_seen{};
-    bool m_changed = false;
-
   public:
     bool apply(Function &func) {
         m_changed = false;
-        m_seen.clear();
+        m_null_checked.clear();
+        m_bounds.clear();
+        m_null_scope.clear();
+        m_bound_scope.clear();
         auto *root_basic_block = &(*func.begin());
-        m_dom_tree = graph::dom(root_basic_block);
+        m_dom_tree = graph::idom_tree(root_basic_block);
 
         eliminate_checks(root_basic_block);
         return m_changed;
@@ -83,4 +151,4 @@ class CheckElimination final : public Pass {
 
 } // namespace injir::pass
 
-#endif // PASS_CHECK_ELIMINATION_HPP
\ No newline at end of file
+#endif // PASS_CHECK_ELIMINATION_HPP
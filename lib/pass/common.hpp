@@ -1,8 +1,13 @@
 #ifndef PASS_COMMON_HPP
 #define PASS_COMMON_HPP
 
+#include <algorithm>
 #include <cassert>
+#include <optional>
+#include <unordered_set>
 
+#include "graph/dfs.hpp"
+#include "ir/basic_block.hpp"
 #include "ir/function.hpp"
 #include "ir/instr.hpp"
 
@@ -17,14 +22,114 @@ inline void replace_instr_uses(Instr *from, Instr *to) {
     }
 }
 
+// Erase the instruction from bb and from the users of its operands, its own uses must be gone
+inline BasicBlock::iterator erase_instr(BasicBlock &bb, BasicBlock::iterator instr_it) {
+    auto *instr = instr_it->get();
+    for (auto *operand : instr->operands()) {
+        operand->remove_user(instr);
+    }
+    return bb.erase(instr_it);
+}
+
+/**
+ * @brief Value of a binary instruction on integer constants.
+ *
+ * Integers are unsigned and wrap around. A division by zero traps and a shift by 64 or more
+ * is not defined, those are left to run time.
+ */
+inline std::optional<i64> fold_int(InstrType type, i64 lhs, i64 rhs) {
+    switch (type) {
+    case InstrType::kAdd:
+        return lhs + rhs;
+    case InstrType::kMul:
+        return lhs * rhs;
+    case InstrType::kDiv:
+        return rhs != 0 ? std::optional<i64>{lhs / rhs} : std::nullopt;
+    case InstrType::kOr:
+        return lhs | rhs;
+    case InstrType::kShl:
+        return rhs < 64 ? std::optional<i64>{lhs << rhs} : std::nullopt;
+    case InstrType::kCmpLess:
+        return lhs < rhs;
+    case InstrType::kCmpLessEqual:
+        return lhs <= rhs;
+    default:
+        return std::nullopt;
+    }
+}
+
+// Value of an arithmetic instruction on float constants, IEEE 754 with no traps
+inline std::optional<double> fold_float(InstrType type, double lhs, double rhs) {
+    switch (type) {
+    case InstrType::kAdd:
+        return lhs + rhs;
+    case InstrType::kMul:
+        return lhs * rhs;
+    case InstrType::kDiv:
+        return lhs / rhs;
+    default:
+        return std::nullopt;
+    }
+}
+
+// Forget the edge pred -> succ in succ: its predecessor entry and the incoming values of its phis
+inline void remove_incoming(BasicBlock *pred, BasicBlock *succ) {
+    assert(pred != nullptr && "pred block is nullptr");
+    assert(succ != nullptr && "succ block is nullptr");
+
+    auto pred_it = std::find(succ->preds_begin(), succ->preds_end(), pred);
+    assert(pred_it != succ->preds_end() && "pred is not a predecessor of succ");
+    succ->erase_pred_bb(pred_it);
+
+    for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+        auto &nodes = phi->get_phi_nodes();
+        if (auto it = std::ranges::find(nodes, pred, &PhiInstr::phi_node::second);
+            it != nodes.end()) {
+            it->first->remove_user(phi);
+            nodes.erase(it);
+        }
+    }
+}
+
+// Erase the blocks which cannot be reached from the first block of func
+inline bool remove_unreachable_blocks(Function &func) {
+    if (func.size() == 0) {
+        return false;
+    }
+    auto reachable_vector = graph::dfs(&*func.begin());
+    std::unordered_set<BasicBlock *> reachable(reachable_vector.begin(), reachable_vector.end());
+
+    // values of unreachable blocks are used in unreachable blocks only
+    auto changed = false;
+    for (auto &bb : func) {
+        if (reachable.contains(&bb)) {
+            continue;
+        }
+        for (auto *succ : {bb.get_true_successor(), bb.get_false_successor()}) {
+            if (succ != nullptr && reachable.contains(succ)) {
+                remove_incoming(&bb, succ);
+            }
+        }
+        for (const auto &instr : bb) {
+            for (auto *operand : instr->operands()) {
+                operand->remove_user(instr.get());
+            }
+        }
+        changed = true;
+    }
+
+    for (auto it = func.begin(); it != func.end();) {
+        it = reachable.contains(&*it) ? std::next(it) : func.erase(it);
+    }
+    return changed;
+}
+
 class Pass {
   public:
     virtual bool apply(Function &func) = 0;
     virtual ~Pass() = default;
 };
 
-// class DeadCodeElimination : public Pass {};
-
 class PassManager {
   public:
     bool run(Pass *pass, Function &func) { return pass->apply(func); }
@@ -0,0 +1,268 @@
+#ifndef PASS_DCE_HPP
+#define PASS_DCE_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "graph/dfs.hpp"
+#include "graph/dom.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Dead code elimination.
+ *
+ * The default mode erases instructions without users and side effects (see
+ * InstrTraits::has_side_effects), then the operands left without users, until the worklist is
+ * empty. Values which only use each other, such as the phi of an unused loop counter, survive.
+ *
+ * The aggressive mode assumes everything dead and marks live the instructions with side effects,
+ * their operands and the branches their blocks are control dependent on, found from the
+ * post-dominator tree. Branches left dead are replaced by a jump to the nearest live
+ * post-dominator, and the blocks which become unreachable are erased. Loops without side effects
+ * are assumed to terminate.
+ */
+class DeadCodeElimination final : public Pass {
+  private:
+    bool m_aggressive = false;
+
+    using instr_pos_t = std::pair<BasicBlock *, BasicBlock::iterator>;
+    std::unordered_map<Instr *, instr_pos_t> m_positions{};
+
+    // Aggressive mode state
+    graph::idom_t m_ipdoms{};
+    // Blocks whose branches decide whether the block is executed
+    std::unordered_map<BasicBlock *, std::vector<BasicBlock *>> m_control_deps{};
+    std::unordered_set<Instr *> m_live{};
+    std::unordered_set<BasicBlock *> m_live_blocks{};
+    std::vector<Instr *> m_worklist{};
+
+    static bool is_trivially_dead(const Instr *instr) {
+        return instr->users().empty() && !InstrTraits::has_side_effects(instr->type());
+    }
+
+    void collect_positions(Function &func) {
+        m_positions.clear();
+        for (auto &bb : func) {
+            for (auto it = bb.begin(); it != bb.end(); ++it) {
+                m_positions.emplace(it->get(), instr_pos_t{&bb, it});
+            }
+        }
+    }
+
+    bool eliminate(Function &func) {
+        collect_positions(func);
+
+        std::vector<Instr *> worklist{};
+        for (const auto &[instr, _] : m_positions) {
+            if (is_trivially_dead(instr)) {
+                worklist.push_back(instr);
+            }
+        }
+
+        auto changed = false;
+        while (!worklist.empty()) {
+            auto *instr = worklist.back();
+            worklist.pop_back();
+
+            auto pos = m_positions.find(instr);
+            if (pos == m_positions.end() || !is_trivially_dead(instr)) {
+                continue;
+            }
+            auto operands = instr->operands();
+            erase_instr(*pos->second.first, pos->second.second);
+            m_positions.erase(pos);
+            changed = true;
+
+            for (auto *operand : operands) {
+                if (m_positions.contains(operand) && is_trivially_dead(operand)) {
+                    worklist.push_back(operand);
+                }
+            }
+        }
+        return changed;
+    }
+
+    // A block is control dependent on the branches of A when it post-dominates a successor of A
+    // but not A itself: walk up from each successor to the post-dominator of A
+    void collect_control_deps(const std::vector<BasicBlock *> &blocks) {
+        m_control_deps.clear();
+        for (auto *bb : blocks) {
+            if (bb->get_false_successor() == nullptr) {
+                continue;
+            }
+            auto ipdom_it = m_ipdoms.find(bb);
+            auto *stop = ipdom_it != m_ipdoms.end() ? ipdom_it->second : nullptr;
+
+            for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+                for (auto *runner = succ; runner != nullptr && runner != stop;) {
+                    m_control_deps[runner].push_back(bb);
+                    auto it = m_ipdoms.find(runner);
+                    runner = it != m_ipdoms.end() ? it->second : nullptr;
+                }
+            }
+        }
+    }
+
+    void mark_live(Instr *instr) {
+        if (m_positions.contains(instr) && m_live.insert(instr).second) {
+            m_worklist.push_back(instr);
+        }
+    }
+
+    void mark_live_block(BasicBlock *bb) {
+        if (!m_live_blocks.insert(bb).second) {
+            return;
+        }
+        if (auto it = m_control_deps.find(bb); it != m_control_deps.end()) {
+            for (auto *dep : it->second) {
+                mark_live(std::prev(dep->end())->get());
+            }
+        }
+    }
+
+    void propagate() {
+        while (!m_worklist.empty()) {
+            auto *instr = m_worklist.back();
+            m_worklist.pop_back();
+
+            mark_live_block(m_positions.at(instr).first);
+            for (auto *operand : instr->operands()) {
+                mark_live(operand);
+            }
+            // the value of a phi depends on the edge it comes over
+            if (PhiInstr::classof(instr)) {
+                for (const auto &[_, pred] : static_cast<PhiInstr *>(instr)->get_phi_nodes()) {
+                    mark_live_block(pred);
+                }
+            }
+        }
+    }
+
+    // Where the dead branch of bb jumps instead, nullptr if it has to stay
+    BasicBlock *branch_target(BasicBlock *bb) const {
+        auto it = m_ipdoms.find(bb);
+        auto *target = it != m_ipdoms.end() ? it->second : nullptr;
+        while (target != nullptr && !m_live_blocks.contains(target)) {
+            target = m_ipdoms.at(target);
+        }
+        // a live phi would need a value for the new edge
+        if (target != nullptr && std::ranges::any_of(collect_instrs<PhiInstr>(*target),
+                                                     [this](auto *phi) {
+                                                         return m_live.contains(phi);
+                                                     })) {
+            return nullptr;
+        }
+        return target;
+    }
+
+    bool eliminate_aggressive(Function &func) {
+        collect_positions(func);
+        auto *entry = &*func.begin();
+        auto blocks = graph::dfs(entry);
+
+        m_ipdoms = graph::ipdom(entry);
+        collect_control_deps(blocks);
+        m_live.clear();
+        m_live_blocks.clear();
+        m_worklist.clear();
+
+        for (auto *bb : blocks) {
+            for (const auto &instr : *bb) {
+                auto type = instr->type();
+                if (type == InstrType::kJump) {
+                    continue;
+                }
+                // branches of blocks which never reach an exit keep their loops
+                if (type == InstrType::kBranch ? !m_ipdoms.contains(bb)
+                                               : InstrTraits::has_side_effects(type)) {
+                    mark_live(instr.get());
+                }
+            }
+        }
+        propagate();
+
+        // Keeping a branch makes more blocks live, which may move the targets of the others
+        std::vector<std::pair<BasicBlock *, BasicBlock *>> folded{};
+        for (auto stable = false; !stable;) {
+            stable = true;
+            folded.clear();
+            for (auto *bb : blocks) {
+                if (bb->get_false_successor() == nullptr || bb->size() == 0) {
+                    continue;
+                }
+                auto *branch = std::prev(bb->end())->get();
+                if (m_live.contains(branch)) {
+                    continue;
+                }
+                if (auto *target = branch_target(bb); target != nullptr) {
+                    folded.emplace_back(bb, target);
+                } else {
+                    mark_live(branch);
+                    propagate();
+                    stable = false;
+                }
+            }
+        }
+
+        auto changed = false;
+        for (auto [bb, target] : folded) {
+            for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+                remove_incoming(bb, succ);
+            }
+            auto branch_it = std::prev(bb->end());
+            m_positions.erase(branch_it->get());
+            erase_instr(*bb, branch_it);
+
+            auto *jump = bb->emplace_back(std::make_unique<JumpInstr>())->get();
+            m_live.insert(jump);
+            bb->set_succ_bb(target, 0);
+            bb->set_succ_bb(nullptr, 1);
+            target->emplace_back_pred_bb(bb);
+            changed = true;
+        }
+        changed = remove_unreachable_blocks(func) || changed;
+
+        // Dead values may use each other: unlink all of them before erasing any
+        std::vector<instr_pos_t> dead{};
+        for (auto &bb : func) {
+            for (auto it = bb.begin(); it != bb.end(); ++it) {
+                if (!m_live.contains(it->get()) && (*it)->type() != InstrType::kJump) {
+                    dead.emplace_back(&bb, it);
+                }
+            }
+        }
+        for (auto [bb, it] : dead) {
+            for (auto *operand : (*it)->operands()) {
+                operand->remove_user(it->get());
+            }
+        }
+        for (auto [bb, it] : dead) {
+            bb->erase(it);
+        }
+        return changed || !dead.empty();
+    }
+
+  public:
+    explicit DeadCodeElimination(bool aggressive = false) : m_aggressive{aggressive} {}
+
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        return m_aggressive ? eliminate_aggressive(func) : eliminate(func);
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_DCE_HPP
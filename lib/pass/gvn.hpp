@@ -0,0 +1,148 @@
+#ifndef PASS_GVN_HPP
+#define PASS_GVN_HPP
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "graph/dom.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Global value numbering over the dominator tree.
+ *
+ * Pure instructions are keyed on their opcode and operands, the operands of kAdd, kMul and kOr
+ * are ordered first so both orders share a key. Blocks are walked in dominator tree preorder
+ * with a scoped table: an instruction whose key is already in the table is dominated by the
+ * instruction recorded there, and is replaced by it. The entries of a block are dropped when
+ * its subtree is done, as siblings do not dominate each other.
+ *
+ * Binary instructions, geps and constants are numbered. Loads, allocas, calls and phis are not.
+ */
+class GVN final : public Pass {
+  private:
+    struct ValueKey {
+        InstrType type;
+        // tells the constants of both types apart
+        Type value_type;
+        Instr *lhs;
+        Instr *rhs;
+        // bits of the constant
+        i64 value;
+
+        bool operator==(const ValueKey &rhs) const noexcept = default;
+    };
+
+    struct ValueKeyHash {
+        std::size_t operator()(const ValueKey &key) const noexcept {
+            auto hash = std::hash<instr_type_t>{}(static_cast<instr_type_t>(key.type));
+            auto combine = [&hash](std::size_t value) {
+                hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+            };
+            combine(std::hash<Instr *>{}(key.lhs));
+            combine(std::hash<Instr *>{}(key.rhs));
+            combine(std::hash<i64>{}(key.value));
+            return hash;
+        }
+    };
+
+    graph::dom_tree_t m_dom_tree{};
+    std::unordered_map<ValueKey, Instr *, ValueKeyHash> m_table{};
+    // Keys in the order they entered the table, a block drops the ones it added
+    std::vector<ValueKey> m_scope{};
+    bool m_changed = false;
+
+    static bool is_commutative(InstrType type) {
+        return type == InstrType::kAdd || type == InstrType::kMul || type == InstrType::kOr;
+    }
+
+    static std::optional<ValueKey> value_key(Instr *instr) {
+        auto type = instr->type();
+        if (type == InstrType::kConst) {
+            auto value_type = instr->value_type();
+            auto bits = value_type == Type::kFloat
+                            ? std::bit_cast<i64>(
+                                  static_cast<ConstInstr<double> *>(instr)->get_value())
+                            : static_cast<ConstInstr<i64> *>(instr)->get_value();
+            return ValueKey{type, value_type, nullptr, nullptr, bits};
+        }
+        if (InstrTraits::is_binary(type) || type == InstrType::kDiv) {
+            auto *bin = static_cast<BinInstr *>(instr);
+            auto *lhs = bin->get_lhs();
+            auto *rhs = bin->get_rhs();
+            if (is_commutative(type) && std::less<Instr *>{}(rhs, lhs)) {
+                std::swap(lhs, rhs);
+            }
+            return ValueKey{type, Type::kUnknown, lhs, rhs, 0};
+        }
+        if (type == InstrType::kGep) {
+            auto *gep = static_cast<GepInstr *>(instr);
+            return ValueKey{type, Type::kUnknown, gep->ptr(), gep->index(), 0};
+        }
+        return std::nullopt;
+    }
+
+    // Operands dominate their users, so they are already replaced by their leaders here
+    void number_values(BasicBlock *bb) {
+        auto scope_before = m_scope.size();
+
+        for (auto instr_it = bb->begin(); instr_it != bb->end();) {
+            auto *instr = instr_it->get();
+            auto key = value_key(instr);
+            if (!key.has_value()) {
+                ++instr_it;
+                continue;
+            }
+
+            if (auto [it, inserted] = m_table.try_emplace(*key, instr); !inserted) {
+                replace_instr_uses(instr, it->second);
+                instr->clear_users();
+                instr_it = erase_instr(*bb, instr_it);
+                m_changed = true;
+            } else {
+                m_scope.push_back(*key);
+                ++instr_it;
+            }
+        }
+
+        if (auto it = m_dom_tree.find(bb); it != m_dom_tree.end()) {
+            for (auto *child : it->second) {
+                number_values(child);
+            }
+        }
+
+        for (auto i = m_scope.size(); i != scope_before; --i) {
+            m_table.erase(m_scope[i - 1]);
+        }
+        m_scope.resize(scope_before);
+    }
+
+  public:
+    bool apply(Function &func) {
+        m_changed = false;
+        m_table.clear();
+        m_scope.clear();
+        if (func.size() == 0) {
+            return false;
+        }
+
+        auto *root_basic_block = &(*func.begin());
+        m_dom_tree = graph::idom_tree(root_basic_block);
+
+        number_values(root_basic_block);
+        return m_changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_GVN_HPP
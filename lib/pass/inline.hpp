@@ -2,24 +2,133 @@
 #define INLINE_HPP
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <ranges>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "analysis/call_graph.hpp"
+#include "analysis/loop.hpp"
 #include "common.hpp"
+#include "ir/clone.hpp"
 #include "ir/function.hpp"
 #include "ir/instr.hpp"
 
 namespace injir::pass {
 
+struct InlineOptions {
+    // A call is inlined when the size of the callee minus the bonuses is at most threshold
+    long threshold = 25;
+    // Per use in the callee of an argument which is a constant at the call site
+    long constant_arg_bonus = 3;
+    // Per loop around the call site
+    long loop_bonus = 15;
+    // Levels of recursive calls inlined into one call site
+    std::size_t max_recursion_depth = 2;
+    // Callers are not grown past this number of instructions
+    std::size_t max_caller_size = 2000;
+};
+
+/**
+ * @brief Inlining with a cost model.
+ *
+ * The call graph reachable from the function is walked bottom-up by strongly connected
+ * components, so callees are inlined into before their callers. A call is replaced by a copy of
+ * the callee when the callee is small enough: every argument and the call itself count as saved
+ * instructions, constant arguments and loops around the call make inlining cheaper. Calls to the
+ * functions of the same component are inlined up to max_recursion_depth times from a copy taken
+ * before the component is changed.
+ */
 class Inline final : public Pass {
-    void inline_call(Function &caller, BasicBlock &call_bb, CallInstr *call) {
-        auto *callee = call->get_callee();
-        assert(&caller != callee && "recursive inlining is forbidden");
+  private:
+    struct CallSite {
+        CallInstr *call;
+        std::size_t recursion_depth;
+        std::size_t loop_depth;
+    };
+
+    InlineOptions m_options{};
+    // Bodies of the recursive functions as they were before inlining into them
+    std::unordered_map<const Function *, Function> m_originals{};
+
+    static std::size_t function_size(const Function &func) {
+        std::size_t size = 0;
+        for (const auto &bb : func) {
+            size += bb.size();
+        }
+        return size;
+    }
+
+    static bool can_inline(const Function &callee) {
+        if (callee.size() == 0 || callee.begin()->preds_begin() != callee.begin()->preds_end()) {
+            return false;
+        }
+        return std::ranges::any_of(callee, [](const auto &bb) {
+            return std::ranges::any_of(bb, [](const auto &instr) {
+                return ReturnInstr::classof(instr.get());
+            });
+        });
+    }
+
+    static std::unordered_map<BasicBlock *, std::size_t> loop_depths(Function &func) {
+        std::unordered_map<BasicBlock *, std::size_t> depths{};
+        for (auto &[header, loop] : analysis::loop_tree(&*func.begin())) {
+            if (header == nullptr) {
+                continue;
+            }
+            std::vector<BasicBlock *> blocks = loop.basic_blocks;
+            std::ranges::sort(blocks);
+            auto [first, last] = std::ranges::unique(blocks);
+            blocks.erase(first, last);
+            for (auto *bb : blocks) {
+                ++depths[bb];
+            }
+        }
+        return depths;
+    }
+
+    bool should_inline(const CallSite &site, const Function &callee) const {
+        auto *call = site.call;
+        auto &args = call->get_args();
+        auto callee_args = collect_instrs<ArgInstr>(*callee.begin());
+
+        auto benefit = static_cast<long>(args.size()) + 1;
+        for (auto &&[arg, callee_arg] : std::views::zip(args, callee_args)) {
+            if (arg->type() == InstrType::kConst) {
+                benefit +=
+                    m_options.constant_arg_bonus * static_cast<long>(callee_arg->users().size());
+            }
+        }
+        benefit += m_options.loop_bonus * static_cast<long>(site.loop_depth);
+
+        auto cost = static_cast<long>(function_size(callee) - callee_args.size());
+        return cost - benefit <= m_options.threshold;
+    }
+
+    static std::pair<BasicBlock *, BasicBlock::iterator> find_instr(Function &func, Instr *instr) {
+        for (auto &bb : func) {
+            auto it = std::ranges::find_if(
+                bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+            if (it != bb.end()) {
+                return {&bb, it};
+            }
+        }
+        assert(false && "instr not found in function");
+        return {};
+    }
+
+    // Replace the call by a copy of the callee, return the calls of the copy
+    std::vector<CallInstr *> inline_call(Function &caller, CallInstr *call,
+                                         const Function &callee) {
+        auto body = clone_function(callee);
 
         // 1. split BasicBlock with call instruction on: call_block and call_cont
-        auto call_it =
-            std::ranges::find_if(call_bb, [call](auto &instr) { return instr.get() == call; });
-        assert(call_it != call_bb.end() && "call instr not found in bb");
+        auto [call_bb_ptr, call_it] = find_instr(caller, call);
+        auto &call_bb = *call_bb_ptr;
 
         BasicBlock call_cont_bb{};
         call_cont_bb.splice(call_cont_bb.end(), call_bb, std::next(call_it));
@@ -27,7 +136,7 @@ class Inline final : public Pass {
         call_cont_bb.set_succ_bb(call_bb.get_true_successor(), 0);
         call_cont_bb.set_succ_bb(call_bb.get_false_successor(), 1);
 
-        call_bb.set_succ_bb(&call_cont_bb, 0);
+        call_bb.set_succ_bb(nullptr, 0);
         call_bb.set_succ_bb(nullptr, 1);
 
         // Insert call_cont_bb into caller right after call_bb
@@ -38,38 +147,48 @@ class Inline final : public Pass {
         auto call_cont_it = caller.insert(std::next(call_bb_it), std::move(call_cont_bb));
         auto &call_cont = *call_cont_it;
 
+        // the successors of call_bb are reached from call_cont now
+        for (auto *succ : {call_cont.get_true_successor(), call_cont.get_false_successor()}) {
+            if (succ == nullptr) {
+                continue;
+            }
+            std::replace(succ->preds_begin(), succ->preds_end(), &call_bb, &call_cont);
+            for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+                std::ranges::replace(phi->get_phi_nodes() | std::views::values, &call_bb,
+                                     &call_cont);
+            }
+        }
+
         // 2. Update data flow for parameters
         auto &caller_args = call->get_args();
+        auto &body_entry = *body.begin();
 
-        std::vector callee_args = collect_instrs<ArgInstr>(*callee->begin());
+        std::vector callee_args = collect_instrs<ArgInstr>(body_entry);
         assert(caller_args.size() == callee_args.size() && "arg count mismatch");
 
         for (auto &&[caller_arg, callee_arg] : std::views::zip(caller_args, callee_args)) {
             replace_instr_uses(callee_arg, caller_arg);
             callee_arg->clear_users();
         }
+        for (auto it = body_entry.begin(); it != body_entry.end();) {
+            it = ArgInstr::classof(it->get()) ? body_entry.erase(it) : std::next(it);
+        }
 
         // 3. Update DataFlow for return(s)
-        auto all_instr = *callee | std::views::transform([](auto &bb) {
-            return std::ranges::subrange(bb.begin(), bb.end());
-        }) | std::views::join;
-
-        std::vector returns = collect_instrs<ReturnInstr>(all_instr);
-        assert(!returns.empty() && "callee has no return");
-
         std::vector<std::pair<ReturnInstr *, BasicBlock *>> ret_pairs;
-        for (auto *ret : returns) {
-            auto ret_bb_it = std::ranges::find_if(*callee, [ret](auto &bb) {
-                return std::ranges::any_of(bb, [ret](auto &instr) { return instr.get() == ret; });
-            });
-            assert(ret_bb_it != callee->end() && "return bb not found");
-            ret_pairs.emplace_back(ret, &*ret_bb_it);
+        std::vector<CallInstr *> calls{};
+        for (auto &bb : body) {
+            for (auto *ret : collect_instrs<ReturnInstr>(bb)) {
+                ret_pairs.emplace_back(ret, &bb);
+            }
+            std::ranges::copy(collect_instrs<CallInstr>(bb), std::back_inserter(calls));
         }
+        assert(!ret_pairs.empty() && "callee has no return");
 
         Instr *return_value = nullptr;
 
-        if (returns.size() == 1) {
-            return_value = returns.front()->get_ret();
+        if (ret_pairs.size() == 1) {
+            return_value = ret_pairs.front().first->get_ret();
         } else {
             auto phi = std::make_unique<PhiInstr>();
             auto *phi_ptr = phi.get();
@@ -83,40 +202,90 @@ class Inline final : public Pass {
 
         replace_instr_uses(call, return_value);
         call->clear_users();
+        erase_instr(call_bb, call_it);
 
-        // 4. Move callee blocks into caller
-        auto *callee_first_bb = &*callee->begin();
-        caller.splice(call_cont_it, *callee);
-
-        // 5. Connect blocks
-        call_bb.set_succ_bb(callee_first_bb, 0);
-        call_bb.set_succ_bb(nullptr, 1);
-        callee_first_bb->emplace_back_pred_bb(&call_bb);
-
+        // 4. Returns jump to call_cont
         for (auto &[ret, ret_bb] : ret_pairs) {
+            erase_instr(*ret_bb, std::prev(ret_bb->end()));
+            ret_bb->emplace_back(std::make_unique<JumpInstr>());
             ret_bb->set_succ_bb(&call_cont, 0);
             ret_bb->set_succ_bb(nullptr, 1);
             call_cont.emplace_back_pred_bb(ret_bb);
         }
+
+        // 5. Move callee blocks into caller and connect them
+        call_bb.emplace_back(std::make_unique<JumpInstr>());
+        call_bb.set_succ_bb(&body_entry, 0);
+        body_entry.emplace_back_pred_bb(&call_bb);
+
+        caller.splice(call_cont_it, body);
+        return calls;
+    }
+
+    bool inline_calls(Function &caller, const std::vector<Function *> &scc) {
+        auto depths = loop_depths(caller);
+        std::vector<CallSite> sites{};
+        for (auto &bb : caller) {
+            for (auto *call : collect_instrs<CallInstr>(bb)) {
+                auto depth_it = depths.find(&bb);
+                sites.push_back({call, 0, depth_it != depths.end() ? depth_it->second : 0});
+            }
+        }
+
+        auto changed = false;
+        auto caller_size = function_size(caller);
+        for (std::size_t i = 0; i != sites.size(); ++i) {
+            auto site = sites[i];
+            auto *callee = site.call->get_callee();
+
+            auto recursive = std::ranges::find(scc, callee) != scc.end();
+            const auto &source = recursive ? m_originals.at(callee) : *callee;
+            if ((recursive && site.recursion_depth >= m_options.max_recursion_depth) ||
+                !can_inline(source) || !should_inline(site, source)) {
+                continue;
+            }
+            auto size = function_size(source);
+            if (caller_size + size > m_options.max_caller_size) {
+                continue;
+            }
+
+            for (auto *call : inline_call(caller, site.call, source)) {
+                if (std::ranges::find(scc, call->get_callee()) != scc.end()) {
+                    sites.push_back({call, site.recursion_depth + 1, site.loop_depth});
+                }
+            }
+            caller_size += size;
+            changed = true;
+        }
+        return changed;
     }
 
   public:
+    Inline() = default;
+    explicit Inline(const InlineOptions &options) : m_options{options} {}
+
     bool apply(Function &func) {
+        auto graph = analysis::call_graph(&func);
+
         bool changed = false;
-        std::vector original_bbs(std::from_range, func | std::views::transform([](auto &bb) {
-                                                      return std::addressof(bb);
-                                                  }));
-
-        for (auto *bb : original_bbs) {
-            auto calls = collect_instrs<CallInstr>(*bb);
-            // Add constraints on inlining
-            std::ranges::for_each(
-                calls, [this, &func, bb](auto *call_instr) { inline_call(func, *bb, call_instr); });
+        for (const auto &scc : analysis::sccs_bottom_up(&func, graph)) {
+            m_originals.clear();
+            if (analysis::is_recursive(scc.front(), scc, graph)) {
+                for (auto *member : scc) {
+                    m_originals.emplace(member, clone_function(*member));
+                }
+            }
+            for (auto *member : scc) {
+                if (member->size() != 0) {
+                    changed = inline_calls(*member, scc) || changed;
+                }
+            }
         }
-        return true;
+        m_originals.clear();
+        return changed;
     }
 };
 
 } // namespace injir::pass
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,269 @@
+#ifndef PASS_INST_COMBINE_HPP
+#define PASS_INST_COMBINE_HPP
+
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common.hpp"
+#include "graph/dfs.hpp"
+#include "graph/rpo.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "ir/pattern_match.hpp"
+
+namespace injir::pass {
+
+struct InstCombineOptions {
+    // evaluate instructions with constant operands and branches on constants
+    bool fold_constants = true;
+    // algebraic identities such as x * 1 = x, and phis of a single value, see simplify_rules
+    bool simplify = true;
+};
+
+/**
+ * @brief Constant folding and peephole simplification driven by a worklist.
+ *
+ * All instructions are queued in RPO. An instruction which folds or simplifies to another value is
+ * replaced, and its users are queued again since their operands changed, so a fold can enable any
+ * other rule and the pass stops at a fixpoint after work proportional to the number of
+ * replacements. A branch on a constant becomes a jump and the phis of the successor it no longer
+ * reaches are queued. Replaced instructions are erased, their operands are left to DCE and the
+ * blocks which become unreachable to remove_unreachable_blocks.
+ */
+class InstCombine final : public Pass {
+  private:
+    struct Position {
+        BasicBlock *bb;
+        BasicBlock::iterator it;
+    };
+
+    InstCombineOptions m_options;
+    std::unordered_map<Instr *, Position> m_positions{};
+    std::vector<Instr *> m_worklist{};
+    std::unordered_set<Instr *> m_queued{};
+
+    static std::optional<i64> int_value(const Instr *instr) {
+        if (instr->type() != InstrType::kConst || instr->value_type() != Type::kInt) {
+            return std::nullopt;
+        }
+        return static_cast<const ConstInstr<i64> *>(instr)->get_value();
+    }
+
+    void push(Instr *instr) {
+        if (m_positions.contains(instr) && m_queued.insert(instr).second) {
+            m_worklist.push_back(instr);
+        }
+    }
+
+    Instr *insert_const(i64 value, const Position &pos) {
+        auto it = pos.bb->insert(std::make_unique<ConstInstr<i64>>(value), pos.it);
+        m_positions.emplace(it->get(), Position{pos.bb, it});
+        return it->get();
+    }
+
+    Instr *insert_float(double value, const Position &pos) {
+        auto it = pos.bb->insert(std::make_unique<ConstInstr<double>>(value), pos.it);
+        m_positions.emplace(it->get(), Position{pos.bb, it});
+        return it->get();
+    }
+
+    // New constant for instr when both its operands are constants of the same type
+    Instr *fold(BinInstr *instr) {
+        auto *lhs = instr->get_lhs();
+        auto *rhs = instr->get_rhs();
+        if (lhs->type() != InstrType::kConst || rhs->type() != InstrType::kConst ||
+            lhs->value_type() != rhs->value_type()) {
+            return nullptr;
+        }
+        const auto &pos = m_positions.at(instr);
+
+        if (lhs->value_type() == Type::kInt) {
+            auto value = fold_int(instr->type(), static_cast<ConstInstr<i64> *>(lhs)->get_value(),
+                                  static_cast<ConstInstr<i64> *>(rhs)->get_value());
+            return value.has_value() ? insert_const(*value, pos) : nullptr;
+        }
+
+        auto lhs_value = static_cast<ConstInstr<double> *>(lhs)->get_value();
+        auto rhs_value = static_cast<ConstInstr<double> *>(rhs)->get_value();
+        switch (instr->type()) {
+        case InstrType::kCmpLess:
+            return insert_const(lhs_value < rhs_value, pos);
+        case InstrType::kCmpLessEqual:
+            return insert_const(lhs_value <= rhs_value, pos);
+        default:
+            break;
+        }
+        auto value = fold_float(instr->type(), lhs_value, rhs_value);
+        return value.has_value() ? insert_float(*value, pos) : nullptr;
+    }
+
+    // A branch on a constant becomes a jump, the phis of the dead successor lose an input
+    bool fold_branch(BranchInstr *branch) {
+        auto cond = int_value(branch->get_cond());
+        if (!cond.has_value()) {
+            return false;
+        }
+        auto pos = m_positions.at(branch);
+        auto *bb = pos.bb;
+        auto *taken = *cond != 0 ? bb->get_true_successor() : bb->get_false_successor();
+        auto *dead = *cond != 0 ? bb->get_false_successor() : bb->get_true_successor();
+
+        remove_incoming(bb, dead);
+        for (auto *phi : collect_instrs<PhiInstr>(*dead)) {
+            push(phi);
+        }
+
+        auto jump_it = bb->insert(std::make_unique<JumpInstr>(), pos.it);
+        m_positions.emplace(jump_it->get(), Position{bb, jump_it});
+        m_positions.erase(branch);
+        m_queued.erase(branch);
+        erase_instr(*bb, pos.it);
+        bb->set_succ_bb(taken, 0);
+        bb->set_succ_bb(nullptr, 1);
+        return true;
+    }
+
+    Instr *insert_const(i64 value, Instr *before) {
+        return insert_const(value, m_positions.at(before));
+    }
+
+    // The only value merged by phi, besides phi itself
+    static Instr *simplify_phi(Instr *instr) {
+        auto *phi = static_cast<PhiInstr *>(instr);
+        Instr *value = nullptr;
+        for (auto *operand : phi->operands()) {
+            if (operand == phi || operand == value) {
+                continue;
+            }
+            if (value != nullptr) {
+                return nullptr;
+            }
+            value = operand;
+        }
+        return value;
+    }
+
+    // Rules replacing an instruction by an equal value, an operand or a new constant
+    static const pattern::RuleSet<InstCombine> &simplify_rules() {
+        using namespace pattern;
+        static const auto rules = [] {
+            RuleSet<InstCombine> rules{};
+            rules.add(InstrType::kPhi, [](Instr *instr, InstCombine &) {
+                return simplify_phi(instr);
+            });
+            // x * 1 = x, x * 0 = 0
+            rules.add(InstrType::kMul, [](Instr *instr, InstCombine &) {
+                Instr *x = nullptr;
+                return match(instr, m_c_Mul(m_Value(x), m_ConstInt(1))) ? x : nullptr;
+            });
+            rules.add(InstrType::kMul, [](Instr *instr, InstCombine &combine) {
+                return match(instr, m_c_Mul(m_Value(), m_ConstInt(0)))
+                           ? combine.insert_const(0, instr)
+                           : nullptr;
+            });
+            // x / 1 = x
+            rules.add(InstrType::kDiv, [](Instr *instr, InstCombine &) {
+                Instr *x = nullptr;
+                return match(instr, m_Div(m_Value(x), m_ConstInt(1))) ? x : nullptr;
+            });
+            // x | x = x, x | 0 = x
+            rules.add(InstrType::kOr, [](Instr *instr, InstCombine &) {
+                Instr *x = nullptr;
+                return match(instr, m_Or(m_Value(x), m_Deferred(x))) ||
+                               match(instr, m_c_Or(m_Value(x), m_ConstInt(0)))
+                           ? x
+                           : nullptr;
+            });
+            // x << 0 = x, 0 << x = 0
+            rules.add(InstrType::kShl, [](Instr *instr, InstCombine &) {
+                Instr *x = nullptr;
+                return match(instr, m_Shl(m_Value(x), m_ConstInt(0))) ||
+                               match(instr, m_Shl(m_Bind(x, m_ConstInt(0)), m_Value()))
+                           ? x
+                           : nullptr;
+            });
+            return rules;
+        }();
+        return rules;
+    }
+
+    void replace(Instr *instr, Instr *replacement) {
+        for (auto *user : instr->users()) {
+            push(user);
+        }
+        replace_instr_uses(instr, replacement);
+        instr->clear_users();
+
+        auto pos = m_positions.at(instr);
+        m_positions.erase(instr);
+        m_queued.erase(instr);
+        erase_instr(*pos.bb, pos.it);
+    }
+
+    bool combine(Instr *instr) {
+        if (BranchInstr::classof(instr)) {
+            return m_options.fold_constants && fold_branch(static_cast<BranchInstr *>(instr));
+        }
+
+        Instr *replacement = nullptr;
+        if (m_options.fold_constants &&
+            (InstrTraits::is_binary(instr->type()) || instr->type() == InstrType::kDiv)) {
+            replacement = fold(static_cast<BinInstr *>(instr));
+        }
+        if (replacement == nullptr && m_options.simplify) {
+            replacement = simplify_rules().apply(instr, *this);
+        }
+        if (replacement == nullptr) {
+            return false;
+        }
+        replace(instr, replacement);
+        return true;
+    }
+
+  public:
+    explicit InstCombine(InstCombineOptions options = {}) : m_options(options) {}
+
+    bool apply(Function &func) {
+        m_positions.clear();
+        m_worklist.clear();
+        m_queued.clear();
+        if (func.size() == 0) {
+            return false;
+        }
+
+        auto *entry = &*func.begin();
+        auto rpo = graph::rpo(entry, graph::dfs(entry).size());
+        for (auto *bb : rpo) {
+            for (auto it = bb->begin(); it != bb->end(); ++it) {
+                m_positions.emplace(it->get(), Position{bb, it});
+            }
+        }
+        // the back of the worklist goes first
+        for (auto *bb : rpo | std::views::reverse) {
+            for (auto &instr : *bb | std::views::reverse) {
+                push(instr.get());
+            }
+        }
+
+        auto changed = false;
+        while (!m_worklist.empty()) {
+            auto *instr = m_worklist.back();
+            m_worklist.pop_back();
+            // erased while queued
+            if (!m_queued.erase(instr)) {
+                continue;
+            }
+            changed = combine(instr) || changed;
+        }
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_INST_COMBINE_HPP
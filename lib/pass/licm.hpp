@@ -0,0 +1,235 @@
+#ifndef PASS_LICM_HPP
+#define PASS_LICM_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "analysis/loop.hpp"
+#include "analysis/memory_ssa.hpp"
+#include "common.hpp"
+#include "graph/dfs.hpp"
+#include "graph/dom.hpp"
+#include "graph/rpo.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Loop-invariant code motion.
+ *
+ * Every reducible loop gets a preheader: the only block outside the loop which jumps to the
+ * header, created when the loop is entered from a branch or from several blocks. Loops are
+ * visited innermost first, so values hoisted out of an inner loop may be hoisted again out of
+ * the outer one.
+ *
+ * An instruction is invariant when none of its operands is defined in the loop. Invariant
+ * constants, binary instructions and geps are moved to the end of the preheader. Loads and
+ * checks are moved only from the blocks executed on every iteration, which dominate all the
+ * exits of the loop, or only from the header when the loop has no exits. A load is moved only
+ * when its clobbering access in analysis::MemorySSA is outside of the loop: no store or call of
+ * the loop may write the loaded memory. Hoisted loads keep the memory SSA up to date for the
+ * enclosing loops.
+ */
+class LICM final : public Pass {
+  private:
+    using block_set_t = std::unordered_set<BasicBlock *>;
+
+    std::vector<BasicBlock *> m_rpo{};
+    graph::idom_t m_idoms{};
+    block_set_t m_loop_blocks{};
+    std::unordered_set<Instr *> m_loop_instrs{};
+    analysis::AliasAnalysis m_alias{};
+    std::optional<analysis::MemorySSA> m_memory_ssa{};
+
+    static void collect_postorder(analysis::Loop *loop, std::vector<analysis::Loop *> &loops) {
+        for (auto *inner_loop : loop->inner_loops) {
+            collect_postorder(inner_loop, loops);
+        }
+        if (loop->header != nullptr) {
+            loops.push_back(loop);
+        }
+    }
+
+    static BasicBlock *create_preheader(Function &func, BasicBlock *header,
+                                       const std::vector<BasicBlock *> &outside_preds) {
+        Builder builder{};
+        builder.set_insert_point(&func);
+
+        if (outside_preds.size() == 1) {
+            auto *pred = outside_preds.front();
+            return pred->get_false_successor() == nullptr ? pred
+                                                          : builder.split_edge(pred, header);
+        }
+
+        auto *preheader = builder.create_bb();
+        builder.set_insert_point(preheader);
+
+        auto is_outside = [&outside_preds](auto *bb) {
+            return std::ranges::find(outside_preds, bb) != outside_preds.end();
+        };
+        for (auto *phi : collect_instrs<PhiInstr>(*header)) {
+            auto *preheader_phi = builder.create_phi();
+            auto &nodes = phi->get_phi_nodes();
+            for (auto it = nodes.begin(); it != nodes.end();) {
+                if (!is_outside(it->second)) {
+                    ++it;
+                    continue;
+                }
+                preheader_phi->add_incoming(it->first, it->second);
+                it->first->remove_user(phi);
+                it = nodes.erase(it);
+            }
+            phi->add_incoming(preheader_phi, preheader);
+        }
+
+        for (auto *pred : outside_preds) {
+            for (std::size_t pos = 0; pos != 2; ++pos) {
+                auto *succ = pos == 0 ? pred->get_true_successor() : pred->get_false_successor();
+                if (succ == header) {
+                    pred->set_succ_bb(preheader, pos);
+                }
+            }
+            for (auto it = std::find(header->preds_begin(), header->preds_end(), pred);
+                 it != header->preds_end();
+                 it = std::find(header->preds_begin(), header->preds_end(), pred)) {
+                header->erase_pred_bb(it);
+            }
+            preheader->emplace_back_pred_bb(pred);
+        }
+        builder.create_jump(header);
+        return preheader;
+    }
+
+    bool is_invariant(const Instr *instr) const {
+        return std::ranges::none_of(instr->operands(), [this](auto *operand) {
+            return m_loop_instrs.contains(operand);
+        });
+    }
+
+    bool can_hoist(Instr *instr, bool guaranteed) {
+        auto type = instr->type();
+        if (type == InstrType::kConst || InstrTraits::is_binary(type) || type == InstrType::kGep) {
+            return is_invariant(instr);
+        }
+        if (type == InstrType::kNullCheck || type == InstrType::kBoundCheck) {
+            return guaranteed && is_invariant(instr);
+        }
+        if (type == InstrType::kLoad) {
+            if (!guaranteed || !is_invariant(instr)) {
+                return false;
+            }
+            auto *clobber =
+                m_memory_ssa->clobbering_access(m_memory_ssa->access(instr), m_alias);
+            return clobber->bb == nullptr || !m_loop_blocks.contains(clobber->bb);
+        }
+        return false;
+    }
+
+    bool hoist(const analysis::Loop &loop, BasicBlock *preheader) {
+        m_loop_blocks = block_set_t(loop.basic_blocks.begin(), loop.basic_blocks.end());
+
+        m_loop_instrs.clear();
+        std::vector<BasicBlock *> exiting{};
+        for (auto *bb : m_loop_blocks) {
+            for (const auto &instr : *bb) {
+                m_loop_instrs.insert(instr.get());
+            }
+            for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+                if (succ != nullptr && !m_loop_blocks.contains(succ)) {
+                    exiting.push_back(bb);
+                }
+            }
+        }
+
+        auto changed = false;
+        auto insert_pos = std::prev(preheader->end());
+        for (auto *bb : m_rpo) {
+            if (!m_loop_blocks.contains(bb)) {
+                continue;
+            }
+            // only the header is known to run in a loop which never exits
+            auto guaranteed =
+                exiting.empty() ? bb == loop.header
+                                : std::ranges::all_of(exiting, [this, bb](auto *exiting_bb) {
+                                      return graph::dominates(m_idoms, bb, exiting_bb);
+                                  });
+
+            for (auto instr_it = bb->begin(); instr_it != bb->end();) {
+                auto *instr = instr_it->get();
+                auto next_it = std::next(instr_it);
+                if (can_hoist(instr, guaranteed)) {
+                    m_memory_ssa->remove(instr);
+                    preheader->splice(insert_pos, *bb, instr_it);
+                    if (LoadInstr::classof(instr)) {
+                        m_memory_ssa->insert_use(static_cast<LoadInstr *>(instr), preheader);
+                    }
+                    m_loop_instrs.erase(instr);
+                    changed = true;
+                }
+                instr_it = next_it;
+            }
+        }
+        return changed;
+    }
+
+  public:
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        auto *entry = &*func.begin();
+        auto loop_tree = analysis::loop_tree(entry);
+
+        std::vector<analysis::Loop *> loops{};
+        collect_postorder(&loop_tree.at(nullptr), loops);
+
+        auto changed = false;
+        std::vector<std::pair<analysis::Loop *, BasicBlock *>> preheaders{};
+        for (auto *loop : loops) {
+            if (!loop->reducible) {
+                continue;
+            }
+            block_set_t blocks(loop->basic_blocks.begin(), loop->basic_blocks.end());
+            std::vector<BasicBlock *> outside_preds{};
+            std::copy_if(loop->header->preds_begin(), loop->header->preds_end(),
+                         std::back_inserter(outside_preds),
+                         [&blocks](auto *pred) { return !blocks.contains(pred); });
+            if (outside_preds.empty()) {
+                continue;
+            }
+
+            auto size_before = func.size();
+            auto *preheader = create_preheader(func, loop->header, outside_preds);
+            if (func.size() != size_before) {
+                changed = true;
+                // the new block belongs to the enclosing loops
+                for (auto *outer = loop->outer_loop; outer != nullptr && outer->header != nullptr;
+                     outer = outer->outer_loop) {
+                    outer->basic_blocks.push_back(preheader);
+                }
+            }
+            preheaders.emplace_back(loop, preheader);
+        }
+
+        m_rpo = graph::rpo(entry, graph::dfs(entry).size());
+        m_idoms = graph::idom(entry);
+        m_alias.invalidate();
+        m_memory_ssa.emplace(func);
+        for (auto [loop, preheader] : preheaders) {
+            changed = hoist(*loop, preheader) || changed;
+        }
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_LICM_HPP
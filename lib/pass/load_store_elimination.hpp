@@ -0,0 +1,346 @@
+#ifndef PASS_LOAD_STORE_ELIMINATION_HPP
+#define PASS_LOAD_STORE_ELIMINATION_HPP
+
+#include <algorithm>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "analysis/alias.hpp"
+#include "common.hpp"
+#include "graph/dfs.hpp"
+#include "graph/rpo.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Store-to-load forwarding, redundant load elimination and dead store elimination.
+ *
+ * Both problems are solved over the whole function with analysis::AliasAnalysis, starting from the
+ * optimistic solution. Forward: the memory contents known on every path into a block, as pointers
+ * with the value last stored to or loaded from them; a load of a known location takes its value.
+ * Backward: the locations written on every path from a block before they are read and the allocas
+ * which are not read again before the function returns; a store to them is dead. A location is a
+ * pointer value and is forgotten above its definition, since on a back edge it is another address.
+ * Calls may read and write any memory but the allocas which do not escape.
+ */
+class LoadStoreElimination final : public Pass {
+  private:
+    // pointer -> value in memory
+    using contents_t = std::vector<std::pair<Instr *, Instr *>>;
+
+    struct DeadMemory {
+        // locations overwritten before they are read
+        std::vector<Instr *> locations{};
+        // allocas never read again
+        std::unordered_set<Instr *> objects{};
+
+        bool operator==(const DeadMemory &) const = default;
+    };
+
+    BasicBlock *m_entry = nullptr;
+    std::vector<BasicBlock *> m_rpo{};
+    std::unordered_set<Instr *> m_allocas{};
+    analysis::AliasAnalysis m_alias{};
+    // forwarded load -> its value, loaded pointers are seen through it before the rewrite
+    std::unordered_map<Instr *, Instr *> m_forwarded{};
+    // loads once found unknown stay, so that the forwarded ones only decrease between iterations
+    std::unordered_set<Instr *> m_kept{};
+    // nullopt until the block is visited
+    std::unordered_map<BasicBlock *, std::optional<contents_t>> m_contents_out{};
+    std::unordered_map<BasicBlock *, std::optional<DeadMemory>> m_dead_in{};
+
+    Instr *resolve(Instr *instr) const {
+        for (auto it = m_forwarded.find(instr); it != m_forwarded.end();
+             it = m_forwarded.find(instr)) {
+            instr = it->second;
+        }
+        return instr;
+    }
+
+    static bool may_trap(const Instr *instr) {
+        switch (instr->type()) {
+        case InstrType::kDiv:
+        case InstrType::kNullCheck:
+        case InstrType::kBoundCheck:
+        case InstrType::kUnknown:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    void kill(contents_t &contents, Instr *ptr) {
+        std::erase_if(contents, [this, ptr](const auto &content) {
+            return m_alias.may_alias(content.first, ptr);
+        });
+    }
+
+    Instr *find_value(const contents_t &contents, Instr *ptr) {
+        auto it = std::ranges::find_if(contents, [this, ptr](const auto &content) {
+            return m_alias.must_alias(content.first, ptr);
+        });
+        return it != contents.end() ? it->second : nullptr;
+    }
+
+    contents_t contents_in(BasicBlock *bb) const {
+        if (bb == m_entry) {
+            return {};
+        }
+        std::optional<contents_t> contents{};
+        for (auto pred = bb->preds_begin(), end = bb->preds_end(); pred != end; ++pred) {
+            auto it = m_contents_out.find(*pred);
+            // unreachable or not visited yet
+            if (it == m_contents_out.end() || !it->second.has_value()) {
+                continue;
+            }
+            if (!contents.has_value()) {
+                contents = *it->second;
+                continue;
+            }
+            std::erase_if(*contents, [&pred_contents = *it->second](const auto &content) {
+                return std::ranges::find(pred_contents, content) == pred_contents.end();
+            });
+        }
+        return contents.value_or(contents_t{});
+    }
+
+    // With rewrite, the loads of known values are replaced and erased
+    bool forward(BasicBlock *bb, contents_t &contents, bool rewrite) {
+        auto changed = false;
+        for (auto it = bb->begin(); it != bb->end();) {
+            auto *instr = it->get();
+            if (LoadInstr::classof(instr)) {
+                auto *ptr = resolve(static_cast<LoadInstr *>(instr)->ptr());
+                auto *value = m_kept.contains(instr) ? nullptr : find_value(contents, ptr);
+                if (value == nullptr) {
+                    contents.emplace_back(ptr, instr);
+                    m_kept.insert(instr);
+                } else if (rewrite) {
+                    replace_instr_uses(instr, value);
+                    instr->clear_users();
+                    it = erase_instr(*bb, it);
+                    changed = true;
+                    continue;
+                } else {
+                    m_forwarded[instr] = value;
+                }
+            } else if (StoreInstr::classof(instr)) {
+                auto *store = static_cast<StoreInstr *>(instr);
+                auto *ptr = resolve(store->ptr());
+                kill(contents, ptr);
+                contents.emplace_back(ptr, resolve(store->value()));
+            } else if (CallInstr::classof(instr)) {
+                std::erase_if(contents, [this](const auto &content) {
+                    return !m_alias.is_local(content.first);
+                });
+            }
+            ++it;
+        }
+        return changed;
+    }
+
+    bool forward_values() {
+        m_kept.clear();
+        m_contents_out.clear();
+        for (auto *bb : m_rpo) {
+            m_contents_out[bb] = std::nullopt;
+        }
+
+        for (bool changed = true; changed;) {
+            changed = false;
+            m_forwarded.clear();
+            for (auto *bb : m_rpo) {
+                auto contents = contents_in(bb);
+                forward(bb, contents, false);
+                if (m_contents_out[bb] != contents) {
+                    m_contents_out[bb] = std::move(contents);
+                    changed = true;
+                }
+            }
+        }
+
+        // the loads are replaced in RPO, before the pointers they produce are used
+        m_forwarded.clear();
+        auto changed = false;
+        for (auto *bb : m_rpo) {
+            auto contents = contents_in(bb);
+            changed = forward(bb, contents, true) || changed;
+        }
+        return changed;
+    }
+
+    // nullopt while no successor is visited
+    std::optional<DeadMemory> dead_out(BasicBlock *bb) const {
+        std::optional<DeadMemory> dead{};
+        auto is_exit = true;
+        for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+            if (succ == nullptr) {
+                continue;
+            }
+            is_exit = false;
+            const auto &succ_dead = m_dead_in.at(succ);
+            if (!succ_dead.has_value()) {
+                continue;
+            }
+            if (!dead.has_value()) {
+                dead = *succ_dead;
+                continue;
+            }
+            std::erase_if(dead->locations, [&succ_dead](auto *location) {
+                return std::ranges::find(succ_dead->locations, location) ==
+                       succ_dead->locations.end();
+            });
+            std::erase_if(dead->objects, [&succ_dead](auto *object) {
+                return !succ_dead->objects.contains(object);
+            });
+        }
+
+        // the stack of the function is gone after it returns
+        if (is_exit) {
+            return DeadMemory{{}, m_allocas};
+        }
+        return dead;
+    }
+
+    bool is_dead(const DeadMemory &dead, Instr *ptr) {
+        return dead.objects.contains(analysis::underlying_object(ptr)) ||
+               std::ranges::any_of(dead.locations, [this, ptr](auto *location) {
+                   return m_alias.must_alias(location, ptr);
+               });
+    }
+
+    // Memory which may be read by a call or through a pointer of unknown origin
+    void read_escaped(DeadMemory &dead) {
+        std::erase_if(dead.locations,
+                      [this](auto *location) { return !m_alias.is_local(location); });
+        std::erase_if(dead.objects, [this](auto *object) {
+            return m_alias.escapes(static_cast<AllocaInstr *>(object));
+        });
+    }
+
+    // Walks bb backwards, with rewrite the dead stores are erased
+    bool backward(BasicBlock *bb, DeadMemory &dead, bool rewrite) {
+        auto changed = false;
+        for (auto it = bb->end(); it != bb->begin();) {
+            --it;
+            auto *instr = it->get();
+            // a location defined here is another address on the paths reaching this point again
+            std::erase(dead.locations, instr);
+            if (StoreInstr::classof(instr)) {
+                auto *ptr = static_cast<StoreInstr *>(instr)->ptr();
+                if (!is_dead(dead, ptr)) {
+                    dead.locations.push_back(ptr);
+                } else if (rewrite) {
+                    it = erase_instr(*bb, it);
+                    changed = true;
+                }
+            } else if (LoadInstr::classof(instr)) {
+                auto *ptr = static_cast<LoadInstr *>(instr)->ptr();
+                std::erase_if(dead.locations, [this, ptr](auto *location) {
+                    return m_alias.may_alias(location, ptr);
+                });
+                if (auto *object = analysis::underlying_object(ptr);
+                    AllocaInstr::classof(object)) {
+                    dead.objects.erase(object);
+                } else {
+                    read_escaped(dead);
+                }
+            } else if (CallInstr::classof(instr)) {
+                read_escaped(dead);
+            } else if (may_trap(instr)) {
+                // the caller sees its memory as it was at the trap
+                std::erase_if(dead.locations, [](auto *location) {
+                    return !AllocaInstr::classof(analysis::underlying_object(location));
+                });
+            }
+        }
+        return changed;
+    }
+
+    bool eliminate_dead_stores() {
+        m_dead_in.clear();
+        for (auto *bb : m_rpo) {
+            m_dead_in[bb] = std::nullopt;
+        }
+
+        // blocks which never reach a return keep everything they store
+        std::unordered_set<BasicBlock *> reaches_exit{};
+        std::vector<BasicBlock *> worklist{};
+        for (auto *bb : m_rpo) {
+            if (bb->get_true_successor() == nullptr && bb->get_false_successor() == nullptr) {
+                reaches_exit.insert(bb);
+                worklist.push_back(bb);
+            }
+        }
+        while (!worklist.empty()) {
+            auto *bb = worklist.back();
+            worklist.pop_back();
+            for (auto pred = bb->preds_begin(), end = bb->preds_end(); pred != end; ++pred) {
+                if (m_dead_in.contains(*pred) && reaches_exit.insert(*pred).second) {
+                    worklist.push_back(*pred);
+                }
+            }
+        }
+        for (auto *bb : m_rpo) {
+            if (!reaches_exit.contains(bb)) {
+                m_dead_in[bb] = DeadMemory{};
+            }
+        }
+
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (auto *bb : m_rpo | std::views::reverse) {
+                auto dead = dead_out(bb);
+                if (!reaches_exit.contains(bb) || !dead.has_value()) {
+                    continue;
+                }
+                backward(bb, *dead, false);
+                if (m_dead_in[bb] != dead) {
+                    m_dead_in[bb] = std::move(dead);
+                    changed = true;
+                }
+            }
+        }
+
+        auto changed = false;
+        for (auto *bb : m_rpo) {
+            if (auto dead = dead_out(bb); reaches_exit.contains(bb) && dead.has_value()) {
+                changed = backward(bb, *dead, true) || changed;
+            }
+        }
+        return changed;
+    }
+
+  public:
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        m_entry = &*func.begin();
+        m_rpo = graph::rpo(m_entry, graph::dfs(m_entry).size());
+        m_allocas.clear();
+        for (auto *bb : m_rpo) {
+            for (auto *alloca : collect_instrs<AllocaInstr>(*bb)) {
+                m_allocas.insert(alloca);
+            }
+        }
+
+        m_alias.invalidate();
+        auto changed = forward_values();
+        // the forwarded loads are gone
+        m_alias.invalidate();
+        changed = eliminate_dead_stores() || changed;
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_LOAD_STORE_ELIMINATION_HPP
@@ -0,0 +1,275 @@
+#ifndef PASS_MEM2REG_HPP
+#define PASS_MEM2REG_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common.hpp"
+#include "graph/dom.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Promotion of local variables to SSA values.
+ *
+ * An alloca of one scalar which is only loaded from and stored to is replaced by the values stored
+ * into it. Phis are placed at the iterated dominance frontier of the blocks with stores, then the
+ * dominator tree is walked in preorder with the current value of every variable: loads take it,
+ * stores change it and the phis of the successors receive it. A load before any store reads zero.
+ * Phis which end up unused are removed.
+ */
+class Mem2Reg final : public Pass {
+  private:
+    struct Variable {
+        AllocaInstr *alloca;
+        // the value of the variable before any store
+        Instr *zero = nullptr;
+        // current values on the dominator tree path, the last one is visible
+        std::vector<Instr *> values{};
+    };
+
+    std::vector<Variable> m_variables{};
+    std::unordered_map<const Instr *, std::size_t> m_variable_index{};
+    std::unordered_map<PhiInstr *, std::size_t> m_phis{};
+    graph::dom_tree_t m_dom_tree{};
+
+    static bool is_promotable(const AllocaInstr *alloca,
+                              const std::unordered_set<Instr *> &reachable) {
+        if (alloca->size() != nullptr ||
+            (alloca->element_type() != Type::kInt && alloca->element_type() != Type::kFloat)) {
+            return false;
+        }
+        return std::ranges::all_of(alloca->users(), [alloca, &reachable](auto *user) {
+            if (!reachable.contains(user)) {
+                return false;
+            }
+            if (LoadInstr::classof(user)) {
+                return true;
+            }
+            return StoreInstr::classof(user) &&
+                   static_cast<StoreInstr *>(user)->value() != alloca;
+        });
+    }
+
+    // Index of the promoted variable accessed by a load or a store
+    std::optional<std::size_t> variable_of(const Instr *instr) const {
+        Instr *ptr = nullptr;
+        if (LoadInstr::classof(instr)) {
+            ptr = static_cast<const LoadInstr *>(instr)->ptr();
+        } else if (StoreInstr::classof(instr)) {
+            ptr = static_cast<const StoreInstr *>(instr)->ptr();
+        } else {
+            return std::nullopt;
+        }
+        auto it = m_variable_index.find(ptr);
+        return it != m_variable_index.end() ? std::optional<std::size_t>{it->second}
+                                            : std::nullopt;
+    }
+
+    void insert_phis(const graph::dom_frontier_t &frontiers,
+                     const std::unordered_map<Instr *, BasicBlock *> &instr_blocks) {
+        for (std::size_t i = 0; i != m_variables.size(); ++i) {
+            std::vector<BasicBlock *> def_blocks{};
+            for (auto *user : m_variables[i].alloca->users()) {
+                auto *bb = instr_blocks.at(user);
+                if (StoreInstr::classof(user) &&
+                    std::ranges::find(def_blocks, bb) == def_blocks.end()) {
+                    def_blocks.push_back(bb);
+                }
+            }
+            for (auto *bb : graph::iterated_dom_frontier(frontiers, def_blocks)) {
+                auto *phi = static_cast<PhiInstr *>(
+                    bb->insert(std::make_unique<PhiInstr>(), bb->begin())->get());
+                m_phis.emplace(phi, i);
+            }
+        }
+    }
+
+    Instr *current_value(Variable &variable, BasicBlock &entry) {
+        if (!variable.values.empty()) {
+            return variable.values.back();
+        }
+        if (variable.zero == nullptr) {
+            auto pos = std::ranges::find_if(entry, [](auto &instr) {
+                return !ArgInstr::classof(instr.get());
+            });
+            std::unique_ptr<Instr> zero{};
+            if (variable.alloca->element_type() == Type::kFloat) {
+                zero = std::make_unique<ConstInstr<double>>(0.0);
+            } else {
+                zero = std::make_unique<ConstInstr<i64>>(0);
+            }
+            variable.zero = entry.insert(std::move(zero), pos)->get();
+        }
+        return variable.zero;
+    }
+
+    void rename(BasicBlock *bb, BasicBlock &entry) {
+        std::vector<std::size_t> sizes{};
+        sizes.reserve(m_variables.size());
+        for (const auto &variable : m_variables) {
+            sizes.push_back(variable.values.size());
+        }
+
+        for (auto it = bb->begin(); it != bb->end();) {
+            auto *instr = it->get();
+            if (PhiInstr::classof(instr)) {
+                if (auto phi_it = m_phis.find(static_cast<PhiInstr *>(instr));
+                    phi_it != m_phis.end()) {
+                    m_variables[phi_it->second].values.push_back(instr);
+                }
+                ++it;
+                continue;
+            }
+
+            auto index = variable_of(instr);
+            if (!index.has_value()) {
+                ++it;
+                continue;
+            }
+            auto &variable = m_variables[*index];
+            if (LoadInstr::classof(instr)) {
+                if (!instr->users().empty()) {
+                    replace_instr_uses(instr, current_value(variable, entry));
+                    instr->clear_users();
+                }
+            } else {
+                variable.values.push_back(static_cast<StoreInstr *>(instr)->value());
+            }
+            it = erase_instr(*bb, it);
+        }
+
+        for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+            if (succ == nullptr) {
+                continue;
+            }
+            for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+                if (auto phi_it = m_phis.find(phi); phi_it != m_phis.end()) {
+                    phi->add_incoming(current_value(m_variables[phi_it->second], entry), bb);
+                }
+            }
+        }
+
+        if (auto it = m_dom_tree.find(bb); it != m_dom_tree.end()) {
+            for (auto *child : it->second) {
+                rename(child, entry);
+            }
+        }
+
+        for (std::size_t i = 0; i != m_variables.size(); ++i) {
+            m_variables[i].values.resize(sizes[i]);
+        }
+    }
+
+    // The inserted phis used by nothing but themselves and other such phis
+    void remove_dead_phis(const std::unordered_map<Instr *, BasicBlock *> &instr_blocks) {
+        std::unordered_set<PhiInstr *> live{};
+        std::vector<PhiInstr *> worklist{};
+        for (auto &[phi, _] : m_phis) {
+            auto is_inserted_phi = [this](Instr *user) {
+                return PhiInstr::classof(user) && m_phis.contains(static_cast<PhiInstr *>(user));
+            };
+            if (!std::ranges::all_of(phi->users(), is_inserted_phi)) {
+                live.insert(phi);
+                worklist.push_back(phi);
+            }
+        }
+        while (!worklist.empty()) {
+            auto *phi = worklist.back();
+            worklist.pop_back();
+            for (auto *operand : phi->operands()) {
+                if (!PhiInstr::classof(operand)) {
+                    continue;
+                }
+                auto *operand_phi = static_cast<PhiInstr *>(operand);
+                if (m_phis.contains(operand_phi) && live.insert(operand_phi).second) {
+                    worklist.push_back(operand_phi);
+                }
+            }
+        }
+
+        for (auto &[phi, _] : m_phis) {
+            if (live.contains(phi)) {
+                continue;
+            }
+            for (auto *operand : phi->operands()) {
+                operand->remove_user(phi);
+            }
+        }
+        for (auto &[phi, _] : m_phis) {
+            if (live.contains(phi)) {
+                continue;
+            }
+            auto *bb = instr_blocks.at(phi);
+            bb->erase(std::ranges::find_if(*bb, [phi](auto &instr) { return instr.get() == phi; }));
+        }
+    }
+
+  public:
+    bool apply(Function &func) {
+        m_variables.clear();
+        m_variable_index.clear();
+        m_phis.clear();
+        if (func.size() == 0) {
+            return false;
+        }
+        auto &entry = *func.begin();
+
+        auto idoms = graph::idom(&entry);
+        std::unordered_map<Instr *, BasicBlock *> instr_blocks{};
+        std::unordered_set<Instr *> reachable{};
+        for (auto &bb : func) {
+            for (auto &instr : bb) {
+                instr_blocks.emplace(instr.get(), &bb);
+                if (idoms.contains(&bb)) {
+                    reachable.insert(instr.get());
+                }
+            }
+        }
+
+        for (auto &bb : func) {
+            for (auto *alloca : collect_instrs<AllocaInstr>(bb)) {
+                if (reachable.contains(alloca) && is_promotable(alloca, reachable)) {
+                    m_variable_index.emplace(alloca, m_variables.size());
+                    m_variables.push_back({alloca});
+                }
+            }
+        }
+        if (m_variables.empty()) {
+            return false;
+        }
+
+        insert_phis(graph::dom_frontier(idoms), instr_blocks);
+        m_dom_tree = graph::idom_tree(&entry);
+        rename(&entry, entry);
+
+        instr_blocks.clear();
+        for (auto &bb : func) {
+            for (auto &instr : bb) {
+                instr_blocks[instr.get()] = &bb;
+            }
+        }
+        remove_dead_phis(instr_blocks);
+
+        for (auto &variable : m_variables) {
+            auto *bb = instr_blocks.at(variable.alloca);
+            erase_instr(*bb, std::ranges::find_if(*bb, [&variable](auto &instr) {
+                return instr.get() == variable.alloca;
+            }));
+        }
+        return true;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_MEM2REG_HPP
@@ -0,0 +1,198 @@
+#ifndef PASS_RANGE_CHECK_ELIMINATION_HPP
+#define PASS_RANGE_CHECK_ELIMINATION_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "analysis/induction.hpp"
+#include "analysis/loop.hpp"
+#include "common.hpp"
+#include "graph/dom.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Bound check elimination for induction variables.
+ *
+ * A BoundCheck in a loop on iv or iv + c, where iv is the induction variable compared in the exit
+ * condition of the header (see analysis::loop_bound), is removed when it is dominated by the
+ * body of the loop and the range of iv proves it, which needs constant init and limit.
+ *
+ * With a limit unknown at compile time the checks executed on every iteration of a loop with the
+ * header as its only exit are replaced by one check of the limit in the preheader, the block which
+ * only jumps to the header (see LICM), when iv starts at 0. The upper bounds of the checks are
+ * moved onto the limit, the lower ones have to hold for the first iteration. Such a loop fails
+ * before its first iteration instead of the one whose index is out of bounds, and any limit which
+ * does not let it run passes the check.
+ */
+class RangeCheckElimination final : public Pass {
+  private:
+    graph::idom_t m_idoms{};
+
+    struct CheckedValue {
+        BoundCheck *check;
+        BasicBlock *bb;
+        BasicBlock::iterator it;
+        // the check is on iv + offset
+        i64 offset;
+    };
+
+    static std::optional<i64> iv_offset(Instr *value, const Instr *phi) {
+        if (value == phi) {
+            return 0;
+        }
+        if (value->type() != InstrType::kAdd) {
+            return std::nullopt;
+        }
+        auto *add = static_cast<BinInstr *>(value);
+        if (add->get_lhs() == phi) {
+            return analysis::constant_value(add->get_rhs());
+        }
+        if (add->get_rhs() == phi) {
+            return analysis::constant_value(add->get_lhs());
+        }
+        return std::nullopt;
+    }
+
+    std::vector<CheckedValue> collect_checks(const analysis::Loop &loop,
+                                             const analysis::LoopBound &bound) const {
+        std::vector<CheckedValue> checks{};
+        for (auto *bb : loop.basic_blocks) {
+            if (!graph::dominates(m_idoms, bound.body, bb)) {
+                continue;
+            }
+            for (auto it = bb->begin(); it != bb->end(); ++it) {
+                if (!BoundCheck::classof(it->get())) {
+                    continue;
+                }
+                auto *check = static_cast<BoundCheck *>(it->get());
+                if (auto offset = iv_offset(check->get_check(), bound.iv.phi); offset.has_value()) {
+                    checks.push_back({check, bb, it, *offset});
+                }
+            }
+        }
+        return checks;
+    }
+
+    // The checks proven by the constant range of iv
+    static bool is_redundant(const CheckedValue &value, const analysis::ValueRange &range) {
+        auto max = std::numeric_limits<i64>::max();
+        if (value.offset > max - range.upper) {
+            return false;
+        }
+        return value.check->get_lower_bound() <= range.lower + value.offset &&
+               range.upper + value.offset <= value.check->get_upper_bound();
+    }
+
+    // Upper bound of the limit which keeps the check on every iteration passing, iv starts at 0
+    static std::optional<i64> limit_upper_bound(const CheckedValue &value,
+                                                const analysis::LoopBound &bound) {
+        auto upper = value.check->get_upper_bound();
+        if (value.offset < value.check->get_lower_bound()) {
+            return std::nullopt;
+        }
+
+        // the last iv is at most upper - offset, the next one must not wrap around
+        if (value.offset > upper) {
+            return std::nullopt;
+        }
+        auto iv_upper = upper - value.offset;
+        if (iv_upper > std::numeric_limits<i64>::max() - bound.iv.step) {
+            return std::nullopt;
+        }
+        if (bound.inclusive) {
+            return iv_upper;
+        }
+        return iv_upper != std::numeric_limits<i64>::max() ? std::optional<i64>{iv_upper + 1}
+                                                           : std::nullopt;
+    }
+
+    static bool only_exits_from_header(const analysis::Loop &loop) {
+        auto is_in_loop = [&loop](auto *bb) {
+            return bb == nullptr ||
+                   std::ranges::find(loop.basic_blocks, bb) != loop.basic_blocks.end();
+        };
+        return std::ranges::all_of(loop.basic_blocks, [&loop, &is_in_loop](auto *bb) {
+            return bb == loop.header ||
+                   (is_in_loop(bb->get_true_successor()) && is_in_loop(bb->get_false_successor()));
+        });
+    }
+
+    bool eliminate_checks(const analysis::Loop &loop) {
+        auto bound = analysis::loop_bound(loop);
+        if (!bound.has_value()) {
+            return false;
+        }
+        auto checks = collect_checks(loop, *bound);
+
+        auto changed = false;
+        if (auto range = analysis::iv_range(*bound); range.has_value()) {
+            for (const auto &value : checks) {
+                if (is_redundant(value, *range)) {
+                    erase_instr(*value.bb, value.it);
+                    changed = true;
+                }
+            }
+            return changed;
+        }
+
+        // a loop starting above 0 may not run at all for a small limit, which the check rejects
+        auto *preheader = analysis::find_preheader(loop);
+        if (preheader == nullptr || analysis::constant_value(bound->limit).has_value() ||
+            analysis::constant_value(bound->iv.init) != 0 || !only_exits_from_header(loop)) {
+            return false;
+        }
+        auto *latch = loop.latches.front();
+
+        std::optional<i64> limit_upper{};
+        for (const auto &value : checks) {
+            if (!graph::dominates(m_idoms, value.bb, latch)) {
+                continue;
+            }
+            auto upper = limit_upper_bound(value, *bound);
+            if (!upper.has_value()) {
+                continue;
+            }
+            limit_upper = std::min(limit_upper.value_or(*upper), *upper);
+            erase_instr(*value.bb, value.it);
+            changed = true;
+        }
+
+        if (limit_upper.has_value()) {
+            auto limit_check =
+                std::make_unique<BoundCheck>(bound->limit, i64{0}, limit_upper.value());
+            auto check_it = preheader->insert(std::move(limit_check), std::prev(preheader->end()));
+            bound->limit->add_user(check_it->get());
+        }
+        return changed;
+    }
+
+  public:
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        auto *entry = &*func.begin();
+        auto loop_tree = analysis::loop_tree(entry);
+        m_idoms = graph::idom(entry);
+
+        auto changed = false;
+        for (auto &[header, loop] : loop_tree) {
+            if (header != nullptr) {
+                changed = eliminate_checks(loop) || changed;
+            }
+        }
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_RANGE_CHECK_ELIMINATION_HPP
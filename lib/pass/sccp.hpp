@@ -0,0 +1,301 @@
+#ifndef PASS_SCCP_HPP
+#define PASS_SCCP_HPP
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Sparse conditional constant propagation (Wegman-Zadeck).
+ *
+ * Every value starts unknown and is only lowered to a constant or to overdefined, a block is
+ * visited once one of its incoming edges becomes executable. A phi meets its incoming values
+ * over the executable edges only, and a branch on a constant makes only one of its edges
+ * executable, so constants flow through phis and loops which a single sweep never resolves.
+ *
+ * Then the values found constant are replaced by ConstInstr, branches with a single executable
+ * edge become jumps and the blocks never reached are deleted by remove_unreachable_blocks.
+ */
+class SCCP final : public Pass {
+  private:
+    struct LatticeValue {
+        enum class Kind {
+            // no executable definition seen yet
+            kUnknown,
+            kConst,
+            kOverdefined,
+        };
+        Kind kind = Kind::kUnknown;
+        i64 value = 0;
+
+        bool operator==(const LatticeValue &rhs) const noexcept {
+            return kind == rhs.kind && (kind != Kind::kConst || value == rhs.value);
+        }
+    };
+
+    static LatticeValue overdefined() { return {LatticeValue::Kind::kOverdefined}; }
+
+    std::unordered_map<Instr *, LatticeValue> m_values;
+    // Executable edges to the true and the false successor of a block
+    std::unordered_map<BasicBlock *, std::array<bool, 2>> m_edges;
+    std::unordered_set<BasicBlock *> m_executable;
+
+    std::unordered_map<Instr *, BasicBlock *> m_instr_bb;
+
+    std::vector<std::pair<BasicBlock *, std::size_t>> m_edge_worklist;
+    std::vector<Instr *> m_instr_worklist;
+
+  public:
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        clear();
+        for (auto &bb : func) {
+            for (const auto &instr : bb) {
+                m_instr_bb.emplace(instr.get(), &bb);
+            }
+        }
+
+        auto *entry = &*func.begin();
+        mark_block(entry);
+        while (!m_edge_worklist.empty() || !m_instr_worklist.empty()) {
+            while (!m_edge_worklist.empty()) {
+                auto [bb, succ_pos] = m_edge_worklist.back();
+                m_edge_worklist.pop_back();
+                visit_edge(bb, succ_pos);
+            }
+            while (!m_instr_worklist.empty()) {
+                auto *instr = m_instr_worklist.back();
+                m_instr_worklist.pop_back();
+                if (m_executable.contains(m_instr_bb.at(instr))) {
+                    visit(instr);
+                }
+            }
+        }
+
+        auto changed = replace_constants(func);
+        changed = fold_branches(func) || changed;
+        // every edge left from an executable block is executable, so reachable means executable
+        changed = remove_unreachable_blocks(func) || changed;
+        return changed;
+    }
+
+  private:
+    void clear() {
+        m_values.clear();
+        m_edges.clear();
+        m_executable.clear();
+        m_instr_bb.clear();
+        m_edge_worklist.clear();
+        m_instr_worklist.clear();
+    }
+
+    LatticeValue get(Instr *instr) const {
+        auto it = m_values.find(instr);
+        return it != m_values.end() ? it->second : LatticeValue{};
+    }
+
+    // Values only go down the lattice, so each one changes at most twice
+    void update(Instr *instr, LatticeValue value) {
+        auto &current = m_values[instr];
+        if (current == value || current.kind == LatticeValue::Kind::kOverdefined) {
+            return;
+        }
+        current = value;
+        m_instr_worklist.append_range(instr->users());
+    }
+
+    static LatticeValue meet(LatticeValue lhs, LatticeValue rhs) {
+        if (lhs.kind == LatticeValue::Kind::kUnknown) {
+            return rhs;
+        }
+        if (rhs.kind == LatticeValue::Kind::kUnknown || lhs == rhs) {
+            return lhs;
+        }
+        return overdefined();
+    }
+
+    bool is_executable(BasicBlock *pred, BasicBlock *succ) const {
+        auto it = m_edges.find(pred);
+        if (it == m_edges.end()) {
+            return false;
+        }
+        return (it->second[0] && pred->get_true_successor() == succ) ||
+               (it->second[1] && pred->get_false_successor() == succ);
+    }
+
+    void mark_edge(BasicBlock *bb, std::size_t succ_pos) {
+        if (auto &executable = m_edges[bb][succ_pos]; !executable) {
+            executable = true;
+            m_edge_worklist.emplace_back(bb, succ_pos);
+        }
+    }
+
+    void mark_block(BasicBlock *bb) {
+        if (!m_executable.insert(bb).second) {
+            return;
+        }
+        for (const auto &instr : *bb) {
+            visit(instr.get());
+        }
+    }
+
+    void visit_edge(BasicBlock *bb, std::size_t succ_pos) {
+        auto *succ = succ_pos == 0 ? bb->get_true_successor() : bb->get_false_successor();
+        assert(succ != nullptr && "executable edge to no block");
+        if (m_executable.contains(succ)) {
+            // a new incoming edge only changes the phis
+            for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+                visit(phi);
+            }
+        } else {
+            mark_block(succ);
+        }
+    }
+
+    void visit(Instr *instr) {
+        auto type = instr->type();
+        if (InstrTraits::is_binary(type) || type == InstrType::kDiv) {
+            visit_binary(static_cast<BinInstr *>(instr));
+            return;
+        }
+
+        switch (type) {
+        case InstrType::kConst:
+            update(instr, instr->value_type() == Type::kInt
+                              ? LatticeValue{LatticeValue::Kind::kConst,
+                                             static_cast<ConstInstr<i64> *>(instr)->get_value()}
+                              : overdefined());
+            break;
+        case InstrType::kPhi: {
+            auto *phi = static_cast<PhiInstr *>(instr);
+            auto *bb = m_instr_bb.at(phi);
+            LatticeValue value{};
+            for (const auto &[incoming, pred] : phi->get_phi_nodes()) {
+                if (is_executable(pred, bb)) {
+                    value = meet(value, get(incoming));
+                }
+            }
+            update(phi, value);
+            break;
+        }
+        case InstrType::kJump:
+            mark_edge(m_instr_bb.at(instr), 0);
+            break;
+        case InstrType::kBranch: {
+            auto *bb = m_instr_bb.at(instr);
+            auto cond = get(static_cast<BranchInstr *>(instr)->get_cond());
+            if (cond.kind == LatticeValue::Kind::kConst) {
+                mark_edge(bb, cond.value != 0 ? 0 : 1);
+            } else if (cond.kind == LatticeValue::Kind::kOverdefined) {
+                mark_edge(bb, 0);
+                mark_edge(bb, 1);
+            }
+            break;
+        }
+        default:
+            // arguments, calls, memory and checks are never constant
+            if (instr->value_type() != Type::kVoid) {
+                update(instr, overdefined());
+            }
+            break;
+        }
+    }
+
+    void visit_binary(BinInstr *instr) {
+        auto lhs = get(instr->get_lhs());
+        auto rhs = get(instr->get_rhs());
+        if (lhs.kind == LatticeValue::Kind::kOverdefined ||
+            rhs.kind == LatticeValue::Kind::kOverdefined) {
+            update(instr, overdefined());
+            return;
+        }
+        if (lhs.kind == LatticeValue::Kind::kUnknown || rhs.kind == LatticeValue::Kind::kUnknown) {
+            return;
+        }
+        auto value = fold_int(instr->type(), lhs.value, rhs.value);
+        update(instr, value.has_value() ? LatticeValue{LatticeValue::Kind::kConst, *value}
+                                        : overdefined());
+    }
+
+    // The constant takes the place of the instruction, after the phis for a phi
+    bool replace_constants(Function &func) {
+        auto changed = false;
+        for (auto &bb : func) {
+            if (!m_executable.contains(&bb)) {
+                continue;
+            }
+            auto first_non_phi = std::ranges::find_if(
+                bb, [](const auto &instr) { return instr->type() != InstrType::kPhi; });
+
+            for (auto it = bb.begin(); it != bb.end();) {
+                auto *instr = it->get();
+                auto value = get(instr);
+                if (instr->type() == InstrType::kConst ||
+                    value.kind != LatticeValue::Kind::kConst) {
+                    ++it;
+                    continue;
+                }
+
+                auto pos = instr->type() == InstrType::kPhi ? first_non_phi : it;
+                auto *constant =
+                    bb.insert(std::make_unique<ConstInstr<i64>>(value.value), pos)->get();
+                m_instr_bb.emplace(constant, &bb);
+                replace_instr_uses(instr, constant);
+                instr->clear_users();
+
+                if (it == first_non_phi) {
+                    first_non_phi = std::prev(it);
+                }
+                it = erase_instr(bb, it);
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    bool fold_branches(Function &func) {
+        auto changed = false;
+        for (auto &bb : func) {
+            if (!m_executable.contains(&bb) || bb.size() == 0 ||
+                bb.get_false_successor() == nullptr) {
+                continue;
+            }
+            auto edges = m_edges[&bb];
+            if (edges[0] && edges[1]) {
+                continue;
+            }
+            assert(BranchInstr::classof(std::prev(bb.end())->get()) &&
+                   "two successors without a branch");
+
+            auto *taken = edges[0] ? bb.get_true_successor() : bb.get_false_successor();
+            auto *dead = edges[0] ? bb.get_false_successor() : bb.get_true_successor();
+            remove_incoming(&bb, dead);
+
+            erase_instr(bb, std::prev(bb.end()));
+            bb.emplace_back(std::make_unique<JumpInstr>());
+            bb.set_succ_bb(taken, 0);
+            bb.set_succ_bb(nullptr, 1);
+            changed = true;
+        }
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_SCCP_HPP
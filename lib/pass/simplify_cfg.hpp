@@ -0,0 +1,199 @@
+#ifndef PASS_SIMPLIFY_CFG_HPP
+#define PASS_SIMPLIFY_CFG_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <vector>
+
+#include "common.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Control flow graph cleanup.
+ *
+ * Repeated until nothing changes:
+ *   - the blocks which cannot be reached are deleted from the function;
+ *   - a phi with a single incoming value is replaced by it;
+ *   - the predecessors of a block holding only a jump are sent to its target directly, unless
+ *     the target already has such a predecessor with a different phi input, and the block is
+ *     deleted; a branch whose both targets become the same block turns into a jump;
+ *   - a block is merged into its predecessor when that predecessor jumps to it and nothing else
+ *     enters it.
+ *
+ * The first block of the function stays first.
+ */
+class SimplifyCFG final : public Pass {
+  private:
+    static Function::iterator find_block(Function &func, const BasicBlock *bb) {
+        auto it = std::ranges::find_if(func, [bb](auto &func_bb) { return &func_bb == bb; });
+        assert(it != func.end() && "bb is not in func");
+        return it;
+    }
+
+    static std::vector<BasicBlock *> successors(const BasicBlock *bb) {
+        std::vector<BasicBlock *> succs{};
+        for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+            if (succ != nullptr && std::ranges::find(succs, succ) == succs.end()) {
+                succs.push_back(succ);
+            }
+        }
+        return succs;
+    }
+
+    static bool fold_phis(BasicBlock &bb) {
+        auto changed = false;
+        for (auto it = bb.begin(); it != bb.end();) {
+            if (!PhiInstr::classof(it->get())) {
+                ++it;
+                continue;
+            }
+            auto *phi = static_cast<PhiInstr *>(it->get());
+            const auto &nodes = phi->get_phi_nodes();
+            if (nodes.size() != 1 || nodes.front().first == phi) {
+                ++it;
+                continue;
+            }
+            replace_instr_uses(phi, nodes.front().first);
+            phi->clear_users();
+            it = erase_instr(bb, it);
+            changed = true;
+        }
+        return changed;
+    }
+
+    static bool fold_phis(Function &func) {
+        auto changed = false;
+        for (auto &bb : func) {
+            changed = fold_phis(bb) || changed;
+        }
+        return changed;
+    }
+
+    // The value a phi of bb receives from pred, nullptr when pred does not enter bb
+    static Instr *incoming_value(PhiInstr *phi, const BasicBlock *pred) {
+        const auto &nodes = phi->get_phi_nodes();
+        auto it = std::ranges::find(nodes, pred, &PhiInstr::phi_node::second);
+        return it != nodes.end() ? it->first : nullptr;
+    }
+
+    // Redirecting pred from bb to target keeps the phis of target consistent
+    static bool can_thread(BasicBlock *pred, BasicBlock *bb, BasicBlock *target) {
+        if (std::find(target->preds_begin(), target->preds_end(), pred) == target->preds_end()) {
+            return true;
+        }
+        return std::ranges::all_of(collect_instrs<PhiInstr>(*target), [pred, bb](auto *phi) {
+            return incoming_value(phi, pred) == incoming_value(phi, bb);
+        });
+    }
+
+    static void thread(BasicBlock *pred, BasicBlock *bb, BasicBlock *target) {
+        auto phis = collect_instrs<PhiInstr>(*target);
+        for (std::size_t pos = 0; pos != 2; ++pos) {
+            if ((pos == 0 ? pred->get_true_successor() : pred->get_false_successor()) != bb) {
+                continue;
+            }
+            pred->set_succ_bb(target, pos);
+            bb->erase_pred_bb(std::find(bb->preds_begin(), bb->preds_end(), pred));
+            target->emplace_back_pred_bb(pred);
+            for (auto *phi : phis) {
+                phi->add_incoming(incoming_value(phi, bb), pred);
+            }
+        }
+
+        // both edges of the branch lead to target now
+        if (pred->get_true_successor() == target && pred->get_false_successor() == target) {
+            erase_instr(*pred, std::prev(pred->end()));
+            pred->emplace_back(std::make_unique<JumpInstr>());
+            pred->set_succ_bb(nullptr, 1);
+            remove_incoming(pred, target);
+        }
+    }
+
+    static bool thread_jumps(Function &func) {
+        auto changed = false;
+        auto *entry = &*func.begin();
+        for (auto it = func.begin(); it != func.end();) {
+            auto *bb = &*it;
+            auto *target = bb->get_true_successor();
+            if (bb == entry || bb->size() != 1 || !JumpInstr::classof(bb->begin()->get()) ||
+                target == bb) {
+                ++it;
+                continue;
+            }
+
+            std::vector<BasicBlock *> preds(bb->preds_begin(), bb->preds_end());
+            for (auto *pred : preds) {
+                if (std::find(bb->preds_begin(), bb->preds_end(), pred) != bb->preds_end() &&
+                    can_thread(pred, bb, target)) {
+                    thread(pred, bb, target);
+                    changed = true;
+                }
+            }
+            if (bb->preds_begin() != bb->preds_end()) {
+                ++it;
+                continue;
+            }
+            remove_incoming(bb, target);
+            it = func.erase(it);
+        }
+        return changed;
+    }
+
+    static bool merge_blocks(Function &func) {
+        auto changed = false;
+        auto *entry = &*func.begin();
+        for (auto &bb : func) {
+            for (auto *succ = bb.get_true_successor();
+                 succ != nullptr && bb.get_false_successor() == nullptr && succ != &bb &&
+                 succ != entry && std::distance(succ->preds_begin(), succ->preds_end()) == 1;
+                 succ = bb.get_true_successor()) {
+                fold_phis(*succ);
+
+                // the jump to succ is replaced by its instructions
+                bb.erase(std::prev(bb.end()));
+                while (succ->size() != 0) {
+                    bb.splice(bb.end(), *succ, succ->begin());
+                }
+                bb.set_succ_bb(succ->get_true_successor(), 0);
+                bb.set_succ_bb(succ->get_false_successor(), 1);
+                for (auto *next : successors(succ)) {
+                    std::replace(next->preds_begin(), next->preds_end(), succ, &bb);
+                    for (auto *phi : collect_instrs<PhiInstr>(*next)) {
+                        std::ranges::replace(phi->get_phi_nodes() | std::views::values, succ,
+                                             &bb);
+                    }
+                }
+                func.erase(find_block(func, succ));
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+  public:
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        auto changed = false;
+        for (auto progress = true; progress;) {
+            progress = remove_unreachable_blocks(func);
+            progress = fold_phis(func) || progress;
+            progress = thread_jumps(func) || progress;
+            progress = merge_blocks(func) || progress;
+            changed = changed || progress;
+        }
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_SIMPLIFY_CFG_HPP
@@ -0,0 +1,201 @@
+#ifndef PASS_STRENGTH_REDUCTION_HPP
+#define PASS_STRENGTH_REDUCTION_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "analysis/induction.hpp"
+#include "analysis/loop.hpp"
+#include "common.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+namespace injir::pass {
+
+/**
+ * @brief Strength reduction of the induction variables multiplied by a loop invariant factor.
+ *
+ * Every mul(iv, k) of a loop with a preheader and a single latch (see
+ * analysis::derived_induction_variables) is replaced by a new header phi j entered with init * k
+ * from the preheader and incremented by step * k on the back edge. The recurrence agrees with the
+ * product modulo 2^64, so it holds whatever the values.
+ *
+ * Linear function test replacement then rewrites the exit condition cmp(iv, limit) of the header
+ * into cmp(j, limit * k), which needs a constant k > 0 and a constant range of iv (see
+ * analysis::iv_range) with no product overflowing, and removes iv when the condition and its
+ * update were its only users.
+ */
+class StrengthReduction final : public Pass {
+  private:
+    struct Recurrence {
+        PhiInstr *phi;
+        // the factor when it is a constant
+        std::optional<i64> factor;
+    };
+
+    static Instr *insert_before_terminator(BasicBlock *bb, std::unique_ptr<Instr> instr) {
+        auto it = bb->insert(std::move(instr), std::prev(bb->end()));
+        for (auto *operand : it->get()->operands()) {
+            operand->add_user(it->get());
+        }
+        return it->get();
+    }
+
+    // j = phi(init * factor, j + step * factor)
+    static Recurrence create_recurrence(const analysis::Loop &loop, BasicBlock *preheader,
+                                        const analysis::InductionVariable &iv, Instr *factor) {
+        auto *latch = loop.latches.front();
+        auto factor_const = analysis::constant_value(factor);
+        auto init_const = analysis::constant_value(iv.init);
+
+        Instr *init = nullptr;
+        Instr *step = nullptr;
+        if (factor_const.has_value()) {
+            step = insert_before_terminator(
+                preheader, std::make_unique<ConstInstr<i64>>(iv.step * *factor_const));
+        } else {
+            auto *step_value =
+                insert_before_terminator(preheader, std::make_unique<ConstInstr<i64>>(iv.step));
+            step = insert_before_terminator(
+                preheader, std::make_unique<BinInstr>(InstrType::kMul, step_value, factor));
+        }
+        if (factor_const.has_value() && init_const.has_value()) {
+            init = insert_before_terminator(
+                preheader, std::make_unique<ConstInstr<i64>>(*init_const * *factor_const));
+        } else {
+            init = insert_before_terminator(
+                preheader, std::make_unique<BinInstr>(InstrType::kMul, iv.init, factor));
+        }
+
+        auto *phi = static_cast<PhiInstr *>(
+            loop.header->insert(std::make_unique<PhiInstr>(), loop.header->begin())->get());
+        auto *update = insert_before_terminator(
+            latch, std::make_unique<BinInstr>(InstrType::kAdd, phi, step));
+        phi->add_incoming(init, preheader);
+        phi->add_incoming(update, latch);
+        return {phi, factor_const};
+    }
+
+    static void erase_from(BasicBlock *bb, const Instr *instr) {
+        erase_instr(*bb, std::ranges::find_if(*bb, [instr](auto &bb_instr) {
+            return bb_instr.get() == instr;
+        }));
+    }
+
+    // cmp(iv, limit) -> cmp(j, limit * factor), iv is dead afterwards
+    static bool replace_test(const analysis::Loop &loop, BasicBlock *preheader,
+                             const analysis::LoopBound &bound, const Recurrence &recurrence) {
+        const auto &iv = bound.iv;
+        auto range = analysis::iv_range(bound);
+        auto factor = recurrence.factor;
+        if (!range.has_value() || !factor.has_value() || *factor == 0 ||
+            range->upper + iv.step > std::numeric_limits<i64>::max() / *factor) {
+            return false;
+        }
+
+        auto *cmp = static_cast<BinInstr *>(
+            std::prev(loop.header->end())->get()->operands().front());
+        auto is_removable = [&iv, cmp](const auto *user) {
+            return user == iv.update || user == cmp;
+        };
+        if (!std::ranges::all_of(iv.phi->users(), is_removable) ||
+            !std::ranges::all_of(iv.update->users(),
+                                 [&iv](const auto *user) { return user == iv.phi; })) {
+            return false;
+        }
+
+        // the values of iv reaching the header are at most range.upper + step
+        auto *limit = insert_before_terminator(
+            preheader,
+            std::make_unique<ConstInstr<i64>>(*analysis::constant_value(bound.limit) * *factor));
+        cmp->replace_operand(iv.phi, recurrence.phi);
+        cmp->replace_operand(bound.limit, limit);
+        bound.limit->remove_user(cmp);
+        recurrence.phi->add_user(cmp);
+        limit->add_user(cmp);
+
+        // iv and its update only use each other now, the cycle is cut at the phi
+        auto *latch = loop.latches.front();
+        std::erase(iv.phi->get_phi_nodes(), PhiInstr::phi_node{iv.update, latch});
+        erase_from(latch, iv.update);
+        erase_from(loop.header, iv.phi);
+        return true;
+    }
+
+    static bool reduce(const analysis::Loop &loop) {
+        auto *preheader = analysis::find_preheader(loop);
+        if (preheader == nullptr || loop.latches.size() != 1) {
+            return false;
+        }
+        auto bound = analysis::loop_bound(loop);
+
+        auto changed = false;
+        for (const auto &iv : analysis::induction_variables(loop)) {
+            if (iv.phi->value_type() != Type::kInt) {
+                continue;
+            }
+
+            std::unordered_map<Instr *, Recurrence> recurrences{};
+            std::optional<Recurrence> test_recurrence{};
+            for (const auto &derived : analysis::derived_induction_variables(loop, iv)) {
+                if (derived.factor->value_type() != Type::kInt) {
+                    continue;
+                }
+                auto it = recurrences.find(derived.factor);
+                if (it == recurrences.end()) {
+                    auto recurrence = create_recurrence(loop, preheader, iv, derived.factor);
+                    it = recurrences.emplace(derived.factor, recurrence).first;
+                    if (recurrence.factor.has_value() && *recurrence.factor != 0 &&
+                        !test_recurrence.has_value()) {
+                        test_recurrence = recurrence;
+                    }
+                }
+
+                auto *mul = derived.mul;
+                replace_instr_uses(mul, it->second.phi);
+                mul->clear_users();
+                for (auto *bb : loop.basic_blocks) {
+                    if (auto mul_it = std::ranges::find_if(
+                            *bb, [mul](auto &instr) { return instr.get() == mul; });
+                        mul_it != bb->end()) {
+                        erase_instr(*bb, mul_it);
+                        break;
+                    }
+                }
+                changed = true;
+            }
+
+            if (bound.has_value() && bound->iv.phi == iv.phi && test_recurrence.has_value() &&
+                replace_test(loop, preheader, *bound, *test_recurrence)) {
+                bound.reset();
+            }
+        }
+        return changed;
+    }
+
+  public:
+    bool apply(Function &func) {
+        if (func.size() == 0) {
+            return false;
+        }
+        auto loop_tree = analysis::loop_tree(&*func.begin());
+
+        auto changed = false;
+        for (auto &[header, loop] : loop_tree) {
+            if (header != nullptr && loop.reducible) {
+                changed = reduce(loop) || changed;
+            }
+        }
+        return changed;
+    }
+};
+
+} // namespace injir::pass
+
+#endif // PASS_STRENGTH_REDUCTION_HPP
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include "analysis/alias.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+
+using namespace injir;
+using analysis::AliasResult;
+
+class AliasTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+        builder.set_insert_point(builder.create_bb());
+
+        n = builder.create_arg(Type::kInt);
+        p = builder.create_arg(Type::kInt);
+        one = builder.create_int(1);
+        two = builder.create_int(2);
+        a = builder.create_alloca(Type::kInt, builder.create_int(4));
+        b = builder.create_alloca(Type::kInt, builder.create_int(4));
+    }
+
+    Builder builder{};
+    Function test_func{Type::kVoid, {Type::kInt, Type::kInt}};
+    Instr *n{}, *p{}, *one{}, *two{}, *a{}, *b{};
+};
+
+TEST_F(AliasTest, Allocas) {
+    EXPECT_EQ(analysis::alias(a, a), AliasResult::kMustAlias);
+    EXPECT_EQ(analysis::alias(a, b), AliasResult::kNoAlias);
+    EXPECT_EQ(analysis::alias(builder.create_gep(a, n), b), AliasResult::kNoAlias);
+
+    // pointers of unknown origin
+    EXPECT_EQ(analysis::alias(a, p), AliasResult::kMayAlias);
+    EXPECT_EQ(analysis::alias(n, p), AliasResult::kMayAlias);
+}
+
+TEST_F(AliasTest, ConstantOffsets) {
+    auto *a1 = builder.create_gep(a, one);
+    auto *a2 = builder.create_gep(a, two);
+    auto *a1_1 = builder.create_gep(a1, one);
+
+    EXPECT_EQ(analysis::alias(a1, builder.create_gep(a, one)), AliasResult::kMustAlias);
+    EXPECT_EQ(analysis::alias(a1, a2), AliasResult::kNoAlias);
+    EXPECT_EQ(analysis::alias(a, a1), AliasResult::kNoAlias);
+    EXPECT_EQ(analysis::alias(a1_1, a2), AliasResult::kMustAlias);
+
+    auto decomposed = analysis::decompose(a1_1);
+    EXPECT_EQ(decomposed.base, a);
+    EXPECT_EQ(decomposed.offset, 2);
+
+    // the same base works for arguments too
+    EXPECT_EQ(analysis::alias(builder.create_gep(p, one), builder.create_gep(p, two)),
+              AliasResult::kNoAlias);
+}
+
+TEST_F(AliasTest, UnknownOffsets) {
+    auto *an = builder.create_gep(a, n);
+    EXPECT_EQ(analysis::alias(an, builder.create_gep(a, one)), AliasResult::kMayAlias);
+    EXPECT_EQ(analysis::alias(an, builder.create_gep(a, n)), AliasResult::kMayAlias);
+    EXPECT_FALSE(analysis::decompose(builder.create_gep(an, one)).offset.has_value());
+    EXPECT_EQ(analysis::underlying_object(builder.create_gep(an, one)), a);
+}
+
+TEST_F(AliasTest, Escapes) {
+    auto *local = builder.create_alloca(Type::kInt);
+    auto *escaped = builder.create_alloca(Type::kInt);
+    auto *local1 = builder.create_gep(local, one);
+    builder.create_store(local1, n);
+    builder.create_load(local);
+    builder.create_store(p, builder.create_gep(escaped, one));
+    auto *loaded = builder.create_load(p);
+
+    analysis::AliasAnalysis alias_analysis{};
+    EXPECT_FALSE(alias_analysis.escapes(static_cast<AllocaInstr *>(local)));
+    EXPECT_TRUE(alias_analysis.escapes(static_cast<AllocaInstr *>(escaped)));
+    EXPECT_TRUE(alias_analysis.is_local(local1));
+
+    // the address of local is known to this function only
+    EXPECT_EQ(alias_analysis.alias(local1, p), AliasResult::kNoAlias);
+    EXPECT_EQ(alias_analysis.alias(loaded, local), AliasResult::kNoAlias);
+    EXPECT_EQ(alias_analysis.alias(escaped, p), AliasResult::kMayAlias);
+    EXPECT_EQ(alias_analysis.alias(loaded, escaped), AliasResult::kMayAlias);
+    EXPECT_EQ(alias_analysis.alias(p, loaded), AliasResult::kMayAlias);
+
+    // the structural answers stay
+    EXPECT_EQ(alias_analysis.alias(local1, builder.create_gep(local, one)),
+              AliasResult::kMustAlias);
+    EXPECT_EQ(alias_analysis.alias(local, local1), AliasResult::kNoAlias);
+    EXPECT_EQ(alias_analysis.alias(local, escaped), AliasResult::kNoAlias);
+
+    // cached until invalidated
+    builder.create_call(&test_func, {n, local});
+    EXPECT_EQ(alias_analysis.alias(local1, p), AliasResult::kNoAlias);
+    alias_analysis.invalidate();
+    EXPECT_TRUE(alias_analysis.escapes(static_cast<AllocaInstr *>(local)));
+    EXPECT_EQ(alias_analysis.alias(local1, p), AliasResult::kMayAlias);
+}
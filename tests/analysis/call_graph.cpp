@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include "analysis/call_graph.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+
+using namespace injir;
+
+class CallGraphTest : public ::testing::Test {
+  protected:
+    void build(Function &func, std::initializer_list<Function *> callees) {
+        builder.set_insert_point(&func);
+        builder.set_insert_point(builder.create_bb());
+        auto *arg = builder.create_arg(Type::kInt);
+        for (auto *callee : callees) {
+            builder.create_call(callee, {arg});
+        }
+        builder.create_ret(arg);
+    }
+
+    Builder builder{};
+    Function main_func{Type::kInt, {Type::kInt}};
+    Function func_a{Type::kInt, {Type::kInt}};
+    Function func_b{Type::kInt, {Type::kInt}};
+    Function func_c{Type::kInt, {Type::kInt}};
+    Function func_d{Type::kInt, {Type::kInt}};
+};
+
+TEST_F(CallGraphTest, SCC) {
+    // main -> a <-> b -> c, c -> c, d is not called
+    build(main_func, {&func_a, &func_a});
+    build(func_a, {&func_b});
+    build(func_b, {&func_a, &func_c});
+    build(func_c, {&func_c});
+    build(func_d, {&main_func});
+
+    auto graph = analysis::call_graph(&main_func);
+    ASSERT_EQ(graph.size(), 4);
+    EXPECT_EQ(graph.at(&main_func), std::vector<Function *>{&func_a});
+    EXPECT_EQ(graph.at(&func_b), (std::vector<Function *>{&func_a, &func_c}));
+
+    auto sccs = analysis::sccs_bottom_up(&main_func, graph);
+    ASSERT_EQ(sccs.size(), 3);
+    EXPECT_EQ(sccs[0], std::vector<Function *>{&func_c});
+    EXPECT_TRUE(std::ranges::is_permutation(sccs[1], std::vector<Function *>{&func_a, &func_b}));
+    EXPECT_EQ(sccs[2], std::vector<Function *>{&main_func});
+
+    EXPECT_TRUE(analysis::is_recursive(&func_c, sccs[0], graph));
+    EXPECT_TRUE(analysis::is_recursive(&func_a, sccs[1], graph));
+    EXPECT_FALSE(analysis::is_recursive(&main_func, sccs[2], graph));
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "analysis/allocator.hpp"
+#include "analysis/graph_coloring.hpp"
+#include "analysis/lifetime.hpp"
+#include "analysis/loop.hpp"
+#include "analysis/regalloc.hpp"
+
+#include "fixtures.hpp"
+#include "regalloc_checks.hpp"
+
+using namespace injir::analysis;
+
+TEST_F(CFGLifeTimePaperExample, GraphColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (std::size_t regs_num : {1, 2, 3, 4}) {
+        GraphColoring alloc(regs_num, lt);
+        check_coloring(alloc, lt);
+        EXPECT_LE(spills_num(alloc, lt),
+                  spills_num(LinearScan(regs_num, lt, {}, {.rematerialize = false}), lt));
+    }
+
+    // With enough registers every phi is coalesced with its incoming values
+    GraphColoring alloc(4, lt);
+    EXPECT_EQ(spills_num(alloc, lt), 0);
+    EXPECT_EQ(alloc.get_register(r12), alloc.get_register(r14));
+    EXPECT_EQ(alloc.get_register(r13), alloc.get_register(r11));
+    EXPECT_EQ(alloc.get_register(r13), alloc.get_register(r15));
+}
+
+TEST_F(CFGLifeTimeNestedLoops, GraphColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (std::size_t regs_num : {1, 2, 3}) {
+        GraphColoring alloc(regs_num, lt);
+        check_coloring(alloc, lt);
+        EXPECT_LE(spills_num(alloc, lt),
+                  spills_num(LinearScan(regs_num, lt, {}, {.rematerialize = false}), lt));
+    }
+}
+
+TEST_F(CFGRegAllocSpillSlots, GraphColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    GraphColoring alloc(1, lt);
+    check_coloring(alloc, lt);
+    EXPECT_LE(alloc.get_spill_slots_num(), 2);
+}
+
+TEST_F(CFGRegAllocMixedTypes, GraphColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    GraphColoring alloc({2, 2}, lt);
+    check_coloring(alloc, lt);
+    EXPECT_EQ(spills_num(alloc, lt), 0);
+}
+
+TEST_F(CFGLifeTimePaperExample, MakeRegisterAllocator) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (auto kind : {RegAllocKind::kLinearScan, RegAllocKind::kGraphColoring}) {
+        auto alloc = make_register_allocator(kind, {3, 3}, lt);
+        ASSERT_NE(alloc, nullptr);
+        check_coloring(*alloc, lt);
+    }
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <memory>
+
+#include "analysis/induction.hpp"
+#include "analysis/loop.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+
+using namespace injir;
+
+// fact(n): i = 2, res = 1; while (i <= n) { i = i + 1; res = res * i; } return res;
+class FactorialLoop : public ::testing::Test {
+  protected:
+    void build(Instr *(*limit)(Builder &, Instr *)) {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        bb_cond = builder.create_bb();
+        bb_loop = builder.create_bb();
+        bb_ret = builder.create_bb();
+
+        builder.set_insert_point(bb_entry);
+        auto *n = builder.create_arg(Type::kInt);
+        auto *one = builder.create_int(1);
+        auto *two = builder.create_int(2);
+        auto *bound = limit(builder, n);
+        builder.create_jump(bb_cond);
+
+        builder.set_insert_point(bb_cond);
+        i = builder.create_phi();
+        res = builder.create_phi();
+        auto *cond = builder.create_cmp_le(i, bound);
+        builder.create_br(cond, bb_loop, bb_ret);
+
+        builder.set_insert_point(bb_loop);
+        inc = builder.create_add(i, one);
+        auto *mul = builder.create_mul(res, inc);
+        builder.create_jump(bb_cond);
+
+        builder.set_insert_point(bb_ret);
+        builder.create_ret(res);
+
+        i->add_incoming(two, bb_entry);
+        i->add_incoming(inc, bb_loop);
+        res->add_incoming(one, bb_entry);
+        res->add_incoming(mul, bb_loop);
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_entry{}, *bb_cond{}, *bb_loop{}, *bb_ret{};
+    PhiInstr *i{}, *res{};
+    BinInstr *inc{};
+};
+
+TEST_F(FactorialLoop, InductionVariables) {
+    build([](Builder &, Instr *n) { return n; });
+
+    auto loop_tree = analysis::loop_tree(bb_entry);
+    auto ivs = analysis::induction_variables(loop_tree.at(bb_cond));
+
+    // res is multiplied
+    ASSERT_EQ(ivs.size(), 1);
+    EXPECT_EQ(ivs.front().phi, i);
+    EXPECT_EQ(ivs.front().update, inc);
+    EXPECT_EQ(ivs.front().step, 1);
+    EXPECT_EQ(analysis::constant_value(ivs.front().init), 2);
+}
+
+TEST_F(FactorialLoop, UnknownLimit) {
+    build([](Builder &, Instr *n) { return n; });
+
+    auto loop_tree = analysis::loop_tree(bb_entry);
+    auto bound = analysis::loop_bound(loop_tree.at(bb_cond));
+
+    ASSERT_TRUE(bound.has_value());
+    EXPECT_EQ(bound->iv.phi, i);
+    EXPECT_EQ(bound->limit, test_func.begin()->begin()->get());
+    EXPECT_TRUE(bound->inclusive);
+    EXPECT_EQ(bound->body, bb_loop);
+    EXPECT_FALSE(analysis::iv_range(*bound).has_value());
+}
+
+TEST_F(FactorialLoop, ConstantLimit) {
+    build([](Builder &builder, Instr *) -> Instr * { return builder.create_int(20); });
+
+    auto loop_tree = analysis::loop_tree(bb_entry);
+    auto bound = analysis::loop_bound(loop_tree.at(bb_cond));
+    ASSERT_TRUE(bound.has_value());
+
+    auto range = analysis::iv_range(*bound);
+    ASSERT_TRUE(range.has_value());
+    EXPECT_EQ(range->lower, 2);
+    EXPECT_EQ(range->upper, 20);
+}
+
+TEST_F(FactorialLoop, WrapAround) {
+    build([](Builder &builder, Instr *) -> Instr * {
+        return builder.create_int(std::numeric_limits<i64>::max());
+    });
+
+    // i <= max holds for every i
+    auto loop_tree = analysis::loop_tree(bb_entry);
+    auto bound = analysis::loop_bound(loop_tree.at(bb_cond));
+    ASSERT_TRUE(bound.has_value());
+    EXPECT_FALSE(analysis::iv_range(*bound).has_value());
+}
+
+TEST_F(FactorialLoop, DerivedInductionVariables) {
+    build([](Builder &, Instr *n) { return n; });
+    auto *n = test_func.begin()->begin()->get();
+
+    // i * n and i * i before the jump of the body
+    auto add_mul = [this](Instr *lhs, Instr *rhs) {
+        auto it = bb_loop->insert(std::make_unique<BinInstr>(InstrType::kMul, lhs, rhs),
+                                  std::prev(bb_loop->end()));
+        lhs->add_user(it->get());
+        rhs->add_user(it->get());
+        return it->get();
+    };
+    auto *scaled = add_mul(n, i);
+    add_mul(i, i);
+
+    auto loop_tree = analysis::loop_tree(bb_entry);
+    const auto &loop = loop_tree.at(bb_cond);
+    auto ivs = analysis::induction_variables(loop);
+    ASSERT_EQ(ivs.size(), 1);
+
+    // res * inc is not a multiple of i, i * i has no invariant factor
+    auto derived = analysis::derived_induction_variables(loop, ivs.front());
+    ASSERT_EQ(derived.size(), 1);
+    EXPECT_EQ(derived.front().mul, scaled);
+    EXPECT_EQ(derived.front().factor, n);
+}
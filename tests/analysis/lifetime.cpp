@@ -163,3 +163,13 @@ TEST_F(CFGLifeTimeNestedLoops, LIFETIME) {
         {r4, {{14, 20}}}, {r5, {{16, 26}}}, {r6, {{20, 22}}}, {r7, {{22, 24}}}};
     check_lifetime(std::move(lifetime), std::move(expected_lifetimes));
 }
+
+TEST_F(CFGLifeTimeNestedLoops, LoopDepth) {
+    analysis::LifeTime lifetime{bb_a, analysis::loop_tree(bb_a), basic_block_counter};
+
+    std::unordered_map<BasicBlock *, std::size_t> expected{{bb_a, 0}, {bb_b, 1}, {bb_c, 2},
+                                                           {bb_d, 2}, {bb_e, 1}, {bb_f, 0}};
+    for (auto [bb, depth] : expected) {
+        EXPECT_EQ(lifetime.get_loop_depth(bb), depth);
+    }
+}
@@ -177,3 +177,33 @@ TEST_F(CFGLoopManyLathes, LOOP) {
     expected[nullptr].inner_loops.push_back(&expected[bb_b]);
     check_loop_tree(loop_tree, expected);
 }
+
+TEST(LoopTest, SelfLoop) {
+    Function test_func{Type::kVoid, {}};
+    Builder builder{};
+    builder.set_insert_point(&test_func);
+
+    auto *bb_a = builder.create_bb();
+    auto *bb_b = builder.create_bb();
+    auto *bb_c = builder.create_bb();
+
+    builder.set_insert_point(bb_a);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    builder.create_br(builder.create_int(1), bb_b, bb_c);
+
+    auto loop_tree = analysis::loop_tree(bb_a);
+    analysis::loop_tree_t expected{{nullptr, {.basic_blocks = {bb_a, bb_c}}}};
+
+    expected[bb_b] = {
+        .header = bb_b,
+        .latches = {bb_b},
+        .basic_blocks = {bb_b},
+        .reducible = true,
+        .outer_loop = &expected[nullptr],
+    };
+
+    expected[nullptr].inner_loops.push_back(&expected[bb_b]);
+    check_loop_tree(loop_tree, expected);
+}
@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include "analysis/alias.hpp"
+#include "analysis/memory_ssa.hpp"
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+
+using namespace injir;
+using analysis::MemoryAccess;
+using analysis::MemoryAccessKind;
+
+class MemorySSATest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+        bb_d = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        n = builder.create_arg(Type::kInt);
+        p = builder.create_arg(Type::kInt);
+        one = builder.create_int(1);
+        a = builder.create_alloca(Type::kInt, builder.create_int(4));
+    }
+
+    static MemoryAccess *incoming_from(const MemoryAccess *phi, const BasicBlock *bb) {
+        auto it = std::ranges::find_if(
+            phi->incoming, [bb](const auto &incoming) { return incoming.second == bb; });
+        return it != phi->incoming.end() ? it->first : nullptr;
+    }
+
+    Builder builder{};
+    Function callee{Type::kVoid, {Type::kInt}};
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{}, *bb_d{};
+    Instr *n{}, *p{}, *one{}, *a{};
+};
+
+/*
+ *      A  store a
+ *     / \
+ *    B   C        B: store p, C: load a
+ *     \ /
+ *      D  load a, call, load p
+ */
+TEST_F(MemorySSATest, Diamond) {
+    auto *store_a = builder.create_store(a, one);
+    builder.create_br(n, bb_b, bb_c);
+    builder.set_insert_point(bb_b);
+    auto *store_p = builder.create_store(p, n);
+    builder.create_jump(bb_d);
+    builder.set_insert_point(bb_c);
+    auto *load_c = builder.create_load(a);
+    builder.create_jump(bb_d);
+    builder.set_insert_point(bb_d);
+    auto *load_d = builder.create_load(a);
+    auto *call = builder.create_call(&callee, {n});
+    auto *load_p = builder.create_load(p);
+    builder.create_ret(n);
+
+    analysis::MemorySSA memory_ssa{test_func};
+    auto *def_a = memory_ssa.access(store_a);
+    auto *def_p = memory_ssa.access(store_p);
+    auto *def_call = memory_ssa.access(call);
+    auto *phi = memory_ssa.phi(bb_d);
+
+    EXPECT_EQ(def_a->kind, MemoryAccessKind::kDef);
+    EXPECT_EQ(def_a->defining, memory_ssa.live_on_entry());
+    EXPECT_EQ(def_p->defining, def_a);
+    EXPECT_EQ(memory_ssa.access(load_c)->kind, MemoryAccessKind::kUse);
+    EXPECT_EQ(memory_ssa.access(load_c)->defining, def_a);
+    EXPECT_EQ(memory_ssa.access(n), nullptr);
+
+    ASSERT_NE(phi, nullptr);
+    EXPECT_EQ(memory_ssa.phi(bb_b), nullptr);
+    EXPECT_EQ(memory_ssa.phi(bb_c), nullptr);
+    EXPECT_EQ(phi->incoming.size(), 2);
+    EXPECT_EQ(incoming_from(phi, bb_b), def_p);
+    EXPECT_EQ(incoming_from(phi, bb_c), def_a);
+    EXPECT_EQ(memory_ssa.access(load_d)->defining, phi);
+    EXPECT_EQ(def_call->defining, phi);
+    EXPECT_EQ(memory_ssa.access(load_p)->defining, def_call);
+
+    EXPECT_EQ(std::ranges::count(def_a->users, phi), 1);
+    EXPECT_EQ(std::ranges::count(def_a->users, def_p), 1);
+    EXPECT_EQ(memory_ssa.block_accesses(bb_d).size(), 3);
+
+    // a does not escape, so neither the store to p nor the call writes it
+    analysis::AliasAnalysis alias_analysis{};
+    EXPECT_EQ(memory_ssa.clobbering_access(memory_ssa.access(load_d), alias_analysis), def_a);
+    EXPECT_EQ(memory_ssa.clobbering_access(memory_ssa.access(load_p), alias_analysis),
+              def_call);
+}
+
+TEST_F(MemorySSATest, Loop) {
+    auto *store_a = builder.create_store(a, one);
+    builder.create_jump(bb_b);
+    builder.set_insert_point(bb_b);
+    auto *load_a = builder.create_load(a);
+    auto *load_p = builder.create_load(p);
+    builder.create_br(n, bb_c, bb_d);
+    builder.set_insert_point(bb_c);
+    auto *store_p = builder.create_store(p, load_a);
+    builder.create_jump(bb_b);
+    builder.set_insert_point(bb_d);
+    builder.create_ret(n);
+
+    analysis::MemorySSA memory_ssa{test_func};
+    auto *phi = memory_ssa.phi(bb_b);
+    ASSERT_NE(phi, nullptr);
+    EXPECT_EQ(incoming_from(phi, bb_a), memory_ssa.access(store_a));
+    EXPECT_EQ(incoming_from(phi, bb_c), memory_ssa.access(store_p));
+    EXPECT_EQ(memory_ssa.access(store_p)->defining, phi);
+    EXPECT_EQ(memory_ssa.access(load_a)->defining, phi);
+
+    // the store of the loop writes p only, the phi is looked through
+    analysis::AliasAnalysis alias_analysis{};
+    EXPECT_EQ(memory_ssa.clobbering_access(memory_ssa.access(load_a), alias_analysis),
+              memory_ssa.access(store_a));
+    EXPECT_EQ(memory_ssa.clobbering_access(memory_ssa.access(load_p), alias_analysis), phi);
+}
+
+TEST_F(MemorySSATest, LoopClobber) {
+    builder.create_store(a, one);
+    builder.create_jump(bb_b);
+    builder.set_insert_point(bb_b);
+    auto *load_a = builder.create_load(a);
+    auto *load_p = builder.create_load(p);
+    builder.create_br(n, bb_c, bb_d);
+    builder.set_insert_point(bb_c);
+    builder.create_store(builder.create_gep(a, n), load_a);
+    builder.create_jump(bb_b);
+    builder.set_insert_point(bb_d);
+    builder.create_ret(n);
+
+    analysis::MemorySSA memory_ssa{test_func};
+    analysis::AliasAnalysis alias_analysis{};
+    EXPECT_EQ(memory_ssa.clobbering_access(memory_ssa.access(load_a), alias_analysis),
+              memory_ssa.phi(bb_b));
+    // p may point into anything but a
+    EXPECT_EQ(memory_ssa.clobbering_access(memory_ssa.access(load_p), alias_analysis),
+              memory_ssa.live_on_entry());
+}
+
+TEST_F(MemorySSATest, Update) {
+    auto *store_a = builder.create_store(a, one);
+    builder.create_br(n, bb_b, bb_c);
+    builder.set_insert_point(bb_b);
+    auto *store_p = builder.create_store(p, n);
+    builder.create_jump(bb_d);
+    builder.set_insert_point(bb_c);
+    auto *load = builder.create_load(a);
+    builder.create_jump(bb_d);
+    builder.set_insert_point(bb_d);
+    auto *load_d = builder.create_load(p);
+    builder.create_ret(n);
+
+    analysis::MemorySSA memory_ssa{test_func};
+    auto *def_a = memory_ssa.access(store_a);
+    auto *phi = memory_ssa.phi(bb_d);
+
+    // move the load of C before the terminator of B
+    memory_ssa.remove(load);
+    EXPECT_EQ(memory_ssa.access(load), nullptr);
+    EXPECT_EQ(def_a->users.size(), 2);
+    auto load_it =
+        std::ranges::find_if(*bb_c, [load](auto &instr) { return instr.get() == load; });
+    bb_b->splice(std::prev(bb_b->end()), *bb_c, load_it);
+    auto *use = memory_ssa.insert_use(static_cast<LoadInstr *>(load), bb_b);
+    EXPECT_EQ(use->defining, memory_ssa.access(store_p));
+    EXPECT_EQ(memory_ssa.block_accesses(bb_b).back(), use);
+
+    // the readers of a removed def read its defining state
+    memory_ssa.remove(store_p);
+    EXPECT_EQ(use->defining, def_a);
+    EXPECT_EQ(incoming_from(phi, bb_b), def_a);
+    EXPECT_EQ(std::ranges::count(def_a->users, phi), 2);
+    EXPECT_EQ(std::ranges::count(def_a->users, use), 1);
+    EXPECT_EQ(memory_ssa.block_accesses(bb_b).size(), 1);
+
+    // D has no defs, a load appended to it reads the phi
+    builder.set_insert_point(bb_d);
+    auto *new_load = builder.create_load(a);
+    auto *new_use = memory_ssa.insert_use(static_cast<LoadInstr *>(new_load), bb_d);
+    EXPECT_EQ(new_use->defining, phi);
+    EXPECT_EQ(memory_ssa.block_accesses(bb_d).front(), memory_ssa.access(load_d));
+    EXPECT_EQ(memory_ssa.block_accesses(bb_d).back(), new_use);
+    EXPECT_EQ(memory_ssa.state_in(bb_c), def_a);
+}
@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "analysis/lifetime.hpp"
 #include "analysis/loop.hpp"
+#include "analysis/parallel_copy.hpp"
 #include "analysis/regalloc.hpp"
 
 #include "fixtures.hpp"
@@ -31,7 +33,8 @@ TEST_F(CFGLifeTimeSimpleExample, REGALLOC) {
 TEST_F(CFGLifeTimePaperExample, RegsAllocExact) {
     auto loop_tree = injir::analysis::loop_tree(bb_a);
     injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
-    injir::analysis::LinearScan alloc(3, lt);
+    injir::analysis::LinearScan alloc(3, lt, {},
+                                      {.rematerialize = false, .spill_weights = false});
 
     check_regalloc(alloc, {{r11, 2}, {r13, 2}, {r14, 0}, {r15, 1}, {r20, 0}, {r21, 0}, {r24, 1}},
                    {{r10, 0}, {r12, 1}});
@@ -44,3 +47,304 @@ TEST_F(CFGLifeTimeNestedLoops, REGALLOC) {
     check_regalloc(alloc, {{r0, 0}, {r1, 0}, {r2, 0}, {r3, 1}, {r4, 2}, {r5, 0}, {r6, 1}, {r7, 1}},
                    {});
 }
+
+TEST_F(CFGRegAllocSpillSlots, SpillSlotsReuse) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc(1, lt, {},
+                                      {.rematerialize = false, .spill_weights = false});
+
+    // r3 and r5 do not overlap and share one stack slot
+    check_regalloc(alloc, {{r1, 0}, {r2, 0}, {r4, 0}, {r6, 0}}, {{r0, 0}, {r3, 1}, {r5, 1}});
+
+    EXPECT_EQ(alloc.get_spill_slots_num(), 2);
+    EXPECT_EQ(alloc.get_frame_size(), 2 * injir::analysis::LinearScan::kSpillSlotSize);
+}
+
+TEST_F(CFGRegAllocMixedTypes, RegClasses) {
+    using injir::analysis::RegClass;
+
+    for (auto *instr : {r0, r1, r4, r6}) {
+        EXPECT_EQ(injir::analysis::reg_class(instr), RegClass::kInt);
+    }
+    for (auto *instr : {r2, r3, r5, r7}) {
+        EXPECT_EQ(injir::analysis::reg_class(instr), RegClass::kFloat);
+    }
+}
+
+TEST_F(CFGRegAllocMixedTypes, SeparatePools) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc({2, 2}, lt);
+
+    // Four values are live at once, but only two of them in each class
+    check_regalloc(alloc, {{r0, 0}, {r1, 1}, {r4, 1}, {r2, 0}, {r3, 1}, {r5, 1}}, {});
+    EXPECT_EQ(alloc.get_spill_slots_num(), 0);
+}
+
+TEST_F(CFGRegAllocMixedTypes, NoFloatRegisters) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc({2, 0}, lt, {}, {.rematerialize = false});
+
+    check_regalloc(alloc, {{r0, 0}, {r1, 1}, {r4, 1}}, {{r2, 0}, {r3, 1}, {r5, 1}});
+    EXPECT_EQ(alloc.get_spill_slots_num(), 2);
+}
+
+TEST(RegisterSet, TakeFirst) {
+    auto set = injir::analysis::RegisterSet::all(70);
+    EXPECT_FALSE(set.contains(70));
+
+    for (std::size_t reg = 0; reg != 70; ++reg) {
+        EXPECT_EQ(set.take_first(), reg);
+    }
+    EXPECT_TRUE(set.empty());
+
+    set.insert(65);
+    set.insert(3);
+    EXPECT_TRUE(set.contains(65));
+    EXPECT_EQ(set.take_first(), 3);
+    EXPECT_EQ(set.take_first(), 65);
+    EXPECT_TRUE(set.empty());
+}
+
+TEST_F(CFGRegAllocSpillSlots, ManyRegisters) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc(100, lt);
+
+    // The lowest free register is always taken, so few values never leave the first word
+    for (const auto &[instr, _] : lt) {
+        ASSERT_TRUE(alloc.get_register(instr).has_value());
+        EXPECT_LT(*alloc.get_register(instr), 64);
+    }
+    EXPECT_EQ(alloc.get_spill_slots_num(), 0);
+}
+
+// Integer registers 0 and 1 pass arguments and are clobbered by calls, 0 also returns
+static injir::analysis::CallingConvention test_convention() {
+    injir::analysis::CallingConvention convention{};
+    auto &int_conv = convention.classes[static_cast<std::size_t>(injir::analysis::RegClass::kInt)];
+    int_conv.arg_regs = {0, 1};
+    int_conv.ret_reg = 0;
+    int_conv.caller_saved = {0, 1};
+    return convention;
+}
+
+// Run the fixed copies of a call: the arguments must reach their registers, the values live
+// across the call must survive the clobber of the caller-saved registers, and the result must
+// reach its location
+static void check_call(const injir::analysis::LinearScan &alloc,
+                       const injir::analysis::LifeTime &lt, CallInstr *call, std::size_t point,
+                       const std::vector<std::size_t> &caller_saved) {
+    using injir::analysis::LifeTime;
+    using injir::analysis::Location;
+    using injir::analysis::Move;
+
+    std::vector<std::pair<Location, Instr *>> state{};
+    auto at = [&state](const Location &loc) -> Instr *& {
+        auto it = std::ranges::find(state, loc, &std::pair<Location, Instr *>::first);
+        if (it == state.end()) {
+            state.emplace_back(loc, nullptr);
+            return state.back().second;
+        }
+        return it->second;
+    };
+    auto run = [&at](const std::vector<Move> &moves) {
+        for (const auto &move : moves) {
+            if (move.kind == Move::Kind::kMove) {
+                at(move.to) = at(move.from);
+            } else {
+                std::swap(at(move.to), at(move.from));
+            }
+        }
+    };
+
+    std::vector<Instr *> crossing{};
+    for (const auto &[value, ranges] : lt) {
+        auto start = std::ranges::min(ranges).first;
+        auto end = std::ranges::max(ranges, {}, &LifeTime::life_range_t::second).second;
+        if (start < point && point <= end) {
+            at(*alloc.get_location(value)) = value;
+        }
+        if (start < point && point < end) {
+            crossing.push_back(value);
+        }
+    }
+
+    auto copies = alloc.get_fixed_copies(call).value_or(injir::analysis::LinearScan::FixedCopies{});
+    run(injir::analysis::sequentialize(copies.before));
+
+    auto &args = call->get_args();
+    for (std::size_t i = 0; i != args.size(); ++i) {
+        EXPECT_EQ(at({Location::Kind::Register, i}), args[i]);
+    }
+    for (auto *value : crossing) {
+        auto location = *alloc.location_at(value, point);
+        EXPECT_EQ(at(location), value);
+        EXPECT_FALSE(location.kind == Location::Kind::Register &&
+                     std::ranges::contains(caller_saved, location.index));
+    }
+
+    for (auto reg : caller_saved) {
+        at({Location::Kind::Register, reg}) = nullptr;
+    }
+    at({Location::Kind::Register, 0}) = call;
+    run(injir::analysis::sequentialize(copies.after));
+
+    EXPECT_EQ(at(*alloc.get_location(call)), call);
+    for (auto *value : crossing) {
+        EXPECT_EQ(at(*alloc.get_location(value)), value);
+    }
+}
+
+TEST_F(CFGRegAllocCalls, CallingConvention) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc(4, lt, test_convention());
+
+    // the arguments live across the first call and take the callee-saved registers, the
+    // constant r2 crosses both calls with none left and is recomputed after them, the returned
+    // value is hinted to 0
+    check_regalloc(alloc, {{r0, 2}, {r1, 3}, {r2, std::nullopt}, {r6, 0}}, {});
+    EXPECT_TRUE(alloc.is_rematerialized(r2));
+    EXPECT_FALSE(alloc.is_split(r2));
+    EXPECT_FALSE(alloc.is_split(r0));
+    EXPECT_EQ(alloc.get_spill_slots_num(), 0);
+
+    const auto lifetime_start = lt.get_bb_lifetime(bb_a);
+    check_call(alloc, lt, static_cast<CallInstr *>(r3), lifetime_start + 6, {0, 1});
+    check_call(alloc, lt, static_cast<CallInstr *>(r5), lifetime_start + 10, {0, 1});
+
+    // the arguments leave their registers once, the return needs no copy
+    EXPECT_EQ(alloc.get_fixed_copies(r0)->after.size(), 1);
+    EXPECT_EQ(alloc.get_fixed_copies(r1)->after.size(), 1);
+    EXPECT_FALSE(alloc.get_fixed_copies(std::prev(bb_a->end())->get()).has_value());
+}
+
+TEST_F(CFGRegAllocCalls, NoCallingConvention) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc(4, lt);
+
+    for (const auto &[instr, _] : lt) {
+        EXPECT_FALSE(alloc.get_fixed_copies(instr).has_value());
+        EXPECT_FALSE(alloc.is_split(instr));
+    }
+}
+
+TEST_F(CFGRegAllocCalls, CallerSavedOnly) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    // every register is clobbered: each value live across a call is split, unless it can be
+    // recomputed
+    auto convention = test_convention();
+    convention.classes[0].caller_saved = {0, 1, 2, 3};
+    injir::analysis::LinearScan alloc(4, lt, convention);
+
+    for (auto *value : {r0, r1}) {
+        EXPECT_TRUE(alloc.is_split(value));
+    }
+    EXPECT_TRUE(alloc.is_rematerialized(r2));
+    EXPECT_EQ(alloc.get_spill_slots_num(), 2);
+    check_call(alloc, lt, static_cast<CallInstr *>(r3), lt.get_bb_lifetime(bb_a) + 6,
+               {0, 1, 2, 3});
+    check_call(alloc, lt, static_cast<CallInstr *>(r5), lt.get_bb_lifetime(bb_a) + 10,
+               {0, 1, 2, 3});
+}
+
+TEST_F(CFGRegAllocSpillSlots, Rematerialization) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+    injir::analysis::LinearScan alloc(1, lt);
+
+    // r0 = 1 is live across the whole block: it is recomputed at its use instead of taking the
+    // only register or a stack slot, which r2, r4 and r6 then need none of
+    EXPECT_TRUE(alloc.is_rematerialized(r0));
+    EXPECT_EQ(alloc.get_rematerialized(*alloc.get_location(r0)), r0);
+    EXPECT_EQ(alloc.get_spill_slots_num(), 0);
+    EXPECT_LT(alloc.get_frame_size(),
+              injir::analysis::LinearScan(1, lt, {}, {.rematerialize = false}).get_frame_size());
+
+    for (auto *value : {r2, r4, r6}) {
+        EXPECT_FALSE(alloc.is_rematerialized(value));
+    }
+}
+
+TEST_F(CFGRegAllocCalls, RematCost) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    // without a convention every argument comes on the stack and is reloaded
+    injir::analysis::LinearScan stack_args(4, lt);
+    EXPECT_EQ(stack_args.remat_cost(r0), 1);
+    EXPECT_EQ(stack_args.remat_cost(r2), 1);
+    EXPECT_EQ(stack_args.remat_cost(r3), std::nullopt);
+    EXPECT_EQ(stack_args.remat_cost(r4), std::nullopt);
+
+    injir::analysis::LinearScan reg_args(4, lt, test_convention());
+    EXPECT_EQ(reg_args.remat_cost(r0), std::nullopt);
+    EXPECT_EQ(reg_args.remat_cost(r2), 1);
+}
+
+TEST(LinearScan, RematCostAddChain) {
+    // x_{k + 1} = x_k + x_k reaches x_0 through 2^k paths, the budget cuts the walk short
+    Builder builder{};
+    Function func{Type::kInt, {}};
+    builder.set_insert_point(&func);
+    auto *bb = builder.create_bb();
+    builder.set_insert_point(bb);
+
+    std::vector<Instr *> chain{builder.create_int(1)};
+    for (std::size_t i = 0; i != 200; ++i) {
+        chain.push_back(builder.create_add(chain.back(), chain.back()));
+    }
+    builder.create_ret(chain.back());
+
+    auto loop_tree = injir::analysis::loop_tree(bb);
+    injir::analysis::LifeTime lt(bb, loop_tree, 1);
+    injir::analysis::LinearScan alloc(2, lt);
+    EXPECT_EQ(alloc.remat_cost(chain[0]), 1);
+    EXPECT_EQ(alloc.remat_cost(chain[1]), 3);
+    EXPECT_EQ(alloc.remat_cost(chain[2]), std::nullopt);
+    EXPECT_EQ(alloc.remat_cost(chain.back()), std::nullopt);
+}
+
+TEST_F(CFGRegAllocLoopCarried, SpillWeights) {
+    using injir::analysis::LinearScan;
+
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    injir::analysis::LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    // defined and read four times in the loop, read once after it
+    EXPECT_DOUBLE_EQ(LinearScan(2, lt).get_spill_weight(r2), 5 * LinearScan::kLoopWeight + 1);
+    EXPECT_DOUBLE_EQ(LinearScan(2, lt).get_spill_weight(r0), 3);
+    EXPECT_DOUBLE_EQ(LinearScan(2, lt, {}, {.spill_weights = false}).get_spill_weight(r2), 0);
+
+    // r0 and r2 are both live across the loop when r3 needs a register: r2 ends later and is
+    // spilled by the furthest end, although it is read on every iteration
+    LinearScan furthest(2, lt, {}, {.rematerialize = false, .spill_weights = false});
+    EXPECT_EQ(furthest.get_register(r2), std::nullopt);
+
+    LinearScan weighted(2, lt, {}, {.rematerialize = false});
+    EXPECT_TRUE(weighted.get_register(r2).has_value());
+    EXPECT_EQ(weighted.get_register(r0), std::nullopt);
+
+    // weights of the values spilled by alloc
+    auto spilled_weight = [&lt, &weighted](const LinearScan &alloc) {
+        double weight = 0;
+        for (const auto &[instr, _] : lt) {
+            if (alloc.get_spill_slot(instr).has_value()) {
+                weight += weighted.get_spill_weight(instr);
+            }
+        }
+        return weight;
+    };
+    EXPECT_LT(spilled_weight(weighted), spilled_weight(furthest));
+
+    // a stack argument is reloaded rather than spilled
+    LinearScan remat(2, lt);
+    EXPECT_TRUE(remat.is_rematerialized(r0));
+    EXPECT_TRUE(remat.get_register(r2).has_value());
+}
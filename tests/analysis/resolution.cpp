@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "analysis/lifetime.hpp"
+#include "analysis/loop.hpp"
+#include "analysis/parallel_copy.hpp"
+#include "analysis/regalloc.hpp"
+#include "analysis/resolution.hpp"
+
+#include "fixtures.hpp"
+
+using namespace injir::analysis;
+
+// Allocation of another allocator with the registers rotated by one inside a single block
+class RotatedAllocator final : public RegisterAllocator {
+  private:
+    const LifeTime &m_life_time;
+    BasicBlock *m_bb;
+    std::size_t m_regs_num;
+
+  public:
+    RotatedAllocator(const RegisterAllocator &alloc, const LifeTime &life_time, BasicBlock *bb,
+                     std::size_t regs_num)
+        : m_life_time{life_time}, m_bb{bb}, m_regs_num{regs_num} {
+        for (const auto &[instr, _] : life_time) {
+            m_results.emplace(instr, *alloc.get_location(instr));
+        }
+    }
+
+    [[nodiscard]] std::optional<Location> location_at(Instr *instr,
+                                                      std::size_t point) const override {
+        auto location = get_location(instr);
+        auto start = m_life_time.get_bb_lifetime(m_bb);
+        auto end = start + LifeTime::kLifetimeStep * m_bb->size();
+        if (location.has_value() && location->kind == Location::Kind::Register && start <= point &&
+            point < end) {
+            location->index = (location->index + 1) % m_regs_num;
+        }
+        return location;
+    }
+};
+
+// Run the moves of the edge on the locations at the end of pred and check that every phi and
+// every value live across the edge ends up where succ expects it. The phis of succ name pred as
+// incoming unless the edge has been split by incoming.
+static void check_edge(const RegisterAllocator &alloc, const LifeTime &lt,
+                       const std::vector<Move> &moves, BasicBlock *pred, BasicBlock *succ,
+                       BasicBlock *incoming = nullptr) {
+    incoming = incoming != nullptr ? incoming : pred;
+    auto pred_end = lt.get_bb_lifetime(pred) + LifeTime::kLifetimeStep * (pred->size() - 1);
+    auto succ_start = lt.get_bb_lifetime(succ);
+
+    std::vector<std::pair<Location, Instr *>> state{};
+    auto at = [&state](const Location &loc) -> Instr *& {
+        auto it = std::ranges::find(state, loc, &std::pair<Location, Instr *>::first);
+        if (it == state.end()) {
+            state.emplace_back(loc, nullptr);
+            return state.back().second;
+        }
+        return it->second;
+    };
+
+    std::vector<std::pair<Instr *, Instr *>> expected{};
+    for (const auto &[value, ranges] : lt) {
+        auto defined_in_succ =
+            std::ranges::any_of(*succ, [value](const auto &instr) { return instr.get() == value; });
+        if (!defined_in_succ && LifeTime::is_live_at(ranges, pred_end) &&
+            LifeTime::is_live_at(ranges, succ_start)) {
+            expected.emplace_back(value, value);
+        }
+    }
+    for (auto *phi : collect_instrs<PhiInstr>(*succ)) {
+        for (const auto &[value, bb] : phi->get_phi_nodes()) {
+            if (bb == incoming && alloc.get_location(phi).has_value()) {
+                expected.emplace_back(phi, value);
+            }
+        }
+    }
+
+    for (const auto &[_, value] : expected) {
+        at(*alloc.location_at(value, pred_end)) = value;
+    }
+    for (const auto &move : moves) {
+        if (move.kind == Move::Kind::kMove) {
+            at(move.to) = at(move.from);
+        } else {
+            std::swap(at(move.to), at(move.from));
+        }
+    }
+    for (const auto &[dest, value] : expected) {
+        EXPECT_EQ(at(*alloc.location_at(dest, succ_start)), value);
+    }
+}
+
+static std::vector<std::pair<BasicBlock *, BasicBlock *>> edges(const LifeTime &lt) {
+    std::vector<std::pair<BasicBlock *, BasicBlock *>> edges{};
+    for (auto *bb : lt.linear_order()) {
+        for (auto *succ : {bb->get_true_successor(), bb->get_false_successor()}) {
+            if (succ != nullptr) {
+                edges.emplace_back(bb, succ);
+            }
+        }
+    }
+    return edges;
+}
+
+TEST_F(CFGLifeTimePaperExample, ResolvePhis) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (std::size_t regs_num : {1, 2, 3, 4}) {
+        LinearScan alloc(regs_num, lt);
+        Resolution resolution(lt, alloc);
+
+        // a single location per value: only the phis need moves
+        std::size_t moves_num = 0;
+        for (auto [pred, succ] : edges(lt)) {
+            EXPECT_EQ(resolution.edge_copies(pred, succ), phi_copies(alloc, pred, succ));
+            moves_num += lower_phis(alloc, pred, succ).size();
+        }
+        EXPECT_EQ(resolution.get_moves_num(), moves_num);
+
+        for (const auto &[bb, position, moves] : resolution.place(test_func)) {
+            if (position == Resolution::Position::kEnd) {
+                EXPECT_EQ(bb->get_false_successor(), nullptr);
+            } else {
+                EXPECT_EQ(std::distance(bb->preds_begin(), bb->preds_end()), 1);
+            }
+        }
+        // no critical edges
+        EXPECT_EQ(test_func.size(), basic_block_counter);
+    }
+}
+
+TEST_F(CFGLifeTimePaperExample, ResolveLocationChanges) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    constexpr std::size_t kRegsNum = 4;
+    LinearScan base(kRegsNum, lt);
+    RotatedAllocator alloc(base, lt, bb_c, kRegsNum);
+
+    for (auto scratch :
+         {std::optional<Location>{}, std::optional<Location>{{Location::Kind::Spill, 100}}}) {
+        Resolution resolution(lt, alloc, scratch);
+        EXPECT_GT(resolution.get_moves_num(), 0);
+
+        for (auto [pred, succ] : edges(lt)) {
+            check_edge(alloc, lt, sequentialize(resolution.edge_copies(pred, succ), scratch), pred,
+                       succ);
+        }
+    }
+}
+
+TEST_F(CFGCriticalEdge, SplitCriticalEdge) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    constexpr std::size_t kRegsNum = 3;
+    LinearScan base(kRegsNum, lt);
+    RotatedAllocator alloc(base, lt, bb_c, kRegsNum);
+
+    Resolution resolution(lt, alloc);
+    auto placed = resolution.place(test_func);
+    ASSERT_EQ(test_func.size(), basic_block_counter + 1);
+
+    auto *split = &*std::prev(test_func.end());
+    EXPECT_EQ(bb_a->get_false_successor(), split);
+    EXPECT_EQ(split->get_true_successor(), bb_c);
+    EXPECT_EQ(*split->preds_begin(), bb_a);
+    EXPECT_EQ(std::ranges::count(bb_c->preds_begin(), bb_c->preds_end(), bb_a), 0);
+    EXPECT_EQ(std::ranges::count(bb_c->preds_begin(), bb_c->preds_end(), split), 1);
+
+    for (auto *phi : collect_instrs<PhiInstr>(*bb_c)) {
+        for (const auto &[_, bb] : phi->get_phi_nodes()) {
+            EXPECT_NE(bb, bb_a);
+        }
+    }
+
+    auto split_moves = std::ranges::find(placed, split, &Resolution::BlockMoves::bb);
+    ASSERT_NE(split_moves, placed.end());
+    EXPECT_EQ(split_moves->position, Resolution::Position::kEnd);
+    check_edge(alloc, lt, split_moves->moves, bb_a, bb_c, split);
+}
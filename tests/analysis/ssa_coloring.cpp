@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <optional>
+#include <vector>
+
+#include "analysis/allocator.hpp"
+#include "analysis/lifetime.hpp"
+#include "analysis/loop.hpp"
+#include "analysis/parallel_copy.hpp"
+#include "analysis/regalloc.hpp"
+#include "analysis/ssa_coloring.hpp"
+
+#include "fixtures.hpp"
+#include "regalloc_checks.hpp"
+
+using namespace injir::analysis;
+
+// Contents of the locations after the moves, every location initially holds its own index
+static std::vector<std::pair<Location, std::size_t>>
+run_moves(const std::vector<std::pair<Location, std::size_t>> &initial,
+          const std::vector<Move> &moves) {
+    auto state = initial;
+    auto at = [&state](const Location &loc) -> std::size_t & {
+        auto it = std::ranges::find(state, loc, &std::pair<Location, std::size_t>::first);
+        if (it == state.end()) {
+            state.emplace_back(loc, -1);
+            return state.back().second;
+        }
+        return it->second;
+    };
+
+    for (const auto &move : moves) {
+        if (move.kind == Move::Kind::kMove) {
+            at(move.to) = at(move.from);
+        } else {
+            std::swap(at(move.to), at(move.from));
+        }
+    }
+    return state;
+}
+
+static void check_sequentialize(const parallel_copy_t &copies,
+                                std::optional<Location> scratch = std::nullopt) {
+    std::vector<std::pair<Location, std::size_t>> initial{};
+    for (const auto &[from, to] : copies) {
+        for (const auto &loc : {from, to}) {
+            if (std::ranges::find(initial, loc, &std::pair<Location, std::size_t>::first) ==
+                initial.end()) {
+                initial.emplace_back(loc, initial.size());
+            }
+        }
+    }
+
+    auto value_of = [&initial](const Location &loc) {
+        return std::ranges::find(initial, loc, &std::pair<Location, std::size_t>::first)->second;
+    };
+
+    auto state = run_moves(initial, sequentialize(copies, scratch));
+    for (const auto &[loc, value] : state) {
+        if (loc == scratch) {
+            continue;
+        }
+        auto copy = std::ranges::find(copies, loc, &std::pair<Location, Location>::second);
+        EXPECT_EQ(value, copy != copies.end() ? value_of(copy->first) : value_of(loc));
+    }
+}
+
+static Location reg(std::size_t index, RegClass cls = RegClass::kInt) {
+    return {Location::Kind::Register, index, cls};
+}
+
+static Location slot(std::size_t index) { return {Location::Kind::Spill, index}; }
+
+TEST(ParallelCopy, Sequentialize) {
+    // chain
+    check_sequentialize({{reg(0), reg(1)}, {reg(1), reg(2)}, {reg(2), reg(3)}});
+    // swap
+    check_sequentialize({{reg(0), reg(1)}, {reg(1), reg(0)}});
+    // cycle with a spill slot and a fan-out from the cycle
+    check_sequentialize(
+        {{reg(0), reg(1)}, {reg(1), slot(0)}, {slot(0), reg(0)}, {reg(1), reg(2)}});
+    // two independent cycles and a self copy
+    check_sequentialize({{reg(0), reg(1)},
+                         {reg(1), reg(0)},
+                         {reg(2), reg(3)},
+                         {reg(3), reg(4)},
+                         {reg(4), reg(2)},
+                         {reg(5), reg(5)}});
+    // registers of different classes do not alias
+    check_sequentialize({{reg(0), reg(0, RegClass::kFloat)}, {reg(0, RegClass::kFloat), reg(0)}});
+
+    EXPECT_TRUE(sequentialize({{reg(0), reg(0)}, {slot(1), slot(1)}}).empty());
+    EXPECT_EQ(sequentialize({{reg(0), reg(1)}, {reg(1), reg(0)}}).size(), 1);
+}
+
+TEST(ParallelCopy, SequentializeScratch) {
+    auto scratch = reg(7);
+
+    check_sequentialize({{reg(0), reg(1)}, {reg(1), reg(0)}}, scratch);
+    check_sequentialize(
+        {{reg(0), reg(1)}, {reg(1), slot(0)}, {slot(0), reg(0)}, {reg(1), reg(2)}}, scratch);
+    check_sequentialize({{reg(0), reg(1)},
+                         {reg(1), reg(0)},
+                         {reg(2), reg(3)},
+                         {reg(3), reg(4)},
+                         {reg(4), reg(2)}},
+                        scratch);
+
+    // a cycle of n locations takes n + 1 moves and no swaps
+    auto moves = sequentialize({{reg(0), reg(1)}, {reg(1), reg(2)}, {reg(2), reg(0)}}, scratch);
+    EXPECT_EQ(moves.size(), 4);
+    EXPECT_TRUE(std::ranges::all_of(
+        moves, [](const auto &move) { return move.kind == Move::Kind::kMove; }));
+    // chains do not touch the scratch location
+    EXPECT_EQ(sequentialize({{reg(0), reg(1)}, {reg(1), reg(2)}}, scratch).size(), 2);
+}
+
+TEST_F(CFGLifeTimePaperExample, SSAColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (std::size_t regs_num : {1, 2, 3, 4}) {
+        SSAColoring alloc(regs_num, lt);
+        check_coloring(alloc, lt);
+        EXPECT_LE(spills_num(alloc, lt),
+                  spills_num(LinearScan(regs_num, lt, {}, {.rematerialize = false}), lt));
+    }
+}
+
+TEST_F(CFGLifeTimeNestedLoops, SSAColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (std::size_t regs_num : {1, 2, 3}) {
+        SSAColoring alloc(regs_num, lt);
+        check_coloring(alloc, lt);
+        EXPECT_LE(spills_num(alloc, lt),
+                  spills_num(LinearScan(regs_num, lt, {}, {.rematerialize = false}), lt));
+    }
+}
+
+TEST_F(CFGRegAllocSpillSlots, SSAColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    SSAColoring alloc(1, lt);
+    check_coloring(alloc, lt);
+    EXPECT_LE(alloc.get_spill_slots_num(), 2);
+}
+
+TEST_F(CFGRegAllocMixedTypes, SSAColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    SSAColoring alloc({2, 2}, lt);
+    check_coloring(alloc, lt);
+    EXPECT_EQ(spills_num(alloc, lt), 0);
+}
+
+// Running the moves of an edge leaves every live phi with its incoming value
+TEST_F(CFGLifeTimePaperExample, LowerPhis) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    for (std::size_t regs_num : {1, 2, 4}) {
+        SSAColoring alloc(regs_num, lt);
+
+        for (auto &succ : test_func) {
+            for (auto pred = succ.preds_begin(); pred != succ.preds_end(); ++pred) {
+                auto copies = phi_copies(alloc, *pred, &succ);
+                check_sequentialize(copies);
+
+                for (auto *phi : collect_instrs<PhiInstr>(succ)) {
+                    auto to = alloc.get_location(phi);
+                    if (!to.has_value()) {
+                        continue;
+                    }
+                    for (const auto &[value, bb] : phi->get_phi_nodes()) {
+                        if (bb == *pred) {
+                            EXPECT_NE(std::ranges::find(copies, std::pair{
+                                                                    *alloc.get_location(value),
+                                                                    *to}),
+                                      copies.end());
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(CFGLifeTimePaperExample, MakeSSAColoring) {
+    auto loop_tree = injir::analysis::loop_tree(bb_a);
+    LifeTime lt(bb_a, loop_tree, basic_block_counter);
+
+    auto alloc = make_register_allocator(RegAllocKind::kSSAColoring, {3, 3}, lt);
+    ASSERT_NE(alloc, nullptr);
+    check_coloring(*alloc, lt);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/clone.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+
+using namespace injir;
+
+TEST(Clone, Loop) {
+    Builder builder{};
+    Function func{Type::kInt, {Type::kInt}};
+    builder.set_insert_point(&func);
+
+    auto *bb_entry = builder.create_bb();
+    auto *bb_cond = builder.create_bb();
+    auto *bb_loop = builder.create_bb();
+    auto *bb_ret = builder.create_bb();
+
+    builder.set_insert_point(bb_entry);
+    auto *n = builder.create_arg(Type::kInt);
+    auto *one = builder.create_int(1);
+    auto *half = builder.create_double(0.5);
+    builder.create_jump(bb_cond);
+
+    builder.set_insert_point(bb_cond);
+    auto *i = builder.create_phi();
+    auto *cond = builder.create_cmp_le(i, n);
+    builder.create_br(cond, bb_loop, bb_ret);
+
+    builder.set_insert_point(bb_loop);
+    auto *inc = builder.create_add(i, one);
+    auto *call = builder.create_call(&func, {inc});
+    builder.create_jump(bb_cond);
+
+    builder.set_insert_point(bb_ret);
+    builder.create_ret(i);
+
+    i->add_incoming(one, bb_entry);
+    i->add_incoming(call, bb_loop);
+
+    value_map_t values{};
+    block_map_t blocks{};
+    auto clone = clone_function(func, values, blocks);
+
+    ASSERT_EQ(clone.size(), 4);
+    EXPECT_EQ(clone.get_ret_type(), Type::kInt);
+    EXPECT_EQ(clone.get_arg_types(), func.get_arg_types());
+    ASSERT_EQ(values.size(), 11);
+
+    auto *cond_clone = blocks.at(bb_cond);
+    EXPECT_EQ(cond_clone->get_true_successor(), blocks.at(bb_loop));
+    EXPECT_EQ(cond_clone->get_false_successor(), blocks.at(bb_ret));
+    EXPECT_EQ(*cond_clone->preds_begin(), blocks.at(bb_entry));
+
+    auto *i_clone = static_cast<PhiInstr *>(values.at(i));
+    const auto &nodes = i_clone->get_phi_nodes();
+    ASSERT_EQ(nodes.size(), 2);
+    EXPECT_EQ(nodes[0], (PhiInstr::phi_node{values.at(one), blocks.at(bb_entry)}));
+    EXPECT_EQ(nodes[1], (PhiInstr::phi_node{values.at(call), blocks.at(bb_loop)}));
+
+    auto *inc_clone = static_cast<BinInstr *>(values.at(inc));
+    EXPECT_EQ(inc_clone->get_lhs(), i_clone);
+    EXPECT_EQ(static_cast<CallInstr *>(values.at(call))->get_callee(), &func);
+    EXPECT_EQ(values.at(half)->value_type(), Type::kFloat);
+
+    // users stay within each function
+    EXPECT_EQ(i->users().size(), 3);
+    EXPECT_EQ(i_clone->users().size(), 3);
+    for (auto *user : i_clone->users()) {
+        EXPECT_TRUE(std::ranges::contains(values | std::views::values, user));
+    }
+    EXPECT_TRUE(std::ranges::is_permutation(values.at(one)->users(),
+                                            std::vector<Instr *>{values.at(inc), values.at(i)}));
+}
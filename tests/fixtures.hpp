@@ -424,4 +424,166 @@ class CFGLifeTimeNestedLoops : public ::testing::Test {
     Instr *r0{}, *r1{}, *r2{}, *r3{}, *r4{}, *r5{}, *r6{}, *r7{}, *r8{};
 };
 
+class CFGRegAllocSpillSlots : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        Builder builder{};
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        r0 = builder.create_int(1);
+        r1 = builder.create_int(2);
+        r2 = builder.create_add(r0, r1);
+        r3 = builder.create_int(3);
+        r4 = builder.create_add(r2, r3);
+        r5 = builder.create_int(4);
+        r6 = builder.create_add(r4, r5);
+        r7 = builder.create_add(r0, r6);
+    }
+
+    static constexpr std::size_t basic_block_counter = 1;
+    Function test_func{Type::kVoid, {}};
+    BasicBlock *bb_a{};
+    Instr *r0{}, *r1{}, *r2{}, *r3{}, *r4{}, *r5{}, *r6{}, *r7{};
+};
+
+class CFGRegAllocMixedTypes : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        Builder builder{};
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        r0 = builder.create_int(1);
+        r1 = builder.create_int(2);
+        r2 = builder.create_double(1.5);
+        r3 = builder.create_double(2.5);
+        r4 = builder.create_add(r0, r1);
+        r5 = builder.create_mul(r2, r3);
+        r6 = builder.create_add(r4, r0);
+        r7 = builder.create_add(r5, r2);
+    }
+
+    static constexpr std::size_t basic_block_counter = 1;
+    Function test_func{Type::kVoid, {}};
+    BasicBlock *bb_a{};
+    Instr *r0{}, *r1{}, *r2{}, *r3{}, *r4{}, *r5{}, *r6{}, *r7{};
+};
+
+class CFGRegAllocCalls : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        Builder builder{};
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        r0 = builder.create_arg(Type::kInt);
+        r1 = builder.create_arg(Type::kInt);
+        r2 = builder.create_int(10);
+        r3 = builder.create_call(&callee, {r0, r2});
+        r4 = builder.create_add(r3, r1);
+        r5 = builder.create_call(&callee, {r4, r0});
+        r6 = builder.create_add(r5, r2);
+        builder.create_ret(r6);
+    }
+
+    static constexpr std::size_t basic_block_counter = 1;
+    Function callee{Type::kInt, {Type::kInt, Type::kInt}};
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_a{};
+    Instr *r0{}, *r1{}, *r2{}, *r3{}, *r4{}, *r5{}, *r6{};
+};
+
+// The edge bb_a -> bb_c is critical
+class CFGCriticalEdge : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        Builder builder{};
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        r0 = builder.create_int(1);
+        r1 = builder.create_int(2);
+        r2 = builder.create_cmp_le(r0, r1);
+        builder.create_br(r2, bb_b, bb_c);
+
+        builder.set_insert_point(bb_b);
+        r3 = builder.create_add(r0, r1);
+        builder.create_jump(bb_c);
+
+        builder.set_insert_point(bb_c);
+        r4 = builder.create_phi();
+        r5 = builder.create_phi();
+        r6 = builder.create_add(r4, r5);
+        builder.create_ret(r6);
+
+        auto *r4_phi = static_cast<PhiInstr *>(r4);
+        auto *r5_phi = static_cast<PhiInstr *>(r5);
+
+        r4_phi->add_incoming(r1, bb_a);
+        r4_phi->add_incoming(r3, bb_b);
+
+        r5_phi->add_incoming(r0, bb_a);
+        r5_phi->add_incoming(r1, bb_b);
+    }
+
+    static constexpr std::size_t basic_block_counter = 3;
+    Function test_func{Type::kVoid, {}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{};
+    Instr *r0{}, *r1{}, *r2{}, *r3{}, *r4{}, *r5{}, *r6{};
+};
+
+// r0 is read only after the loop, r2 is carried around it and read after it as well
+class CFGRegAllocLoopCarried : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        Builder builder{};
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+        bb_d = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        r0 = builder.create_arg(Type::kInt);
+        r1 = builder.create_arg(Type::kInt);
+        builder.create_jump(bb_b);
+
+        builder.set_insert_point(bb_b);
+        r2 = builder.create_phi();
+        r3 = builder.create_add(r2, r2);
+        r4 = builder.create_cmp_le(r3, r2);
+        builder.create_br(r4, bb_c, bb_d);
+
+        builder.set_insert_point(bb_c);
+        r5 = builder.create_mul(r3, r2);
+        builder.create_jump(bb_b);
+
+        builder.set_insert_point(bb_d);
+        r6 = builder.create_mul(r0, r0);
+        r7 = builder.create_add(r6, r2);
+        builder.create_ret(r7);
+
+        auto *r2_phi = static_cast<PhiInstr *>(r2);
+        r2_phi->add_incoming(r1, bb_a);
+        r2_phi->add_incoming(r5, bb_c);
+    }
+
+    static constexpr std::size_t basic_block_counter = 4;
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{}, *bb_d{};
+    Instr *r0{}, *r1{}, *r2{}, *r3{}, *r4{}, *r5{}, *r6{}, *r7{};
+};
+
 #endif // FIXTURES_HPP
\ No newline at end of file
@@ -68,4 +68,133 @@ TEST_F(CFGTestExample3, DOM) {
 
     auto dom_tree = graph::dom(bb_a);
     check_dom_tree(dom_tree, expected);
-}
\ No newline at end of file
+}
+static void check_idom(const graph::idom_t &idoms, const graph::idom_t &expected) {
+    ASSERT_EQ(idoms.size(), expected.size());
+
+    for (const auto &[bb, idom] : expected) {
+        ASSERT_TRUE(idoms.contains(bb));
+        EXPECT_EQ(idoms.at(bb), idom);
+    }
+}
+
+TEST_F(CFGTestExample1, IDOM) {
+    graph::idom_t expected{{
+        {bb_a, nullptr},
+        {bb_b, bb_a},
+        {bb_c, bb_b},
+        {bb_d, bb_b},
+        {bb_e, bb_f},
+        {bb_f, bb_b},
+        {bb_g, bb_f},
+    }};
+
+    check_idom(graph::idom(bb_a), expected);
+
+    graph::dom_tree_t expected_tree{{
+        {bb_a, {bb_b}},
+        {bb_b, {bb_c, bb_d, bb_f}},
+        {bb_c, {}},
+        {bb_d, {}},
+        {bb_e, {}},
+        {bb_f, {bb_e, bb_g}},
+        {bb_g, {}},
+    }};
+    check_dom_tree(graph::idom_tree(bb_a), expected_tree);
+
+    auto idoms = graph::idom(bb_a);
+    EXPECT_TRUE(graph::dominates(idoms, bb_a, bb_g));
+    EXPECT_TRUE(graph::dominates(idoms, bb_f, bb_f));
+    EXPECT_TRUE(graph::dominates(idoms, bb_f, bb_e));
+    EXPECT_FALSE(graph::dominates(idoms, bb_e, bb_f));
+    EXPECT_FALSE(graph::dominates(idoms, bb_c, bb_d));
+}
+
+TEST_F(CFGTestExample2, IDOM) {
+    graph::idom_t expected{{
+        {bb_a, nullptr},
+        {bb_b, bb_a},
+        {bb_c, bb_b},
+        {bb_d, bb_c},
+        {bb_e, bb_d},
+        {bb_f, bb_e},
+        {bb_g, bb_f},
+        {bb_h, bb_g},
+        {bb_i, bb_g},
+        {bb_j, bb_b},
+        {bb_k, bb_i},
+    }};
+
+    check_idom(graph::idom(bb_a), expected);
+}
+
+TEST_F(CFGTestExample3, IDOM) {
+    graph::idom_t expected{{
+        {bb_a, nullptr},
+        {bb_b, bb_a},
+        {bb_c, bb_b},
+        {bb_d, bb_b},
+        {bb_e, bb_b},
+        {bb_f, bb_e},
+        {bb_g, bb_b},
+        {bb_h, bb_f},
+        {bb_i, bb_b},
+    }};
+
+    check_idom(graph::idom(bb_a), expected);
+}
+
+TEST_F(CFGTestExample1, IPDOM) {
+    // bb_d is the only exit
+    graph::idom_t expected{{
+        {bb_a, bb_b},
+        {bb_b, bb_d},
+        {bb_c, bb_d},
+        {bb_d, nullptr},
+        {bb_e, bb_d},
+        {bb_f, bb_d},
+        {bb_g, bb_d},
+    }};
+
+    check_idom(graph::ipdom(bb_a), expected);
+}
+
+TEST_F(CFGTestExample1, DominanceFrontier) {
+    graph::dom_tree_t expected{{
+        {bb_a, {}},
+        {bb_b, {}},
+        {bb_c, {bb_d}},
+        {bb_d, {}},
+        {bb_e, {bb_d}},
+        {bb_f, {bb_d}},
+        {bb_g, {bb_d}},
+    }};
+
+    check_dom_tree(graph::dom_frontier(bb_a), expected);
+}
+
+TEST_F(CFGTestExample2, DominanceFrontier) {
+    graph::dom_tree_t expected{{
+        {bb_a, {}},
+        {bb_b, {bb_b}},
+        {bb_c, {bb_b, bb_c}},
+        {bb_d, {bb_b, bb_c}},
+        {bb_e, {bb_b, bb_e}},
+        {bb_f, {bb_b, bb_e}},
+        {bb_g, {bb_b}},
+        {bb_h, {bb_b}},
+        {bb_i, {}},
+        {bb_j, {bb_c}},
+        {bb_k, {}},
+    }};
+
+    auto frontiers = graph::dom_frontier(bb_a);
+    check_dom_tree(frontiers, expected);
+
+    // a value defined in bb_j meets the one from bb_a in bb_c, which flows around the outer loop
+    auto idf = graph::iterated_dom_frontier(frontiers, {bb_j});
+    std::ranges::sort(idf);
+    std::vector<BasicBlock *> expected_idf{bb_b, bb_c};
+    std::ranges::sort(expected_idf);
+    EXPECT_EQ(idf, expected_idf);
+}
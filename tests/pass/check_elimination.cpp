@@ -167,4 +167,85 @@ TEST_F(CheckEliminationTest, DiamondTest) {
     bool changed = pass.apply(test_func);
 
     EXPECT_EQ(number_of_checks<NullCheck>(&test_func), 3);
-}
\ No newline at end of file
+}
+
+TEST_F(CheckEliminationTest, ScopedIntervals) {
+    auto *bb2 = builder.create_bb();
+    auto *bb3 = builder.create_bb();
+    auto *bb4 = builder.create_bb();
+
+    builder.set_insert_point(bb1);
+    auto *arg0 = builder.create_arg(test_func.get_arg_type(0));
+    auto *arg1 = builder.create_arg(test_func.get_arg_type(1));
+    builder.create_bound_check(arg0, 0, 9);
+    auto *cond = builder.create_cmp_le(arg0, arg1);
+    builder.create_br(cond, bb2, bb3);
+
+    // [0, 20] replaces [0, 9] in bb2 only
+    builder.set_insert_point(bb2);
+    builder.create_bound_check(arg0, 0, 20);
+    builder.create_bound_check(arg0, 0, 15);
+    builder.create_bound_check(arg1, 0, 15);
+    builder.create_jump(bb4);
+
+    builder.set_insert_point(bb3);
+    builder.create_bound_check(arg0, 0, 15);
+    builder.create_bound_check(arg0, 1, 9);
+    builder.create_bound_check(arg0, 10, 15);
+    builder.create_jump(bb4);
+
+    builder.set_insert_point(bb4);
+    builder.create_bound_check(arg0, 0, 15);
+    builder.create_bound_check(arg0, 5, 9);
+
+    CheckElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    EXPECT_EQ(number_of_checks<BoundCheck>(bb1), 1);
+    EXPECT_EQ(number_of_checks<BoundCheck>(bb2), 2);
+    EXPECT_EQ(number_of_checks<BoundCheck>(bb3), 1);
+    EXPECT_EQ(number_of_checks<BoundCheck>(bb4), 1);
+    EXPECT_EQ(arg0->users().size(), 5);
+}
+
+TEST_F(CheckEliminationTest, OverlappingIntervals) {
+    auto *idx = builder.create_arg(test_func.get_arg_type(0));
+    builder.create_bound_check(idx, 0, 5);
+    builder.create_bound_check(idx, 3, 9);
+    builder.create_bound_check(idx, 8, 12);
+
+    // covered by [3, 9]
+    builder.create_bound_check(idx, 4, 8);
+    // neither interval contains it
+    builder.create_bound_check(idx, 1, 6);
+    // [1, 6] is available now
+    builder.create_bound_check(idx, 2, 6);
+    builder.create_bound_check(idx, 9, 12);
+
+    CheckElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(number_of_checks<BoundCheck>(bb1), 4);
+}
+
+TEST_F(CheckEliminationTest, ManyChecks) {
+    constexpr std::size_t kValues = 100;
+    constexpr std::size_t kChecks = 4000;
+
+    std::vector<Instr *> values{};
+    for (std::size_t i = 0; i != kValues; ++i) {
+        values.push_back(builder.create_int(i));
+        builder.create_bound_check(values.back(), 0, 100);
+    }
+    for (std::size_t i = 0; i != kChecks; ++i) {
+        auto *value = values[i % kValues];
+        builder.create_null_check(value);
+        builder.create_bound_check(value, i % 7, 100 - i % 5);
+    }
+
+    CheckElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // [0, 100] covers the rest
+    EXPECT_EQ(number_of_checks<NullCheck>(bb1), kValues);
+    EXPECT_EQ(number_of_checks<BoundCheck>(bb1), kValues);
+}
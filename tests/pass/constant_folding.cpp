@@ -5,6 +5,10 @@
 #include "ir/instr.hpp"
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
 using namespace injir;
 using namespace injir::pass;
 
@@ -81,3 +85,100 @@ TEST_F(ConstantFoldingTest, SHL) {
     auto value = static_cast<ConstInstr<i64> *>(last_bb)->get_value();
     EXPECT_TRUE(value == 0xA40);
 }
+
+TEST_F(ConstantFoldingTest, DIV) {
+    auto *div = builder.create_div(builder.create_int(7), builder.create_int(2));
+    auto *by_zero = builder.create_div(builder.create_int(7), builder.create_int(0));
+    auto *wide_shl = builder.create_shl(builder.create_int(1), builder.create_int(64));
+    auto *ret = builder.create_ret(builder.create_add(div, builder.create_add(by_zero, wide_shl)));
+
+    ConstantFolding pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // division by zero traps and an oversized shift is not defined, they stay for run time
+    auto *add = static_cast<BinInstr *>(ret->get_ret());
+    ASSERT_EQ(add->get_lhs()->type(), InstrType::kConst);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(add->get_lhs())->get_value(), 3);
+    auto *rest = static_cast<BinInstr *>(add->get_rhs());
+    EXPECT_EQ(rest->get_lhs(), by_zero);
+    EXPECT_EQ(rest->get_rhs(), wide_shl);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(ConstantFoldingTest, CMP) {
+    auto *zero = builder.create_int(0);
+    auto *three = builder.create_int(3);
+    auto *less = builder.create_bin_instr(InstrType::kCmpLess, builder.create_int(2), three);
+    auto *less_equal = builder.create_cmp_le(builder.create_int(4), three);
+    // unsigned, -1 is the largest value
+    auto *wrapped = builder.create_bin_instr(InstrType::kCmpLess, builder.create_int(-1), zero);
+    auto *shl = builder.create_shl(less_equal, wrapped);
+    auto *ret = builder.create_ret(builder.create_or(less, shl));
+
+    ConstantFolding pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    ASSERT_EQ(ret->get_ret()->type(), InstrType::kConst);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(ret->get_ret())->get_value(), 1);
+}
+
+TEST_F(ConstantFoldingTest, FLOAT) {
+    auto *sum = builder.create_add(builder.create_double(0.5), builder.create_double(0.25));
+    auto *quotient = builder.create_div(sum, builder.create_double(0.0));
+    auto *less = builder.create_bin_instr(InstrType::kCmpLess, sum, builder.create_double(1.0));
+    builder.create_ret(builder.create_add(less, builder.create_int(0)));
+
+    ConstantFolding pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    auto has_float = [this](double value) {
+        return std::ranges::any_of(*bb, [value](auto &instr) {
+            return instr->type() == InstrType::kConst && instr->value_type() == Type::kFloat &&
+                   static_cast<ConstInstr<double> *>(instr.get())->get_value() == value;
+        });
+    };
+    EXPECT_TRUE(has_float(0.75));
+    EXPECT_TRUE(has_float(std::numeric_limits<double>::infinity()));
+
+    auto *ret = static_cast<ReturnInstr *>(std::prev(bb->end())->get());
+    ASSERT_EQ(ret->get_ret()->type(), InstrType::kConst);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(ret->get_ret())->get_value(), 1);
+    EXPECT_FALSE(std::ranges::any_of(*bb, [quotient, less](auto &instr) {
+        return instr.get() == quotient || instr.get() == less;
+    }));
+}
+
+TEST_F(ConstantFoldingTest, BRANCH) {
+    auto *bb_then = builder.create_bb();
+    auto *bb_else = builder.create_bb();
+    auto *bb_merge = builder.create_bb();
+
+    auto *one = builder.create_int(1);
+    auto *two = builder.create_int(2);
+    builder.create_br(builder.create_bin_instr(InstrType::kCmpLess, one, two), bb_then, bb_else);
+    builder.set_insert_point(bb_then);
+    builder.create_jump(bb_merge);
+    builder.set_insert_point(bb_else);
+    builder.create_jump(bb_merge);
+    builder.set_insert_point(bb_merge);
+    auto *phi = builder.create_phi();
+    auto *ret = builder.create_ret(builder.create_add(phi, one));
+    phi->add_incoming(one, bb_then);
+    phi->add_incoming(two, bb_else);
+
+    ConstantFolding pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    EXPECT_EQ(std::prev(bb->end())->get()->type(), InstrType::kJump);
+    EXPECT_EQ(bb->get_true_successor(), bb_then);
+    EXPECT_EQ(bb->get_false_successor(), nullptr);
+    EXPECT_EQ(std::distance(bb_else->preds_begin(), bb_else->preds_end()), 0);
+
+    // else is unreachable but still jumps to merge, once it is removed the phi and the add fold
+    EXPECT_EQ(phi->get_phi_nodes().size(), 2);
+    EXPECT_TRUE(remove_unreachable_blocks(test_func));
+    InstCombine combine{};
+    EXPECT_TRUE(combine.apply(test_func));
+    ASSERT_EQ(ret->get_ret()->type(), InstrType::kConst);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(ret->get_ret())->get_value(), 2);
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/constant_folding.hpp"
+#include "pass/dce.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(Function &func, Instr *instr) {
+    return std::ranges::any_of(func, [instr](auto &bb) {
+        return std::ranges::any_of(bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+    });
+}
+
+class DCETest : public ::testing::Test {
+  protected:
+    void create_diamond_blocks() {
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+        bb_d = builder.create_bb();
+    }
+
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        arg0 = builder.create_arg(Type::kInt);
+        arg1 = builder.create_arg(Type::kInt);
+    }
+
+    Builder builder{};
+    Function callee{Type::kInt, {Type::kInt}};
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{}, *bb_d{};
+    Instr *arg0{}, *arg1{};
+};
+
+TEST_F(DCETest, FoldedConstants) {
+    auto *r0 = builder.create_int(2);
+    auto *r1 = builder.create_int(3);
+    builder.create_add(r0, r1);
+    builder.create_ret(arg0);
+
+    ConstantFolding folding{};
+    EXPECT_TRUE(folding.apply(test_func));
+
+    // the operands and the folded constant itself are all unused
+    DeadCodeElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(bb_a->size(), 3);
+    EXPECT_FALSE(contains_instr(test_func, r0));
+    EXPECT_FALSE(contains_instr(test_func, r1));
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(DCETest, SideEffects) {
+    auto *r0 = builder.create_add(arg0, arg1);
+    auto *r1 = builder.create_mul(r0, r0);
+    auto *r2 = builder.create_call(&callee, {arg0});
+    auto *r3 = builder.create_alloca(Type::kInt);
+    auto *r4 = builder.create_store(r3, arg1);
+    auto *r5 = builder.create_load(r3);
+    builder.create_ret(arg1);
+
+    DeadCodeElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // unused call and store stay, and with the store the alloca
+    EXPECT_FALSE(contains_instr(test_func, r0));
+    EXPECT_FALSE(contains_instr(test_func, r1));
+    EXPECT_FALSE(contains_instr(test_func, r5));
+    EXPECT_TRUE(contains_instr(test_func, r2));
+    EXPECT_TRUE(contains_instr(test_func, r3));
+    EXPECT_TRUE(contains_instr(test_func, r4));
+    EXPECT_EQ(std::ranges::count(r3->users(), r5), 0);
+}
+
+// for (i = 0; i <= n; i = i + 1) {} return n;
+TEST_F(DCETest, DeadLoop) {
+    create_diamond_blocks();
+    auto *r0 = builder.create_int(0);
+    auto *r1 = builder.create_int(1);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    auto *r2 = builder.create_phi();
+    auto *r3 = builder.create_cmp_le(r2, arg0);
+    builder.create_br(r3, bb_c, bb_d);
+
+    builder.set_insert_point(bb_c);
+    auto *r4 = builder.create_add(r2, r1);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_d);
+    auto *ret = builder.create_ret(arg0);
+
+    static_cast<PhiInstr *>(r2)->add_incoming(r0, bb_a);
+    static_cast<PhiInstr *>(r2)->add_incoming(r4, bb_c);
+
+    // the phi and the add use each other
+    DeadCodeElimination dce{};
+    EXPECT_FALSE(dce.apply(test_func));
+
+    DeadCodeElimination adce{true};
+    EXPECT_TRUE(adce.apply(test_func));
+
+    EXPECT_EQ(test_func.size(), 3);
+    for (auto *instr : std::initializer_list<Instr *>{r0, r1, r2, r3, r4}) {
+        EXPECT_FALSE(contains_instr(test_func, instr));
+    }
+    ASSERT_EQ(bb_b->size(), 1);
+    EXPECT_EQ(bb_b->begin()->get()->type(), InstrType::kJump);
+    EXPECT_EQ(bb_b->get_true_successor(), bb_d);
+    EXPECT_EQ(bb_b->get_false_successor(), nullptr);
+    ASSERT_EQ(std::distance(bb_d->preds_begin(), bb_d->preds_end()), 1);
+    EXPECT_EQ(*bb_d->preds_begin(), bb_b);
+    EXPECT_TRUE(contains_instr(test_func, ret));
+
+    EXPECT_FALSE(adce.apply(test_func));
+}
+
+TEST_F(DCETest, LiveBranch) {
+    create_diamond_blocks();
+    auto *ptr = builder.create_alloca(Type::kInt);
+    auto *cond = builder.create_cmp_le(arg0, arg1);
+    auto *br = builder.create_br(cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_b);
+    builder.create_store(ptr, arg0);
+    builder.create_jump(bb_d);
+
+    // empty arm: nothing live depends on it but the branch is needed for the store
+    builder.set_insert_point(bb_c);
+    auto *r0 = builder.create_mul(arg0, arg0);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_d);
+    builder.create_ret(arg1);
+
+    DeadCodeElimination adce{true};
+    EXPECT_TRUE(adce.apply(test_func));
+
+    EXPECT_EQ(test_func.size(), 4);
+    EXPECT_TRUE(contains_instr(test_func, br));
+    EXPECT_TRUE(contains_instr(test_func, cond));
+    EXPECT_FALSE(contains_instr(test_func, r0));
+}
+
+TEST_F(DCETest, LivePhi) {
+    create_diamond_blocks();
+    auto *cond = builder.create_cmp_le(arg0, arg1);
+    auto *br = builder.create_br(cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_b);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_c);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_d);
+    auto *r0 = builder.create_phi();
+    builder.create_ret(r0);
+
+    static_cast<PhiInstr *>(r0)->add_incoming(arg0, bb_b);
+    static_cast<PhiInstr *>(r0)->add_incoming(arg1, bb_c);
+
+    // the branch selects the returned value
+    DeadCodeElimination adce{true};
+    EXPECT_FALSE(adce.apply(test_func));
+    EXPECT_TRUE(contains_instr(test_func, br));
+    EXPECT_EQ(test_func.size(), 4);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/gvn.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+class GVNTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+        bb_d = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        arg0 = builder.create_arg(Type::kInt);
+        arg1 = builder.create_arg(Type::kInt);
+    }
+
+    Builder builder{};
+    Function callee{Type::kInt, {Type::kInt}};
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{}, *bb_d{};
+    Instr *arg0{}, *arg1{};
+};
+
+TEST_F(GVNTest, CommutativeOperands) {
+    auto *r0 = builder.create_add(arg0, arg1);
+    auto *r1 = builder.create_add(arg1, arg0);
+    auto *r2 = builder.create_shl(arg0, arg1);
+    auto *r3 = builder.create_shl(arg1, arg0);
+    auto *r4 = builder.create_mul(r1, r3);
+    auto *r5 = builder.create_mul(r0, r3);
+    auto *r6 = builder.create_call(&callee, {r5});
+    auto *ret = builder.create_ret(r4);
+
+    GVN pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // r1 is r0, so r5 becomes r4; shl does not commute
+    EXPECT_FALSE(contains_instr(bb_a, r1));
+    EXPECT_FALSE(contains_instr(bb_a, r5));
+    EXPECT_TRUE(contains_instr(bb_a, r2));
+    EXPECT_TRUE(contains_instr(bb_a, r3));
+
+    EXPECT_EQ(r4->get_lhs(), r0);
+    EXPECT_EQ(ret->get_ret(), r4);
+    EXPECT_EQ(static_cast<CallInstr *>(r6)->get_args().front(), r4);
+    EXPECT_EQ(std::ranges::count(r4->users(), r6), 1);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(GVNTest, Constants) {
+    auto *r0 = builder.create_int(5);
+    auto *r1 = builder.create_int(5);
+    auto *r2 = builder.create_double(5.0);
+    auto *r3 = builder.create_add(arg0, r1);
+    builder.create_ret(r3);
+
+    GVN pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    EXPECT_FALSE(contains_instr(bb_a, r1));
+    EXPECT_TRUE(contains_instr(bb_a, r2));
+    EXPECT_EQ(r3->get_rhs(), r0);
+}
+
+TEST_F(GVNTest, DominatorScopes) {
+    auto *r0 = builder.create_mul(arg0, arg1);
+    auto *cond = builder.create_cmp_le(arg0, arg1);
+    builder.create_br(cond, bb_b, bb_c);
+
+    // dominated by bb_a
+    builder.set_insert_point(bb_b);
+    auto *r1 = builder.create_mul(arg1, arg0);
+    auto *r2 = builder.create_add(r1, arg0);
+    builder.create_jump(bb_d);
+
+    // sibling of bb_b: its add is not available here
+    builder.set_insert_point(bb_c);
+    auto *r3 = builder.create_add(r0, arg0);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_d);
+    auto *r4 = builder.create_phi();
+    builder.create_ret(r4);
+
+    static_cast<PhiInstr *>(r4)->add_incoming(r2, bb_b);
+    static_cast<PhiInstr *>(r4)->add_incoming(r3, bb_c);
+
+    GVN pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    EXPECT_FALSE(contains_instr(bb_b, r1));
+    EXPECT_EQ(r2->get_lhs(), r0);
+    EXPECT_TRUE(contains_instr(bb_c, r3));
+
+    auto &nodes = static_cast<PhiInstr *>(r4)->get_phi_nodes();
+    EXPECT_EQ(nodes[0].first, r2);
+    EXPECT_EQ(nodes[1].first, r3);
+}
+
+TEST_F(GVNTest, GepAddresses) {
+    auto *ptr = builder.create_alloca(Type::kInt, arg1);
+    auto *r0 = builder.create_gep(ptr, arg0);
+    auto *r1 = builder.create_load(r0);
+    auto *r2 = builder.create_gep(ptr, arg0);
+    auto *r3 = builder.create_load(r2);
+    auto *r4 = builder.create_add(r1, r3);
+    builder.create_ret(r4);
+
+    GVN pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // the address is computed once, both loads stay
+    EXPECT_FALSE(contains_instr(bb_a, r2));
+    EXPECT_EQ(static_cast<LoadInstr *>(r3)->ptr(), r0);
+    EXPECT_TRUE(contains_instr(bb_a, r1));
+    EXPECT_TRUE(contains_instr(bb_a, r3));
+    EXPECT_EQ(std::ranges::count(ptr->users(), r2), 0);
+}
@@ -68,11 +68,22 @@ TEST_F(InlineTestExample, INLINE) {
     ASSERT_TRUE(changed);
     ASSERT_EQ(caller.size(), 5);
 
+    // the callee is copied and stays as it was
+    EXPECT_EQ(callee.size(), 3);
+    EXPECT_EQ(callee.begin()->size(), 8);
+    EXPECT_EQ(&*callee.begin(), bb2);
+
     auto *bb0_cont = &*std::prev(caller.end());
-    const std::vector<BasicBlock *> expected{bb0, bb2, bb4, bb5, bb0_cont};
-    const std::vector<BasicBlock *> actual(
-        std::from_range, caller | std::views::transform([](auto &bb) { return &bb; }));
-    EXPECT_EQ(actual, expected);
+    auto *bb2_clone = &*std::next(caller.begin());
+    EXPECT_EQ(&*caller.begin(), bb0);
+    EXPECT_EQ(bb0->get_true_successor(), bb2_clone);
+    ASSERT_EQ(bb0->size(), 3);
+    EXPECT_EQ(std::prev(bb0->end())->get()->type(), InstrType::kJump);
+
+    // the arguments are replaced by the values passed
+    auto *val13_clone = std::next(bb2_clone->begin(), 2)->get();
+    ASSERT_EQ(val13_clone->type(), InstrType::kAdd);
+    EXPECT_EQ(static_cast<BinInstr *>(val13_clone)->get_lhs(), val1);
 
     ASSERT_TRUE(bb0_cont->size() != 0);
     auto *instr = bb0_cont->begin()->get();
@@ -82,6 +93,170 @@ TEST_F(InlineTestExample, INLINE) {
     const auto &nodes = phi->get_phi_nodes();
     ASSERT_EQ(nodes.size(), 2);
 
-    EXPECT_TRUE(std::ranges::contains(nodes, val15, &PhiInstr::phi_node::first));
-    EXPECT_TRUE(std::ranges::contains(nodes, val17, &PhiInstr::phi_node::first));
-}
\ No newline at end of file
+    for (auto [value, bb] : nodes) {
+        EXPECT_NE(value, val15);
+        EXPECT_NE(value, val17);
+        EXPECT_EQ(bb->get_true_successor(), bb0_cont);
+        EXPECT_EQ(std::prev(bb->end())->get()->type(), InstrType::kJump);
+    }
+    EXPECT_EQ(static_cast<BinInstr *>(val6)->get_lhs(), phi);
+    EXPECT_EQ(std::distance(bb0_cont->preds_begin(), bb0_cont->preds_end()), 2);
+}
+
+TEST_F(InlineTestExample, TwoCallSites) {
+    builder.set_insert_point(bb0);
+    auto *val7 = builder.create_call(&callee, {val6, val2});
+    builder.create_ret(val7);
+
+    Inline pass{};
+    EXPECT_TRUE(pass.apply(caller));
+
+    // two copies of three blocks and two continuations
+    EXPECT_EQ(caller.size(), 9);
+    EXPECT_EQ(callee.size(), 3);
+    for (auto &bb : caller) {
+        EXPECT_TRUE(collect_instrs<CallInstr>(bb).empty());
+    }
+}
+
+TEST_F(InlineTestExample, CostModel) {
+    // 10 instructions besides the arguments, the call and its two arguments are saved
+    InlineOptions options{.threshold = 5, .constant_arg_bonus = 0, .loop_bonus = 0};
+    Inline pass{options};
+    EXPECT_FALSE(pass.apply(caller));
+    EXPECT_EQ(caller.size(), 1);
+
+    // both constant arguments are used once
+    options.constant_arg_bonus = 1;
+    Inline bonus_pass{options};
+    EXPECT_TRUE(bonus_pass.apply(caller));
+    EXPECT_EQ(caller.size(), 5);
+}
+
+class InlineCallGraph : public ::testing::Test {
+  protected:
+    // return arg + 1
+    void build_leaf(Function &func) {
+        builder.set_insert_point(&func);
+        builder.set_insert_point(builder.create_bb());
+        auto *arg = builder.create_arg(Type::kInt);
+        auto *one = builder.create_int(1);
+        builder.create_ret(builder.create_add(arg, one));
+    }
+
+    // return callee(arg)
+    void build_wrapper(Function &func, Function &callee) {
+        builder.set_insert_point(&func);
+        builder.set_insert_point(builder.create_bb());
+        auto *arg = builder.create_arg(Type::kInt);
+        builder.create_ret(builder.create_call(&callee, {arg}));
+    }
+
+    // n <= 1 ? 1 : n * fact(n + -1)
+    void build_factorial(Function &func) {
+        builder.set_insert_point(&func);
+        auto *bb_entry = builder.create_bb();
+        auto *bb_base = builder.create_bb();
+        auto *bb_rec = builder.create_bb();
+
+        builder.set_insert_point(bb_entry);
+        auto *n = builder.create_arg(Type::kInt);
+        auto *one = builder.create_int(1);
+        auto *cond = builder.create_cmp_le(n, one);
+        builder.create_br(cond, bb_base, bb_rec);
+
+        builder.set_insert_point(bb_base);
+        builder.create_ret(one);
+
+        builder.set_insert_point(bb_rec);
+        auto *minus_one = builder.create_int(static_cast<i64>(-1));
+        auto *call = builder.create_call(&func, {builder.create_add(n, minus_one)});
+        builder.create_ret(builder.create_mul(n, call));
+    }
+
+    static std::size_t number_of_calls(Function &func) {
+        std::size_t calls = 0;
+        for (auto &bb : func) {
+            calls += collect_instrs<CallInstr>(bb).size();
+        }
+        return calls;
+    }
+
+    Builder builder{};
+    Function main_func{Type::kInt, {Type::kInt}};
+    Function wrapper{Type::kInt, {Type::kInt}};
+    Function leaf{Type::kInt, {Type::kInt}};
+};
+
+TEST_F(InlineCallGraph, BottomUp) {
+    build_leaf(leaf);
+    build_wrapper(wrapper, leaf);
+    build_wrapper(main_func, wrapper);
+
+    Inline pass{};
+    EXPECT_TRUE(pass.apply(main_func));
+
+    // leaf is inlined into wrapper first, main gets the copy of the result
+    EXPECT_EQ(number_of_calls(wrapper), 0);
+    EXPECT_EQ(number_of_calls(main_func), 0);
+    EXPECT_EQ(leaf.size(), 1);
+    EXPECT_EQ(wrapper.size(), 3);
+    EXPECT_EQ(main_func.size(), 5);
+}
+
+TEST_F(InlineCallGraph, Recursion) {
+    build_factorial(main_func);
+
+    Inline pass{InlineOptions{.max_recursion_depth = 2}};
+    EXPECT_TRUE(pass.apply(main_func));
+
+    // two levels of three blocks and a continuation each
+    EXPECT_EQ(main_func.size(), 11);
+    EXPECT_EQ(number_of_calls(main_func), 1);
+}
+
+TEST_F(InlineCallGraph, LoopBonus) {
+    build_leaf(leaf);
+
+    // for (i = 0; i <= n; i = leaf(i)) {}
+    builder.set_insert_point(&main_func);
+    auto *bb_entry = builder.create_bb();
+    auto *bb_header = builder.create_bb();
+    auto *bb_body = builder.create_bb();
+    auto *bb_exit = builder.create_bb();
+
+    builder.set_insert_point(bb_entry);
+    auto *n = builder.create_arg(Type::kInt);
+    auto *zero = builder.create_int(0);
+    builder.create_jump(bb_header);
+
+    builder.set_insert_point(bb_header);
+    auto *i = builder.create_phi();
+    builder.create_br(builder.create_cmp_le(i, n), bb_body, bb_exit);
+
+    builder.set_insert_point(bb_body);
+    auto *next = builder.create_call(&leaf, {i});
+    builder.create_jump(bb_header);
+
+    builder.set_insert_point(bb_exit);
+    builder.create_ret(i);
+
+    i->add_incoming(zero, bb_entry);
+    i->add_incoming(next, bb_body);
+
+    InlineOptions options{.threshold = 0, .loop_bonus = 0};
+    EXPECT_FALSE(Inline{options}.apply(main_func));
+
+    options.loop_bonus = 2;
+    EXPECT_TRUE(Inline{options}.apply(main_func));
+    EXPECT_EQ(number_of_calls(main_func), 0);
+
+    // the continuation of the body is the latch now
+    auto *body_cont = *std::find_if(bb_header->preds_begin(), bb_header->preds_end(),
+                                    [bb_entry](auto *pred) { return pred != bb_entry; });
+    EXPECT_NE(body_cont, bb_body);
+    EXPECT_EQ(body_cont->get_true_successor(), bb_header);
+    EXPECT_TRUE(std::ranges::contains(i->get_phi_nodes(), body_cont, &PhiInstr::phi_node::second));
+    EXPECT_NE(std::find(bb_header->preds_begin(), bb_header->preds_end(), body_cont),
+              bb_header->preds_end());
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/inst_combine.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+class InstCombineTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        builder.set_insert_point(bb_entry);
+        x = builder.create_arg(Type::kInt);
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_entry{};
+    Instr *x{};
+};
+
+TEST_F(InstCombineTest, FoldThenSimplify) {
+    // or(0, 1) folds to 1, then x * 1 = x and x | x = x
+    auto *one = builder.create_or(builder.create_int(0), builder.create_int(1));
+    auto *mul = builder.create_mul(x, one);
+    auto *or_instr = builder.create_or(mul, x);
+    auto *ret = builder.create_ret(or_instr);
+
+    InstCombine pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(ret->get_ret(), x);
+    EXPECT_FALSE(contains_instr(bb_entry, one));
+    EXPECT_FALSE(contains_instr(bb_entry, mul));
+    EXPECT_FALSE(contains_instr(bb_entry, or_instr));
+    EXPECT_EQ(std::ranges::count(x->users(), ret), 1);
+    EXPECT_EQ(std::ranges::count(x->users(), mul), 0);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(InstCombineTest, Requeue) {
+    auto *bb_header = builder.create_bb();
+    auto *bb_body = builder.create_bb();
+    auto *bb_exit = builder.create_bb();
+
+    auto *one = builder.create_int(1);
+    builder.create_jump(bb_header);
+    builder.set_insert_point(bb_header);
+    auto *phi = builder.create_phi();
+    builder.create_br(x, bb_body, bb_exit);
+    builder.set_insert_point(bb_body);
+    auto *mul = builder.create_mul(phi, one);
+    builder.create_jump(bb_header);
+    builder.set_insert_point(bb_exit);
+    auto *ret = builder.create_ret(phi);
+    phi->add_incoming(x, bb_entry);
+    phi->add_incoming(mul, bb_body);
+
+    // the phi is visited first, it merges x and itself once mul is replaced
+    InstCombine pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(ret->get_ret(), x);
+    EXPECT_FALSE(contains_instr(bb_header, phi));
+    EXPECT_FALSE(contains_instr(bb_body, mul));
+    EXPECT_EQ(std::ranges::count(x->users(), phi), 0);
+    EXPECT_EQ(std::ranges::count(one->users(), mul), 0);
+}
+
+TEST_F(InstCombineTest, Options) {
+    auto *sum = builder.create_add(builder.create_int(2), builder.create_int(3));
+    auto *mul = builder.create_mul(x, builder.create_int(1));
+    auto *ret = builder.create_ret(builder.create_add(sum, mul));
+
+    InstCombine peephole{{.fold_constants = false}};
+    EXPECT_TRUE(peephole.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_entry, sum));
+    EXPECT_FALSE(contains_instr(bb_entry, mul));
+
+    InstCombine folding{{.simplify = false}};
+    EXPECT_TRUE(folding.apply(test_func));
+    EXPECT_FALSE(contains_instr(bb_entry, sum));
+    auto *add = static_cast<BinInstr *>(ret->get_ret());
+    ASSERT_EQ(add->get_lhs()->type(), InstrType::kConst);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(add->get_lhs())->get_value(), 5);
+    EXPECT_EQ(add->get_rhs(), x);
+
+    // an integer and a float are not folded together
+    auto *half = builder.create_double(0.5);
+    auto *mixed_mul = builder.create_mul(half, builder.create_int(2));
+    EXPECT_FALSE(folding.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_entry, mixed_mul));
+}
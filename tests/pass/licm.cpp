@@ -0,0 +1,272 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/licm.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+class LICMTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+        bb_d = builder.create_bb();
+
+        builder.set_insert_point(bb_a);
+        arg0 = builder.create_arg(Type::kInt);
+        arg1 = builder.create_arg(Type::kInt);
+    }
+
+    Builder builder{};
+    Function callee{Type::kInt, {Type::kInt}};
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{}, *bb_d{};
+    Instr *arg0{}, *arg1{};
+};
+
+// for (i = 0; i <= a0; i = i + 1) { v = arr[a1]; s = i + a0 * a1; arr[i] = s; }
+TEST_F(LICMTest, WhileLoop) {
+    auto *arr = builder.create_alloca(Type::kInt, arg0);
+    auto *zero = builder.create_int(0);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    auto *i = builder.create_phi();
+    auto *cond = builder.create_cmp_le(i, arg0);
+    builder.create_br(cond, bb_c, bb_d);
+
+    builder.set_insert_point(bb_c);
+    auto *one = builder.create_int(1);
+    auto *mul = builder.create_mul(arg0, arg1);
+    auto *gep = builder.create_gep(arr, arg1);
+    auto *load = builder.create_load(gep);
+    auto *sum = builder.create_add(i, mul);
+    auto *store_gep = builder.create_gep(arr, i);
+    builder.create_store(store_gep, sum);
+    auto *inc = builder.create_add(i, one);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_d);
+    builder.create_ret(load);
+
+    i->add_incoming(zero, bb_a);
+    i->add_incoming(inc, bb_c);
+
+    LICM pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // bb_a only jumps to the header and is the preheader
+    EXPECT_EQ(test_func.size(), 4);
+    for (auto *instr : std::initializer_list<Instr *>{one, mul, gep}) {
+        EXPECT_TRUE(contains_instr(bb_a, instr));
+    }
+    EXPECT_EQ(std::prev(bb_a->end())->get()->type(), InstrType::kJump);
+
+    // the body is skipped when the loop exits at once, and arr may be written
+    for (auto *instr : std::initializer_list<Instr *>{load, sum, store_gep, inc}) {
+        EXPECT_TRUE(contains_instr(bb_c, instr));
+    }
+    EXPECT_TRUE(contains_instr(bb_b, cond));
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+// do { check(p); check(a1); v = p[a1]; q[i] = v; i = i + 1; } while (i <= a0)
+TEST_F(LICMTest, DoWhileLoop) {
+    auto *p = builder.create_alloca(Type::kInt, arg0);
+    auto *q = builder.create_alloca(Type::kInt, arg0);
+    auto *zero = builder.create_int(0);
+    auto *entry_cond = builder.create_cmp_le(zero, arg0);
+    builder.create_br(entry_cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_b);
+    auto *i = builder.create_phi();
+    auto *null_check = builder.create_null_check(p);
+    auto *bound_check = builder.create_bound_check(arg1, 0, 16);
+    auto *gep = builder.create_gep(p, arg1);
+    auto *load = builder.create_load(gep);
+    auto *store_gep = builder.create_gep(q, i);
+    builder.create_store(store_gep, load);
+    auto *one = builder.create_int(1);
+    auto *inc = builder.create_add(i, one);
+    auto *cond = builder.create_cmp_le(inc, arg0);
+    builder.create_br(cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_c);
+    builder.create_ret(zero);
+
+    i->add_incoming(zero, bb_a);
+    i->add_incoming(inc, bb_b);
+
+    LICM pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // the edge bb_a -> bb_b is split
+    ASSERT_EQ(test_func.size(), 5);
+    auto *preheader = &*std::prev(test_func.end());
+    EXPECT_EQ(bb_a->get_true_successor(), preheader);
+    EXPECT_EQ(preheader->get_true_successor(), bb_b);
+    EXPECT_EQ(i->get_phi_nodes().front().second, preheader);
+
+    for (auto *instr : std::initializer_list<Instr *>{null_check, bound_check, gep, load, one}) {
+        EXPECT_TRUE(contains_instr(preheader, instr));
+    }
+    for (auto *instr : std::initializer_list<Instr *>{i, store_gep, inc, cond}) {
+        EXPECT_TRUE(contains_instr(bb_b, instr));
+    }
+}
+
+TEST_F(LICMTest, AliasingStore) {
+    auto *p = builder.create_alloca(Type::kInt, arg0);
+    auto *zero = builder.create_int(0);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    auto *i = builder.create_phi();
+    auto *gep = builder.create_gep(p, arg1);
+    auto *load = builder.create_load(gep);
+    auto *store_gep = builder.create_gep(p, i);
+    builder.create_store(store_gep, load);
+    auto *inc = builder.create_add(i, load);
+    auto *cond = builder.create_cmp_le(inc, arg0);
+    builder.create_br(cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_c);
+    builder.create_call(&callee, {zero});
+    builder.create_ret(zero);
+
+    i->add_incoming(zero, bb_a);
+    i->add_incoming(inc, bb_b);
+
+    LICM pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_a, gep));
+    EXPECT_TRUE(contains_instr(bb_b, load));
+}
+
+// do { s = s + p[a1]; q[0] = s; callee(s); } while (s <= a0);
+TEST_F(LICMTest, CallInLoop) {
+    auto *p = builder.create_alloca(Type::kInt, arg0);
+    auto *q = builder.create_alloca(Type::kInt, arg0);
+    auto *zero = builder.create_int(0);
+    builder.create_call(&callee, {q});
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    auto *s = builder.create_phi();
+    auto *p_load = builder.create_load(builder.create_gep(p, arg1));
+    auto *q_load = builder.create_load(q);
+    auto *sum = builder.create_add(s, builder.create_add(p_load, q_load));
+    builder.create_store(builder.create_gep(q, zero), sum);
+    builder.create_call(&callee, {sum});
+    auto *cond = builder.create_cmp_le(sum, arg0);
+    builder.create_br(cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_c);
+    builder.create_ret(sum);
+
+    s->add_incoming(zero, bb_a);
+    s->add_incoming(sum, bb_b);
+
+    // the call cannot reach p, whose address is not passed anywhere, q is written in the loop
+    LICM pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_a, p_load));
+    EXPECT_TRUE(contains_instr(bb_b, q_load));
+}
+
+// while (true) { check(p); if (a0) check(a1); }
+TEST_F(LICMTest, NoExits) {
+    auto *p = builder.create_alloca(Type::kInt, arg0);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    auto *null_check = builder.create_null_check(p);
+    builder.create_br(arg0, bb_c, bb_d);
+
+    builder.set_insert_point(bb_c);
+    auto *bound_check = builder.create_bound_check(arg1, 0, 16);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_d);
+    builder.create_jump(bb_b);
+
+    // every block dominates the exits of a loop which has none, only the header runs for sure
+    LICM pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_a, null_check));
+    EXPECT_TRUE(contains_instr(bb_c, bound_check));
+}
+
+// Loop entered from two blocks: the preheader merges the initial values of the header phis
+TEST_F(LICMTest, NestedLoops) {
+    auto *bb_e = builder.create_bb();
+    auto *bb_f = builder.create_bb();
+
+    auto *zero = builder.create_int(0);
+    auto *entry_cond = builder.create_cmp_le(arg0, arg1);
+    builder.create_br(entry_cond, bb_b, bb_c);
+
+    builder.set_insert_point(bb_b);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_c);
+    builder.create_jump(bb_d);
+
+    // outer header
+    builder.set_insert_point(bb_d);
+    auto *i = builder.create_phi();
+    auto *outer_cond = builder.create_cmp_le(i, arg0);
+    builder.create_br(outer_cond, bb_e, bb_f);
+
+    // inner do-while loop, the outer latch
+    builder.set_insert_point(bb_e);
+    auto *j = builder.create_phi();
+    auto *mul = builder.create_mul(arg0, arg1);
+    auto *inner_inc = builder.create_add(j, mul);
+    auto *inner_cond = builder.create_cmp_le(inner_inc, arg1);
+    builder.create_br(inner_cond, bb_e, bb_d);
+
+    builder.set_insert_point(bb_f);
+    builder.create_ret(i);
+
+    i->add_incoming(zero, bb_b);
+    i->add_incoming(arg1, bb_c);
+    i->add_incoming(inner_inc, bb_e);
+    j->add_incoming(i, bb_d);
+    j->add_incoming(inner_inc, bb_e);
+
+    LICM pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // preheaders of both loops
+    ASSERT_EQ(test_func.size(), 8);
+    auto *inner_preheader = &*std::prev(test_func.end(), 2);
+    auto *outer_preheader = &*std::prev(test_func.end());
+
+    EXPECT_EQ(bb_d->get_true_successor(), inner_preheader);
+    EXPECT_EQ(bb_b->get_true_successor(), outer_preheader);
+    EXPECT_EQ(bb_c->get_true_successor(), outer_preheader);
+    EXPECT_EQ(std::distance(bb_d->preds_begin(), bb_d->preds_end()), 2);
+
+    ASSERT_EQ(i->get_phi_nodes().size(), 2);
+    auto *entry_phi = i->get_phi_nodes().back().first;
+    EXPECT_EQ(i->get_phi_nodes().back().second, outer_preheader);
+    ASSERT_TRUE(PhiInstr::classof(entry_phi));
+    EXPECT_EQ(static_cast<PhiInstr *>(entry_phi)->get_phi_nodes().size(), 2);
+
+    // hoisted out of the inner loop, then out of the outer one
+    EXPECT_TRUE(contains_instr(outer_preheader, mul));
+    EXPECT_TRUE(contains_instr(bb_e, inner_inc));
+}
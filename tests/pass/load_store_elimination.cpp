@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/load_store_elimination.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+class LoadStoreEliminationTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        bb_then = builder.create_bb();
+        bb_else = builder.create_bb();
+        bb_merge = builder.create_bb();
+
+        builder.set_insert_point(bb_entry);
+        n = builder.create_arg(Type::kInt);
+        p = builder.create_arg(Type::kInt);
+        one = builder.create_int(1);
+        two = builder.create_int(2);
+        a = builder.create_alloca(Type::kInt, builder.create_int(4));
+    }
+
+    // if (n) then else, both go to bb_merge
+    void build_diamond() {
+        builder.set_insert_point(bb_entry);
+        builder.create_br(n, bb_then, bb_else);
+        builder.set_insert_point(bb_then);
+        builder.create_jump(bb_merge);
+        builder.set_insert_point(bb_else);
+        builder.create_jump(bb_merge);
+        builder.set_insert_point(bb_merge);
+    }
+
+    // Append the instrs made by create before the terminator of bb
+    template <typename Create> auto *insert(BasicBlock *bb, Create create) {
+        builder.set_insert_point(bb);
+        auto terminator = std::prev(bb->end());
+        auto *instr = create();
+        bb->splice(bb->end(), *bb, terminator);
+        return instr;
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt, Type::kInt}};
+    BasicBlock *bb_entry{}, *bb_then{}, *bb_else{}, *bb_merge{};
+    Instr *n{}, *p{}, *one{}, *two{}, *a{};
+};
+
+TEST_F(LoadStoreEliminationTest, StoreToLoad) {
+    auto *a1 = builder.create_gep(a, one);
+    auto *store = builder.create_store(a1, n);
+    auto *load = builder.create_load(builder.create_gep(a, one));
+    auto *ret = builder.create_ret(load);
+
+    LoadStoreElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // the value is forwarded, then nothing reads a before the return
+    EXPECT_EQ(ret->get_ret(), n);
+    EXPECT_FALSE(contains_instr(bb_entry, load));
+    EXPECT_FALSE(contains_instr(bb_entry, store));
+    EXPECT_EQ(std::ranges::count(n->users(), ret), 1);
+    EXPECT_EQ(std::ranges::count(n->users(), store), 0);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(LoadStoreEliminationTest, RedundantLoad) {
+    auto *p1 = builder.create_gep(p, one);
+    auto *load0 = builder.create_load(p1);
+    build_diamond();
+    auto *load1 = builder.create_load(builder.create_gep(p, one));
+    auto *sum = builder.create_add(load0, load1);
+    builder.create_ret(sum);
+
+    // other elements of p
+    insert(bb_then, [&] { return builder.create_store(builder.create_gep(p, two), n); });
+    insert(bb_else, [&] {
+        return builder.create_store(builder.create_gep(p1, builder.create_int(3)), n);
+    });
+
+    LoadStoreElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(contains_instr(bb_merge, load1));
+    EXPECT_EQ(sum->get_rhs(), load0);
+
+    // the memory of the caller is kept
+    EXPECT_EQ(bb_then->size(), 3);
+    EXPECT_EQ(bb_else->size(), 4);
+}
+
+TEST_F(LoadStoreEliminationTest, Clobbered) {
+    auto *load0 = builder.create_load(p);
+    build_diamond();
+    auto *load1 = builder.create_load(p);
+    auto *load2 = builder.create_load(a);
+    builder.create_ret(builder.create_add(load1, load2));
+
+    insert(bb_then, [&] { return builder.create_store(builder.create_gep(p, n), one); });
+    auto *call = insert(bb_else, [&] { return builder.create_call(&test_func, {n, p}); });
+    auto *store = insert(bb_else, [&] { return builder.create_store(a, load0); });
+
+    // a may have any value on the path through bb_then
+    LoadStoreElimination pass{};
+    EXPECT_FALSE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_merge, load1));
+    EXPECT_TRUE(contains_instr(bb_merge, load2));
+    EXPECT_TRUE(contains_instr(bb_else, call));
+    EXPECT_TRUE(contains_instr(bb_else, store));
+}
+
+TEST_F(LoadStoreEliminationTest, DeadStore) {
+    auto *store0 = builder.create_store(p, one);
+    auto *store1 = builder.create_store(a, one);
+    build_diamond();
+    builder.create_ret(n);
+
+    // both paths overwrite p before it is read
+    auto *store2 = insert(bb_then, [&] { return builder.create_store(p, two); });
+    auto *store3 = insert(bb_else, [&] { return builder.create_store(p, n); });
+    // the stores to p do not write a, whose address is not taken
+    auto *load = insert(bb_then, [&] { return builder.create_load(a); });
+    auto *use = insert(bb_then, [&] {
+        return builder.create_store(builder.create_gep(p, one), load);
+    });
+
+    LoadStoreElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(contains_instr(bb_entry, store0));
+    EXPECT_TRUE(contains_instr(bb_then, store2));
+    EXPECT_TRUE(contains_instr(bb_else, store3));
+
+    // the load of a takes 1, then nothing reads a
+    EXPECT_FALSE(contains_instr(bb_then, load));
+    EXPECT_FALSE(contains_instr(bb_entry, store1));
+    EXPECT_EQ(static_cast<StoreInstr *>(use)->value(), one);
+}
+
+TEST_F(LoadStoreEliminationTest, Loop) {
+    // for (;;) { x = a[0]; a[0] = x + 1; if (n) break; } return a[0];
+    auto *bb_loop = bb_then;
+    auto *bb_exit = bb_else;
+    auto *store0 = builder.create_store(a, one);
+    builder.create_jump(bb_loop);
+
+    builder.set_insert_point(bb_loop);
+    auto *load = builder.create_load(a);
+    auto *inc = builder.create_add(load, one);
+    auto *store1 = builder.create_store(a, inc);
+    builder.create_br(n, bb_exit, bb_loop);
+
+    builder.set_insert_point(bb_exit);
+    auto *ret = builder.create_ret(builder.create_load(a));
+
+    // the value in the loop differs between iterations, the exit reads the last store
+    LoadStoreElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_entry, store0));
+    EXPECT_TRUE(contains_instr(bb_loop, load));
+    EXPECT_TRUE(contains_instr(bb_loop, store1));
+    EXPECT_EQ(ret->get_ret(), inc);
+}
+
+TEST_F(LoadStoreEliminationTest, LoopLocation) {
+    // for (i = 0; i + 1 <= n; ++i) a[i] = i; a[i] = 42; return a[3];
+    auto *bb_loop = bb_then;
+    auto *bb_exit = bb_else;
+    auto *zero = builder.create_int(0);
+    builder.create_jump(bb_loop);
+
+    builder.set_insert_point(bb_loop);
+    auto *i = builder.create_phi();
+    auto *gep = builder.create_gep(a, i);
+    auto *store0 = builder.create_store(gep, i);
+    auto *inc = builder.create_add(i, one);
+    builder.create_br(builder.create_cmp_le(inc, n), bb_loop, bb_exit);
+    i->add_incoming(zero, bb_entry);
+    i->add_incoming(inc, bb_loop);
+
+    builder.set_insert_point(bb_exit);
+    auto *store1 = builder.create_store(gep, builder.create_int(42));
+    builder.create_ret(builder.create_load(builder.create_gep(a, builder.create_int(3))));
+
+    // gep is another element on every iteration, only the last one is overwritten
+    LoadStoreElimination pass{};
+    pass.apply(test_func);
+    EXPECT_TRUE(contains_instr(bb_loop, store0));
+    EXPECT_TRUE(contains_instr(bb_exit, store1));
+}
+
+TEST_F(LoadStoreEliminationTest, LocalMemory) {
+    // the address of a never leaves the function
+    auto *store0 = builder.create_store(a, n);
+    auto *store1 = builder.create_store(p, one);
+    auto *call = builder.create_call(&test_func, {n, p});
+    auto *load = builder.create_load(a);
+    auto *ret = builder.create_ret(load);
+
+    LoadStoreElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(ret->get_ret(), n);
+    EXPECT_FALSE(contains_instr(bb_entry, load));
+    EXPECT_FALSE(contains_instr(bb_entry, store0));
+    EXPECT_TRUE(contains_instr(bb_entry, store1));
+    EXPECT_TRUE(contains_instr(bb_entry, call));
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/mem2reg.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+static bool has_memory_instrs(Function &func) {
+    return std::ranges::any_of(func, [](auto &bb) {
+        return std::ranges::any_of(bb, [](auto &instr) {
+            return AllocaInstr::classof(instr.get()) || LoadInstr::classof(instr.get()) ||
+                   StoreInstr::classof(instr.get());
+        });
+    });
+}
+
+class Mem2RegTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        bb_then = builder.create_bb();
+        bb_else = builder.create_bb();
+        bb_merge = builder.create_bb();
+
+        builder.set_insert_point(bb_entry);
+        n = builder.create_arg(Type::kInt);
+        one = builder.create_int(1);
+        two = builder.create_int(2);
+        x = builder.create_alloca(Type::kInt);
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_entry{}, *bb_then{}, *bb_else{}, *bb_merge{};
+    Instr *n{}, *one{}, *two{};
+    AllocaInstr *x{};
+};
+
+// x = 1; if (n) x = 2; return x;
+TEST_F(Mem2RegTest, Diamond) {
+    builder.create_store(x, one);
+    builder.create_br(n, bb_then, bb_else);
+
+    builder.set_insert_point(bb_then);
+    builder.create_store(x, two);
+    builder.create_jump(bb_merge);
+
+    builder.set_insert_point(bb_else);
+    builder.create_jump(bb_merge);
+
+    builder.set_insert_point(bb_merge);
+    auto *ret = builder.create_ret(builder.create_load(x));
+
+    Mem2Reg pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(has_memory_instrs(test_func));
+
+    ASSERT_TRUE(PhiInstr::classof(bb_merge->begin()->get()));
+    auto *phi = static_cast<PhiInstr *>(bb_merge->begin()->get());
+    EXPECT_EQ(ret->get_ret(), phi);
+    EXPECT_EQ(std::ranges::count(phi->users(), ret), 1);
+
+    auto &nodes = phi->get_phi_nodes();
+    ASSERT_EQ(nodes.size(), 2);
+    for (auto &[value, bb] : nodes) {
+        EXPECT_EQ(value, bb == bb_then ? two : one);
+    }
+    EXPECT_EQ(std::ranges::count(one->users(), phi), 1);
+    EXPECT_EQ(std::ranges::count(two->users(), phi), 1);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+// x = 0; while (x < n) x = x + 1; return x;
+TEST_F(Mem2RegTest, Loop) {
+    auto *bb_cond = bb_then;
+    auto *bb_body = bb_else;
+    auto *bb_exit = bb_merge;
+
+    Instr *zero = builder.create_int(0);
+    builder.create_store(x, zero);
+    builder.create_jump(bb_cond);
+
+    builder.set_insert_point(bb_cond);
+    auto *cond = builder.create_bin_instr(InstrType::kCmpLess, builder.create_load(x), n);
+    builder.create_br(cond, bb_body, bb_exit);
+
+    builder.set_insert_point(bb_body);
+    auto *inc = builder.create_add(builder.create_load(x), one);
+    builder.create_store(x, inc);
+    builder.create_jump(bb_cond);
+
+    builder.set_insert_point(bb_exit);
+    auto *ret = builder.create_ret(builder.create_load(x));
+
+    Mem2Reg pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(has_memory_instrs(test_func));
+
+    // only the loop header needs a phi
+    EXPECT_FALSE(PhiInstr::classof(bb_body->begin()->get()));
+    EXPECT_FALSE(PhiInstr::classof(bb_exit->begin()->get()));
+    ASSERT_TRUE(PhiInstr::classof(bb_cond->begin()->get()));
+    auto *phi = static_cast<PhiInstr *>(bb_cond->begin()->get());
+
+    auto &nodes = phi->get_phi_nodes();
+    ASSERT_EQ(nodes.size(), 2);
+    for (auto &[value, bb] : nodes) {
+        EXPECT_EQ(value, bb == bb_body ? inc : zero);
+    }
+    EXPECT_EQ(cond->get_lhs(), phi);
+    EXPECT_EQ(inc->get_lhs(), phi);
+    EXPECT_EQ(ret->get_ret(), phi);
+    EXPECT_EQ(phi->users().size(), 3);
+}
+
+TEST_F(Mem2RegTest, DeadPhi) {
+    // the stores of both branches meet in bb_merge, where x is not read
+    builder.create_br(n, bb_then, bb_else);
+
+    builder.set_insert_point(bb_then);
+    builder.create_store(x, one);
+    builder.create_jump(bb_merge);
+
+    builder.set_insert_point(bb_else);
+    builder.create_store(x, two);
+    builder.create_jump(bb_merge);
+
+    builder.set_insert_point(bb_merge);
+    builder.create_ret(n);
+
+    Mem2Reg pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(has_memory_instrs(test_func));
+    EXPECT_EQ(bb_merge->size(), 1);
+    EXPECT_TRUE(one->users().empty());
+    EXPECT_TRUE(two->users().empty());
+}
+
+TEST_F(Mem2RegTest, Uninitialized) {
+    auto *y = builder.create_alloca(Type::kFloat);
+    auto *load_x = builder.create_load(x);
+    auto *load_y = builder.create_load(y);
+    auto *add = builder.create_add(load_x, n);
+    auto *ret = builder.create_ret(add);
+
+    Mem2Reg pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(has_memory_instrs(test_func));
+
+    // x reads integer zero, y is unused
+    EXPECT_FALSE(contains_instr(bb_entry, load_x));
+    EXPECT_FALSE(contains_instr(bb_entry, load_y));
+    ASSERT_EQ(add->get_lhs()->type(), InstrType::kConst);
+    EXPECT_EQ(add->get_lhs()->value_type(), Type::kInt);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(add->get_lhs())->get_value(), 0);
+    EXPECT_EQ(ret->get_ret(), add);
+}
+
+TEST_F(Mem2RegTest, Escaping) {
+    auto *arr = builder.create_alloca(Type::kInt, two);
+    auto *ptr = builder.create_alloca(Type::kInt);
+    auto *ptr_slot = builder.create_alloca(Type::kInt);
+    builder.create_store(arr, one);
+    builder.create_store(ptr_slot, ptr);
+    builder.create_store(x, one);
+    auto *gep = builder.create_gep(x, one);
+    builder.create_ret(builder.create_load(gep));
+
+    // arrays, addresses stored to memory and pointer arithmetic stay in memory
+    Mem2Reg pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_entry, arr));
+    EXPECT_TRUE(contains_instr(bb_entry, ptr));
+    EXPECT_TRUE(contains_instr(bb_entry, x));
+    EXPECT_FALSE(contains_instr(bb_entry, ptr_slot));
+}
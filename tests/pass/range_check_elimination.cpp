@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/range_check_elimination.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+// for (i = 0; i < limit; i = i + 1) { body }
+class RangeCheckTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        bb_cond = builder.create_bb();
+        bb_body = builder.create_bb();
+        bb_exit = builder.create_bb();
+
+        builder.set_insert_point(bb_entry);
+        n = builder.create_arg(Type::kInt);
+        zero = builder.create_int(0);
+        one = builder.create_int(1);
+    }
+
+    void build_header(Instr *limit) {
+        builder.create_jump(bb_cond);
+
+        builder.set_insert_point(bb_cond);
+        i = builder.create_phi();
+        auto *cond = builder.create_bin_instr(InstrType::kCmpLess, i, limit);
+        builder.create_br(cond, bb_body, bb_exit);
+
+        builder.set_insert_point(bb_exit);
+        builder.create_ret(zero);
+
+        builder.set_insert_point(bb_body);
+    }
+
+    void build_latch(BasicBlock *latch) {
+        builder.set_insert_point(latch);
+        auto *inc = builder.create_add(i, one);
+        builder.create_jump(bb_cond);
+
+        i->add_incoming(zero, bb_entry);
+        i->add_incoming(inc, latch);
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_entry{}, *bb_cond{}, *bb_body{}, *bb_exit{};
+    Instr *n{}, *zero{}, *one{};
+    PhiInstr *i{};
+};
+
+TEST_F(RangeCheckTest, ConstantLimit) {
+    auto *ten = builder.create_int(10);
+    build_header(ten);
+
+    // i is in [0, 9]
+    auto *check0 = builder.create_bound_check(i, 0, 9);
+    auto *i1 = builder.create_add(i, one);
+    auto *check1 = builder.create_bound_check(i1, 0, 9);
+    auto *check2 = builder.create_bound_check(i1, 1, 10);
+    auto *check3 = builder.create_bound_check(n, 0, 9);
+    build_latch(bb_body);
+
+    RangeCheckElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    EXPECT_FALSE(contains_instr(bb_body, check0));
+    EXPECT_TRUE(contains_instr(bb_body, check1));
+    EXPECT_FALSE(contains_instr(bb_body, check2));
+    EXPECT_TRUE(contains_instr(bb_body, check3));
+    EXPECT_EQ(std::ranges::count(i->users(), check0), 0);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(RangeCheckTest, UnknownLimit) {
+    build_header(n);
+
+    auto *check0 = builder.create_bound_check(i, 0, 15);
+    auto *two = builder.create_int(2);
+    auto *i2 = builder.create_add(two, i);
+    auto *check1 = builder.create_bound_check(i2, 2, 15);
+    build_latch(bb_body);
+
+    RangeCheckElimination pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    EXPECT_FALSE(contains_instr(bb_body, check0));
+    EXPECT_FALSE(contains_instr(bb_body, check1));
+
+    // i + 2 <= 15 for every i < n when n <= 14
+    ASSERT_EQ(bb_entry->size(), 5);
+    auto *limit_check = std::prev(bb_entry->end(), 2)->get();
+    ASSERT_TRUE(BoundCheck::classof(limit_check));
+    EXPECT_EQ(static_cast<BoundCheck *>(limit_check)->get_check(), n);
+    EXPECT_EQ(static_cast<BoundCheck *>(limit_check)->get_lower_bound(), 0);
+    EXPECT_EQ(static_cast<BoundCheck *>(limit_check)->get_upper_bound(), 14);
+    EXPECT_EQ(std::ranges::count(n->users(), limit_check), 1);
+}
+
+TEST_F(RangeCheckTest, ConditionalCheck) {
+    auto *bb_then = builder.create_bb();
+    auto *bb_latch = builder.create_bb();
+    build_header(n);
+
+    auto *check0 = builder.create_bound_check(i, 1, 15);
+    auto *cond = builder.create_cmp_le(i, n);
+    builder.create_br(cond, bb_then, bb_latch);
+
+    // not executed on every iteration
+    builder.set_insert_point(bb_then);
+    auto *check1 = builder.create_bound_check(i, 0, 15);
+    builder.create_jump(bb_latch);
+
+    build_latch(bb_latch);
+
+    // the lower bound does not hold for i = 0
+    RangeCheckElimination pass{};
+    EXPECT_FALSE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_body, check0));
+    EXPECT_TRUE(contains_instr(bb_then, check1));
+}
+
+TEST_F(RangeCheckTest, LoopMayNotRun) {
+    auto *twenty = builder.create_int(20);
+    build_header(n);
+
+    auto *check = builder.create_bound_check(i, 0, 9);
+    auto *inc = builder.create_add(i, one);
+    builder.create_jump(bb_cond);
+    i->add_incoming(twenty, bb_entry);
+    i->add_incoming(inc, bb_body);
+
+    // for (i = 20; i < n; ...) does not run for n = 15, which a check of n <= 10 would reject
+    RangeCheckElimination pass{};
+    EXPECT_FALSE(pass.apply(test_func));
+    EXPECT_TRUE(contains_instr(bb_body, check));
+    EXPECT_EQ(bb_entry->size(), 5);
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/sccp.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static void expect_const(Instr *instr, i64 value) {
+    ASSERT_EQ(instr->type(), InstrType::kConst);
+    EXPECT_EQ(static_cast<ConstInstr<i64> *>(instr)->get_value(), value);
+}
+
+static bool contains_bb(Function &func, BasicBlock *bb) {
+    return std::ranges::any_of(func, [bb](auto &func_bb) { return &func_bb == bb; });
+}
+
+class SCCPTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_a = builder.create_bb();
+        bb_b = builder.create_bb();
+        bb_c = builder.create_bb();
+        bb_d = builder.create_bb();
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_a{}, *bb_b{}, *bb_c{}, *bb_d{};
+};
+
+TEST_F(SCCPTest, ConstantBranch) {
+    builder.set_insert_point(bb_a);
+    auto *r0 = builder.create_int(4);
+    auto *r1 = builder.create_int(2);
+    auto *r2 = builder.create_cmp_le(r1, r0);
+    builder.create_br(r2, bb_b, bb_c);
+
+    builder.set_insert_point(bb_b);
+    auto *r3 = builder.create_add(r0, r1);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_c);
+    auto *r4 = builder.create_mul(r0, r1);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_d);
+    auto *r5 = builder.create_phi();
+    auto *r6 = builder.create_add(r5, r0);
+    auto *ret = builder.create_ret(r6);
+
+    static_cast<PhiInstr *>(r5)->add_incoming(r3, bb_b);
+    static_cast<PhiInstr *>(r5)->add_incoming(r4, bb_c);
+
+    SCCP pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    // bb_c is never reached, the phi only sees 4 + 2
+    EXPECT_EQ(test_func.size(), 3);
+    EXPECT_FALSE(contains_bb(test_func, bb_c));
+    expect_const(ret->get_ret(), 10);
+
+    EXPECT_EQ(std::prev(bb_a->end())->get()->type(), InstrType::kJump);
+    EXPECT_EQ(bb_a->get_true_successor(), bb_b);
+    EXPECT_EQ(bb_a->get_false_successor(), nullptr);
+
+    ASSERT_EQ(std::distance(bb_d->preds_begin(), bb_d->preds_end()), 1);
+    EXPECT_EQ(*bb_d->preds_begin(), bb_b);
+    EXPECT_TRUE(collect_instrs<PhiInstr>(*bb_d).empty());
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+// A loop whose phi only ever meets the same constant, which one sweep over the blocks never sees
+TEST_F(SCCPTest, LoopPhi) {
+    builder.set_insert_point(bb_a);
+    auto *r0 = builder.create_int(1);
+    auto *r1 = builder.create_arg(Type::kInt);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_b);
+    auto *r2 = builder.create_phi();
+    auto *r3 = builder.create_cmp_le(r2, r1);
+    builder.create_br(r3, bb_c, bb_d);
+
+    builder.set_insert_point(bb_c);
+    auto *r4 = builder.create_mul(r2, r0);
+    builder.create_jump(bb_b);
+
+    builder.set_insert_point(bb_d);
+    auto *ret = builder.create_ret(r2);
+
+    static_cast<PhiInstr *>(r2)->add_incoming(r0, bb_a);
+    static_cast<PhiInstr *>(r2)->add_incoming(r4, bb_c);
+
+    SCCP pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+
+    expect_const(ret->get_ret(), 1);
+    EXPECT_TRUE(collect_instrs<PhiInstr>(*bb_b).empty());
+    // the condition depends on the argument, the loop stays
+    EXPECT_EQ(test_func.size(), 4);
+    EXPECT_EQ(std::prev(bb_b->end())->get()->type(), InstrType::kBranch);
+
+    auto *cond = static_cast<BinInstr *>(r3);
+    expect_const(cond->get_lhs(), 1);
+    EXPECT_EQ(cond->get_rhs(), r1);
+}
+
+TEST_F(SCCPTest, OverdefinedPhi) {
+    builder.set_insert_point(bb_a);
+    auto *r0 = builder.create_arg(Type::kInt);
+    auto *r1 = builder.create_int(3);
+    auto *r2 = builder.create_cmp_le(r0, r1);
+    builder.create_br(r2, bb_b, bb_c);
+
+    builder.set_insert_point(bb_b);
+    auto *r3 = builder.create_int(5);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_c);
+    auto *r4 = builder.create_int(7);
+    builder.create_jump(bb_d);
+
+    builder.set_insert_point(bb_d);
+    auto *r5 = builder.create_phi();
+    auto *ret = builder.create_ret(r5);
+
+    static_cast<PhiInstr *>(r5)->add_incoming(r3, bb_b);
+    static_cast<PhiInstr *>(r5)->add_incoming(r4, bb_c);
+
+    SCCP pass{};
+    EXPECT_FALSE(pass.apply(test_func));
+    EXPECT_EQ(test_func.size(), 4);
+    EXPECT_EQ(ret->get_ret(), r5);
+    EXPECT_EQ(static_cast<PhiInstr *>(r5)->get_phi_nodes().size(), 2);
+}
+
+TEST_F(SCCPTest, Division) {
+    builder.set_insert_point(bb_a);
+    auto *r0 = builder.create_div(builder.create_int(12), builder.create_int(4));
+    auto *r1 = builder.create_div(r0, builder.create_int(0));
+    auto *r2 = builder.create_add(r0, r1);
+    builder.create_ret(r2);
+
+    // 12 / 4 is propagated, a division by zero is left to trap at run time
+    SCCP pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    auto *div = static_cast<BinInstr *>(r1);
+    expect_const(div->get_lhs(), 3);
+    EXPECT_EQ(div->type(), InstrType::kDiv);
+    EXPECT_EQ(static_cast<BinInstr *>(r2)->get_rhs(), r1);
+}
+
+TEST(SCCP, Evaluate) {
+    EXPECT_EQ(fold_int(InstrType::kAdd, 2, 3), 5);
+    EXPECT_EQ(fold_int(InstrType::kShl, 1, 4), 16);
+    EXPECT_EQ(fold_int(InstrType::kShl, 1, 64), std::nullopt);
+    EXPECT_EQ(fold_int(InstrType::kCmpLess, 3, 3), 0);
+    EXPECT_EQ(fold_int(InstrType::kCmpLessEqual, 3, 3), 1);
+    EXPECT_EQ(fold_int(InstrType::kDiv, 6, 3), 2);
+    EXPECT_EQ(fold_int(InstrType::kDiv, 6, 0), std::nullopt);
+}
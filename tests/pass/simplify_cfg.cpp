@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/simplify_cfg.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_bb(Function &func, BasicBlock *bb) {
+    return std::ranges::any_of(func, [bb](auto &func_bb) { return &func_bb == bb; });
+}
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+class SimplifyCFGTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        builder.set_insert_point(bb_entry);
+        x = builder.create_arg(Type::kInt);
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_entry{};
+    Instr *x{};
+};
+
+TEST_F(SimplifyCFGTest, MergeChain) {
+    // entry -> bb_1 -> bb_2, as Inline leaves a call site
+    auto *bb_1 = builder.create_bb();
+    auto *bb_2 = builder.create_bb();
+
+    builder.create_jump(bb_1);
+    builder.set_insert_point(bb_1);
+    auto *add = builder.create_add(x, builder.create_int(1));
+    builder.create_jump(bb_2);
+    builder.set_insert_point(bb_2);
+    auto *ret = builder.create_ret(add);
+
+    SimplifyCFG pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    ASSERT_EQ(test_func.size(), 1);
+    EXPECT_EQ(&*test_func.begin(), bb_entry);
+    EXPECT_TRUE(contains_instr(bb_entry, add));
+    EXPECT_EQ(std::prev(bb_entry->end())->get(), ret);
+    EXPECT_EQ(bb_entry->get_true_successor(), nullptr);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(SimplifyCFGTest, ThreadEmpty) {
+    // entry -> (bb_empty -> bb_exit | bb_other -> bb_exit)
+    auto *bb_empty = builder.create_bb();
+    auto *bb_other = builder.create_bb();
+    auto *bb_exit = builder.create_bb();
+
+    auto *one = builder.create_int(1);
+    auto *two = builder.create_int(2);
+    builder.create_br(x, bb_empty, bb_other);
+    builder.set_insert_point(bb_empty);
+    builder.create_jump(bb_exit);
+    builder.set_insert_point(bb_other);
+    builder.create_jump(bb_exit);
+    builder.set_insert_point(bb_exit);
+    auto *phi = builder.create_phi();
+    phi->add_incoming(one, bb_empty);
+    phi->add_incoming(two, bb_other);
+    builder.create_ret(phi);
+
+    // one of the empty blocks is threaded, the other one keeps the phi inputs apart
+    SimplifyCFG pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(test_func.size(), 3);
+    EXPECT_FALSE(contains_bb(test_func, bb_empty));
+    EXPECT_EQ(bb_entry->get_true_successor(), bb_exit);
+    EXPECT_EQ(bb_entry->get_false_successor(), bb_other);
+    ASSERT_EQ(std::distance(bb_exit->preds_begin(), bb_exit->preds_end()), 2);
+    EXPECT_NE(std::find(bb_exit->preds_begin(), bb_exit->preds_end(), bb_entry),
+              bb_exit->preds_end());
+
+    const auto &nodes = phi->get_phi_nodes();
+    ASSERT_EQ(nodes.size(), 2);
+    EXPECT_NE(std::ranges::find(nodes, PhiInstr::phi_node{one, bb_entry}), nodes.end());
+    EXPECT_NE(std::ranges::find(nodes, PhiInstr::phi_node{two, bb_other}), nodes.end());
+}
+
+TEST_F(SimplifyCFGTest, SameTargets) {
+    // both arms are empty and pass the same value, the branch becomes a jump
+    auto *bb_true = builder.create_bb();
+    auto *bb_false = builder.create_bb();
+    auto *bb_exit = builder.create_bb();
+
+    auto *one = builder.create_int(1);
+    auto *br = builder.create_br(x, bb_true, bb_false);
+    builder.set_insert_point(bb_true);
+    builder.create_jump(bb_exit);
+    builder.set_insert_point(bb_false);
+    builder.create_jump(bb_exit);
+    builder.set_insert_point(bb_exit);
+    auto *phi = builder.create_phi();
+    phi->add_incoming(one, bb_true);
+    phi->add_incoming(one, bb_false);
+    auto *ret = builder.create_ret(phi);
+
+    SimplifyCFG pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    ASSERT_EQ(test_func.size(), 1);
+    EXPECT_FALSE(contains_instr(bb_entry, br));
+    EXPECT_FALSE(contains_instr(bb_entry, phi));
+    EXPECT_EQ(ret->get_ret(), one);
+    EXPECT_EQ(std::ranges::count(x->users(), br), 0);
+    EXPECT_EQ(std::ranges::count(one->users(), phi), 0);
+}
+
+TEST_F(SimplifyCFGTest, Unreachable) {
+    // bb_dead cannot be reached, the phi of bb_exit is left with one input
+    auto *bb_exit = builder.create_bb();
+    auto *bb_dead = builder.create_bb();
+
+    builder.create_jump(bb_exit);
+    builder.set_insert_point(bb_dead);
+    auto *dead_value = builder.create_add(x, x);
+    builder.create_jump(bb_exit);
+    builder.set_insert_point(bb_exit);
+    auto *phi = builder.create_phi();
+    phi->add_incoming(x, bb_entry);
+    phi->add_incoming(dead_value, bb_dead);
+    auto *ret = builder.create_ret(phi);
+
+    SimplifyCFG pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    ASSERT_EQ(test_func.size(), 1);
+    EXPECT_FALSE(contains_bb(test_func, bb_dead));
+    EXPECT_EQ(ret->get_ret(), x);
+    EXPECT_EQ(std::ranges::count(x->users(), dead_value), 0);
+    EXPECT_EQ(std::ranges::count(x->users(), ret), 1);
+}
+
+TEST_F(SimplifyCFGTest, Loop) {
+    // entry -> header <-> latch, header -> exit
+    auto *bb_header = builder.create_bb();
+    auto *bb_latch = builder.create_bb();
+    auto *bb_exit = builder.create_bb();
+
+    builder.create_jump(bb_header);
+    builder.set_insert_point(bb_header);
+    auto *phi = builder.create_phi();
+    auto *add = builder.create_add(phi, builder.create_int(1));
+    auto *cond = builder.create_bin_instr(InstrType::kCmpLess, add, x);
+    builder.create_br(cond, bb_latch, bb_exit);
+    builder.set_insert_point(bb_latch);
+    builder.create_jump(bb_header);
+    builder.set_insert_point(bb_exit);
+    builder.create_ret(add);
+    phi->add_incoming(x, bb_entry);
+    phi->add_incoming(add, bb_latch);
+
+    // the latch is threaded and the header loops to itself
+    SimplifyCFG pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(test_func.size(), 3);
+    EXPECT_FALSE(contains_bb(test_func, bb_latch));
+    EXPECT_EQ(bb_header->get_true_successor(), bb_header);
+    EXPECT_EQ(bb_header->get_false_successor(), bb_exit);
+    EXPECT_NE(std::ranges::find(phi->get_phi_nodes(), PhiInstr::phi_node{add, bb_header}),
+              phi->get_phi_nodes().end());
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include "ir/basic_block.hpp"
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "pass/strength_reduction.hpp"
+
+using namespace injir;
+using namespace injir::pass;
+
+static bool contains_instr(BasicBlock *bb, Instr *instr) {
+    return std::ranges::any_of(*bb, [instr](auto &bb_instr) { return bb_instr.get() == instr; });
+}
+
+// sum = 0; for (i = 0; i < limit; i = i + 1) { sum = sum + i * factor; } return sum;
+class StrengthReductionTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&test_func);
+
+        bb_entry = builder.create_bb();
+        bb_cond = builder.create_bb();
+        bb_body = builder.create_bb();
+        bb_exit = builder.create_bb();
+
+        builder.set_insert_point(bb_entry);
+        n = builder.create_arg(Type::kInt);
+        zero = builder.create_int(0);
+        one = builder.create_int(1);
+    }
+
+    void build(Instr *limit, Instr *factor) {
+        builder.set_insert_point(bb_entry);
+        builder.create_jump(bb_cond);
+
+        builder.set_insert_point(bb_cond);
+        i = builder.create_phi();
+        sum = builder.create_phi();
+        cond = builder.create_bin_instr(InstrType::kCmpLess, i, limit);
+        builder.create_br(cond, bb_body, bb_exit);
+
+        builder.set_insert_point(bb_body);
+        mul = builder.create_mul(i, factor);
+        auto *sum_next = builder.create_add(sum, mul);
+        inc = builder.create_add(i, one);
+        builder.create_jump(bb_cond);
+
+        builder.set_insert_point(bb_exit);
+        builder.create_ret(sum);
+
+        i->add_incoming(zero, bb_entry);
+        i->add_incoming(inc, bb_body);
+        sum->add_incoming(zero, bb_entry);
+        sum->add_incoming(sum_next, bb_body);
+    }
+
+    // The phi added to the header for i * factor
+    PhiInstr *recurrence() {
+        auto *phi = bb_cond->begin()->get();
+        EXPECT_TRUE(PhiInstr::classof(phi));
+        EXPECT_NE(phi, i);
+        EXPECT_NE(phi, sum);
+        return static_cast<PhiInstr *>(phi);
+    }
+
+    Builder builder{};
+    Function test_func{Type::kInt, {Type::kInt}};
+    BasicBlock *bb_entry{}, *bb_cond{}, *bb_body{}, *bb_exit{};
+    Instr *n{}, *zero{}, *one{};
+    PhiInstr *i{}, *sum{};
+    BinInstr *cond{}, *mul{}, *inc{};
+};
+
+TEST_F(StrengthReductionTest, ConstantFactor) {
+    auto *ten = builder.create_int(10);
+    auto *four = builder.create_int(4);
+    build(ten, four);
+
+    StrengthReduction pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(contains_instr(bb_body, mul));
+
+    // j = phi(0, j + 4)
+    auto *j = recurrence();
+    auto &nodes = j->get_phi_nodes();
+    ASSERT_EQ(nodes.size(), 2);
+    EXPECT_EQ(nodes[0].second, bb_entry);
+    EXPECT_EQ(analysis::constant_value(nodes[0].first), 0);
+    EXPECT_EQ(nodes[1].second, bb_body);
+    ASSERT_EQ(nodes[1].first->type(), InstrType::kAdd);
+    auto *j_next = static_cast<BinInstr *>(nodes[1].first);
+    EXPECT_EQ(j_next->get_lhs(), j);
+    EXPECT_EQ(analysis::constant_value(j_next->get_rhs()), 4);
+
+    // i < 10 is replaced by j < 40, i is gone
+    EXPECT_EQ(cond->get_lhs(), j);
+    EXPECT_EQ(analysis::constant_value(cond->get_rhs()), 40);
+    EXPECT_FALSE(contains_instr(bb_cond, i));
+    EXPECT_FALSE(contains_instr(bb_body, inc));
+    EXPECT_TRUE(ten->users().empty());
+    EXPECT_EQ(std::ranges::count(j->users(), cond), 1);
+    EXPECT_EQ(std::ranges::count(zero->users(), i), 0);
+    EXPECT_EQ(std::ranges::count(one->users(), inc), 0);
+
+    auto *sum_next = static_cast<BinInstr *>(sum->get_phi_nodes()[1].first);
+    EXPECT_EQ(sum_next->get_rhs(), j);
+
+    EXPECT_FALSE(pass.apply(test_func));
+}
+
+TEST_F(StrengthReductionTest, InvariantFactor) {
+    auto *ten = builder.create_int(10);
+    build(ten, n);
+
+    StrengthReduction pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(contains_instr(bb_body, mul));
+
+    // j = phi(0 * n, j + 1 * n)
+    auto *j = recurrence();
+    auto *init = j->get_phi_nodes()[0].first;
+    ASSERT_EQ(init->type(), InstrType::kMul);
+    EXPECT_TRUE(contains_instr(bb_entry, init));
+    EXPECT_EQ(static_cast<BinInstr *>(init)->get_rhs(), n);
+
+    auto *j_next = static_cast<BinInstr *>(j->get_phi_nodes()[1].first);
+    ASSERT_EQ(j_next->get_rhs()->type(), InstrType::kMul);
+    EXPECT_TRUE(contains_instr(bb_entry, j_next->get_rhs()));
+
+    // the sign of n is unknown, the test stays on i
+    EXPECT_EQ(cond->get_lhs(), i);
+    EXPECT_TRUE(contains_instr(bb_cond, i));
+}
+
+TEST_F(StrengthReductionTest, UnknownLimit) {
+    auto *four = builder.create_int(4);
+    build(n, four);
+
+    StrengthReduction pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_FALSE(contains_instr(bb_body, mul));
+
+    // i * 4 may wrap around before i reaches n
+    EXPECT_EQ(cond->get_lhs(), i);
+    EXPECT_EQ(cond->get_rhs(), n);
+    EXPECT_TRUE(contains_instr(bb_cond, i));
+}
+
+TEST_F(StrengthReductionTest, LiveInductionVariable) {
+    auto *ten = builder.create_int(10);
+    auto *four = builder.create_int(4);
+    build(ten, four);
+
+    // i is also checked in the body
+    builder.set_insert_point(bb_body);
+    auto *check = builder.create_bound_check(i, 0, 9);
+    bb_body->splice(bb_body->end(), *bb_body, std::prev(bb_body->end(), 2));
+
+    StrengthReduction pass{};
+    EXPECT_TRUE(pass.apply(test_func));
+    EXPECT_EQ(cond->get_lhs(), i);
+    EXPECT_TRUE(contains_instr(bb_cond, i));
+    EXPECT_EQ(static_cast<BoundCheck *>(check)->get_check(), i);
+}
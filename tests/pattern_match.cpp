@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "ir/builder.hpp"
+#include "ir/function.hpp"
+#include "ir/instr.hpp"
+#include "ir/pattern_match.hpp"
+
+using namespace injir;
+using namespace injir::pattern;
+
+class PatternMatchTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        builder.set_insert_point(&func);
+        builder.set_insert_point(builder.create_bb());
+
+        n = builder.create_arg(Type::kInt);
+        one = builder.create_int(1);
+        two = builder.create_int(2);
+        half = builder.create_double(0.5);
+    }
+
+    Builder builder{};
+    Function func{Type::kInt, {Type::kInt}};
+    Instr *n{}, *one{}, *two{}, *half{};
+};
+
+TEST_F(PatternMatchTest, Binary) {
+    auto *mul = builder.create_mul(n, one);
+    auto *swapped = builder.create_mul(one, n);
+
+    Instr *x = nullptr;
+    EXPECT_TRUE(match(mul, m_Mul(m_Value(x), m_ConstInt(1))));
+    EXPECT_EQ(x, n);
+    EXPECT_FALSE(match(mul, m_Mul(m_Value(), m_ConstInt(2))));
+    EXPECT_FALSE(match(mul, m_Add(m_Value(), m_Value())));
+
+    // only the commutative pattern tries both orders
+    EXPECT_FALSE(match(swapped, m_Mul(m_Value(), m_ConstInt(1))));
+    x = nullptr;
+    EXPECT_TRUE(match(swapped, m_c_Mul(m_Value(x), m_ConstInt(1))));
+    EXPECT_EQ(x, n);
+
+    // nested patterns
+    auto *shl = builder.create_shl(builder.create_add(n, two), one);
+    i64 amount = 0;
+    EXPECT_TRUE(match(shl, m_Shl(m_Add(m_Specific(n), m_ConstInt()), m_BindInt(amount))));
+    EXPECT_EQ(amount, 1);
+    EXPECT_FALSE(match(shl, m_Shl(m_Add(m_Specific(one), m_ConstInt()), m_Value())));
+}
+
+TEST_F(PatternMatchTest, Values) {
+    auto *same = builder.create_or(n, n);
+    auto *different = builder.create_or(n, one);
+
+    Instr *x = nullptr;
+    EXPECT_TRUE(match(same, m_Or(m_Value(x), m_Deferred(x))));
+    EXPECT_FALSE(match(different, m_Or(m_Value(x), m_Deferred(x))));
+
+    // only integer constants
+    EXPECT_TRUE(match(one, m_ConstInt()));
+    EXPECT_FALSE(match(half, m_ConstInt()));
+    EXPECT_FALSE(match(n, m_ConstInt()));
+
+    Instr *constant = nullptr;
+    EXPECT_TRUE(match(different, m_Or(m_Value(), m_Bind(constant, m_ConstInt(1)))));
+    EXPECT_EQ(constant, one);
+}
+
+TEST_F(PatternMatchTest, RuleSet) {
+    struct Context {
+        int applied = 0;
+    };
+    RuleSet<Context> rules{};
+    rules
+        .add(InstrType::kMul,
+             [](Instr *instr, Context &context) {
+                 ++context.applied;
+                 Instr *x = nullptr;
+                 return match(instr, m_c_Mul(m_Value(x), m_ConstInt(1))) ? x : nullptr;
+             })
+        .add(InstrType::kMul, [](Instr *instr, Context &context) {
+            ++context.applied;
+            return match(instr, m_Mul(m_Value(), m_Value())) ? instr : nullptr;
+        });
+    EXPECT_EQ(rules.size(InstrType::kMul), 2);
+    EXPECT_EQ(rules.size(InstrType::kAdd), 0);
+
+    // the first rule which applies wins
+    Context context{};
+    EXPECT_EQ(rules.apply(builder.create_mul(one, n), context), n);
+    EXPECT_EQ(context.applied, 1);
+    auto *mul = builder.create_mul(n, two);
+    EXPECT_EQ(rules.apply(mul, context), mul);
+    EXPECT_EQ(context.applied, 3);
+
+    // no rules for other types
+    EXPECT_EQ(rules.apply(builder.create_add(n, one), context), nullptr);
+    EXPECT_EQ(context.applied, 3);
+}
@@ -0,0 +1,47 @@
+#ifndef REGALLOC_CHECKS_HPP
+#define REGALLOC_CHECKS_HPP
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include "analysis/lifetime.hpp"
+#include "analysis/regalloc.hpp"
+
+// Every value has a location and interfering values of one class never share a register
+inline void check_coloring(const injir::analysis::RegisterAllocator &alloc,
+                           const injir::analysis::LifeTime &lt) {
+    using injir::analysis::LifeTime;
+    using injir::analysis::reg_class;
+    using Kind = injir::analysis::RegisterAllocator::Location::Kind;
+
+    for (const auto &[instr, ranges] : lt) {
+        auto location = alloc.get_location(instr);
+        ASSERT_TRUE(location.has_value());
+        // a value is in a register, in a spill slot or rematerialized at its uses
+        auto reg = alloc.get_register(instr);
+        auto spill_slot = alloc.get_spill_slot(instr);
+        EXPECT_FALSE(reg.has_value() && spill_slot.has_value());
+        EXPECT_EQ(reg.has_value() || spill_slot.has_value(), location->kind != Kind::Remat);
+        if (!reg.has_value()) {
+            continue;
+        }
+
+        for (const auto &[other, other_ranges] : lt) {
+            if (other == instr || reg_class(other) != reg_class(instr) ||
+                alloc.get_register(other) != reg) {
+                continue;
+            }
+            EXPECT_FALSE(LifeTime::overlap(ranges, other_ranges));
+        }
+    }
+}
+
+inline std::size_t spills_num(const injir::analysis::RegisterAllocator &alloc,
+                              const injir::analysis::LifeTime &lt) {
+    return std::ranges::count_if(
+        lt, [&alloc](const auto &e) { return alloc.get_spill_slot(e.first).has_value(); });
+}
+
+#endif // REGALLOC_CHECKS_HPP